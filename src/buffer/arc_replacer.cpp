@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages) : capacity_(num_pages) { frames_.reserve(num_pages); }
+
+ARCReplacer::~ARCReplacer() = default;
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Take from T1 while it is above its target, otherwise from T2. If the preferred list has nothing evictable, fall
+  // back to the other one rather than failing.
+  bool from_frequent = recent_.empty() || recent_.size() <= target_;
+  return EvictFrom(from_frequent, frame_id) || EvictFrom(!from_frequent, frame_id);
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end() && it->second.is_evictable_) {
+    it->second.is_evictable_ = false;
+    num_evictable_--;
+  }
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    it = frames_.emplace(frame_id, FrameEntry{}).first;
+    Insert(frame_id, &it->second, false);
+  }
+  if (!it->second.is_evictable_) {
+    it->second.is_evictable_ = true;
+    num_evictable_++;
+  }
+}
+
+void ARCReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Assumes the target stays where it is, which holds until the next miss on a ghost.
+  bool from_frequent = recent_.empty() || recent_.size() <= target_;
+  for (bool frequent : {from_frequent, !from_frequent}) {
+    const auto &list = frequent ? frequent_ : recent_;
+    for (auto it = list.rbegin(); it != list.rend() && max_frames > 0; ++it) {
+      if (frames_[*it].is_evictable_) {
+        frame_ids->push_back(*it);
+        max_frames--;
+      }
+    }
+  }
+}
+
+size_t ARCReplacer::Size() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_evictable_;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = frames_.find(frame_id);
+  if (it != frames_.end() && it->second.page_id_ == page_id) {
+    // Case I: a hit in T1 or T2 moves the page to the most recently used end of T2.
+    Detach(it->second);
+    Insert(frame_id, &it->second, true);
+    return;
+  }
+  bool is_evictable = false;
+  if (it != frames_.end()) {
+    // The frame was handed out without going through Victim (e.g. it was never accessed before), so it has no page
+    // worth remembering.
+    Detach(it->second);
+    is_evictable = it->second.is_evictable_;
+    frames_.erase(it);
+  }
+
+  bool frequent = false;
+  if (recent_ghosts_.Contains(page_id)) {
+    // Case II: the page was evicted from T1 too early, so T1 deserves more room.
+    size_t delta = std::max<size_t>(frequent_ghosts_.Size() / recent_ghosts_.Size(), 1);
+    target_ = std::min(capacity_, target_ + delta);
+    recent_ghosts_.Erase(page_id);
+    frequent = true;
+  } else if (frequent_ghosts_.Contains(page_id)) {
+    // Case III: the page was evicted from T2 too early, so T2 deserves more room.
+    size_t delta = std::max<size_t>(recent_ghosts_.Size() / frequent_ghosts_.Size(), 1);
+    target_ = target_ > delta ? target_ - delta : 0;
+    frequent_ghosts_.Erase(page_id);
+    frequent = true;
+  }
+  // Case IV: a page seen for the first time in a while starts in T1.
+  auto &entry = frames_[frame_id];
+  entry.page_id_ = page_id;
+  entry.is_evictable_ = is_evictable;
+  Insert(frame_id, &entry, frequent);
+}
+
+void ARCReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = frames_.find(frame_id);
+  if (it == frames_.end()) {
+    return;
+  }
+  Detach(it->second);
+  if (it->second.is_evictable_) {
+    num_evictable_--;
+  }
+  frames_.erase(it);
+}
+
+void ARCReplacer::SetCapacity(size_t num_pages) {
+  std::lock_guard<std::mutex> guard(latch_);
+  capacity_ = num_pages;
+  target_ = std::min(target_, capacity_);
+  TrimGhosts();
+}
+
+size_t ARCReplacer::GetTarget() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return target_;
+}
+
+void ARCReplacer::Insert(frame_id_t frame_id, FrameEntry *entry, bool frequent) {
+  auto &list = frequent ? frequent_ : recent_;
+  list.push_front(frame_id);
+  entry->frequent_ = frequent;
+  entry->pos_ = list.begin();
+}
+
+void ARCReplacer::Detach(const FrameEntry &entry) { (entry.frequent_ ? frequent_ : recent_).erase(entry.pos_); }
+
+bool ARCReplacer::EvictFrom(bool frequent, frame_id_t *frame_id) {
+  auto &list = frequent ? frequent_ : recent_;
+  auto victim = std::find_if(list.rbegin(), list.rend(), [this](frame_id_t id) { return frames_[id].is_evictable_; });
+  if (victim == list.rend()) {
+    return false;
+  }
+  *frame_id = *victim;
+  auto it = frames_.find(*frame_id);
+  if (it->second.page_id_ != INVALID_PAGE_ID) {
+    (frequent ? frequent_ghosts_ : recent_ghosts_).PushFront(it->second.page_id_);
+  }
+  list.erase(std::next(victim).base());
+  frames_.erase(it);
+  num_evictable_--;
+  TrimGhosts();
+  return true;
+}
+
+void ARCReplacer::TrimGhosts() {
+  // Keep the directory within its bounds: T1 and B1 together never exceed the pool, and neither do B1 and B2.
+  while (recent_.size() + recent_ghosts_.Size() > capacity_ && recent_ghosts_.Size() > 0) {
+    recent_ghosts_.PopBack();
+  }
+  while (recent_ghosts_.Size() + frequent_ghosts_.Size() > capacity_ && frequent_ghosts_.Size() > 0) {
+    frequent_ghosts_.PopBack();
+  }
+}
+
+void ARCReplacer::GhostList::PushFront(page_id_t page_id) {
+  Erase(page_id);
+  list_.push_front(page_id);
+  index_[page_id] = list_.begin();
+}
+
+void ARCReplacer::GhostList::Erase(page_id_t page_id) {
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    list_.erase(it->second);
+    index_.erase(it);
+  }
+}
+
+void ARCReplacer::GhostList::PopBack() {
+  index_.erase(list_.back());
+  list_.pop_back();
+}
+
+}  // namespace bustub
@@ -12,16 +12,44 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <future>  // NOLINT
 #include <list>
-#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/macros.h"
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     ReplacerType replacer_type, size_t max_pool_size)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      frames_(std::make_unique<Page *[]>(max_pool_size_)),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(max_pool_size_) {
+  // We allocate a consecutive memory space for the buffer pool. Frames added by ResizeBufferPool come in chunks of
+  // their own.
+  InstallFrames(AllocateFrames(pool_size), pool_size);
+  pages_ = chunks_.front().get();
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = new ARCReplacer(max_pool_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+  }
+  replacer_->SetCapacity(pool_size);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; i++) {
@@ -29,195 +57,858 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   }
 }
 
+BufferPoolManager::BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager)
+    : pool_size_(0),
+      max_pool_size_(0),
+      pages_(nullptr),
+      disk_manager_(disk_manager),
+      log_manager_(log_manager),
+      page_table_(0),
+      replacer_(nullptr) {}
+
 BufferPoolManager::~BufferPoolManager() {
-  delete[] pages_;
+  StopPageCleaner();
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    prefetcher_running_ = false;
+  }
+  prefetch_cv_.notify_all();
+  if (prefetch_thread_.joinable()) {
+    prefetch_thread_.join();
+  }
+  {
+    // The completions of the last prefetched pages still need the frames and the latch.
+    std::unique_lock<std::mutex> lock(latch_);
+    prefetch_cv_.wait(lock, [this] { return prefetch_reads_in_flight_ == 0; });
+  }
   delete replacer_;
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
-  // 1.     Search the page table for the requested page (P).
-  // 1.1    If P exists, pin it and return it immediately.
-  
-  //use latch to prevent multiple threads from accessing this process
-  latch_.lock(); 
-  frame_id_t free_frame_id = -1;
-  if (page_table_.find(page_id) != page_table_.end()) {
-    free_frame_id = page_table_[page_id];
-    replacer_->Pin(free_frame_id);
-    pages_[free_frame_id].pin_count_ += 1;
-    latch_.unlock();
-    return &pages_[free_frame_id];
-  }
-  // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
-  //        Note that pages are always found from the free list first.
-
-  if (!free_list_.empty()) {
-    free_frame_id = free_list_.front();
-    free_list_.pop_front();
-  } 
-  else {
-    if (!replacer_->Victim(&free_frame_id)) {
-      latch_.unlock();
-      return nullptr;
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // 0.     A hit is served without the latch. Once the frame is pinned it cannot be taken away, so all that is left to
+  //        check is that it still holds P; otherwise the table entry was stale, and the latched path below decides.
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    Page *page = frames_[frame_id];
+    if (TryPin(page)) {
+      if (page->page_id_ == page_id) {
+        replacer_->RecordAccess(frame_id, page_id);
+        replacer_->Pin(frame_id);
+        metrics_.Add(BufferPoolCounter::HIT);
+        if (page->io_state_ == PageIOState::LOADING) {
+          auto lock = AcquireLatch();
+          WaitForIO(frame_id, &lock);
+        }
+        return page;
+      }
+      UnpinFrame(frame_id, false);
     }
-  // 2.     If R is dirty, write it back to the disk.
+  }
 
-  Page *replacedPage = &pages_[free_frame_id];
-    if (replacedPage->is_dirty_) {
-      FlushPageImpl(replacedPage->page_id_);
-      replacedPage->is_dirty_ = false;
+  auto lock = AcquireLatch();
+  while (true) {
+    // 1.     Search the page table for the requested page (P).
+    // 1.1    If P exists, pin it and return it once any read of it has completed.
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = frames_[frame_id];
+      replacer_->RecordAccess(frame_id, page_id);
+      replacer_->Pin(frame_id);
+      page->pin_count_ += 1;
+      metrics_.Add(BufferPoolCounter::HIT);
+      if (page->io_state_ == PageIOState::LOADING) {
+        WaitForIO(frame_id, &lock);
+      }
+      return page;
     }
-  // 3.     Delete R from the page table and insert P.
-  page_table_.erase(replacedPage->page_id_);
 
-  // read in the page content from disk
-  pages_[free_frame_id].ResetMemory();
-  disk_manager_->ReadPage(page_id, pages_[free_frame_id].GetData());
+    // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+    // 2.     If R is dirty, write it back to the disk.
+    // 3.     Delete R from the page table and insert P.
+    if (!FindFreeFrame(&frame_id, &lock, strategy)) {
+      if (!WaitForPrefetchRead(&lock)) {
+        return nullptr;
+      }
+      continue;
+    }
+    // The latch may have been released while R was written back, and someone else may have brought P in meanwhile.
+    if (page_table_.Contains(page_id)) {
+      free_list_.emplace_back(frame_id);
+      continue;
+    }
 
+    // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+    //        The read happens without the latch; other requests for P wait on the frame until it is done.
+    Page *page = frames_[frame_id];
+    page->page_id_ = page_id;
+    page->is_dirty_ = false;
+    page->io_state_ = PageIOState::LOADING;
+    page_table_.Insert(page_id, frame_id);
+    page->pin_count_ = 1;
+    replacer_->RecordAccess(frame_id, page_id);
+    replacer_->Pin(frame_id);
+    RememberInRing(strategy, frame_id, page_id);
+    metrics_.Add(BufferPoolCounter::MISS);
+
+    lock.unlock();
+    ReadPageFromDisk(page_id, page);
+    lock.lock();
+
+    page->io_state_ = PageIOState::NONE;
+    page->io_done_.notify_all();
+    return page;
   }
-  // 4.    Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  pages_[free_frame_id].page_id_ = page_id;
-  page_table_.insert({page_id, free_frame_id});
-  pages_[free_frame_id].pin_count_ = 1;
-  replacer_->Pin(free_frame_id);
-
-  latch_.unlock();
-  return &pages_[free_frame_id];
-
 }
 
-bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) { 
-  //decrement pin count of given page with id page_id
-  latch_.lock(); //use latch to lock multiple threads from accessing this process
-  //if we could not find page with given id then return false
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
+bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  auto lock = AcquireLatch();
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
   }
+  return ReleasePin(frame_id, is_dirty);
+}
+
+bool BufferPoolManager::UnpinFrame(frame_id_t frame_id, bool is_dirty) {
+  auto lock = AcquireLatch();
+  return ReleasePin(frame_id, is_dirty);
+}
 
-  //pageToUnpin is the pointer that stores the reference to the page to be unpinned
-  Page *pageToUnpin = &pages_[page_table_[page_id]];
-  //if pin_count_ <=0 then return
-  if (pageToUnpin->pin_count_ <= 0) {
-    latch_.unlock();
+bool BufferPoolManager::ReleasePin(frame_id_t frame_id, bool is_dirty) {
+  Page *page = frames_[frame_id];
+  if (page->pin_count_ <= 0) {
     return false;
   }
 
-  pageToUnpin->pin_count_ -= 1;
-  pageToUnpin->is_dirty_ = is_dirty;
-  if (pageToUnpin->pin_count_ == 0) {
-    replacer_->Unpin(page_table_[page_id]);
+  // A clean unpin must not hide an earlier writer's modification.
+  page->is_dirty_ = page->is_dirty_ || is_dirty;
+  page->pin_count_ -= 1;
+  // A frame that is being evicted is kept out of the replacer; the eviction re-adds it if it has to give up.
+  if (page->pin_count_ == 0 && !page->evicting_) {
+    MakeEvictable(frame_id);
   }
-  latch_.unlock();
   return true;
 }
 
-//write content of page from buffer pool to disk
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  // Make sure you call DiskManager::WritePage!
-  if (page_table_.find(page_id) == page_table_.end()) {
-    //if page does not exist then return false
+  if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-
-  Page *pageToFlush = &pages_[page_table_[page_id]];
-
-  if (pageToFlush->is_dirty_) {
-    disk_manager_->WritePage(pageToFlush->page_id_, pageToFlush->GetData());
-    pageToFlush->is_dirty_ = false;
+  auto lock = AcquireLatch();
+  while (true) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return false;
+    }
+    if (frames_[frame_id]->io_state_ == PageIOState::NONE) {
+      FlushFrame(frame_id, &lock);
+      return true;
+    }
+    // The page may have been evicted by the time the I/O finishes, so look it up again.
+    WaitForIO(frame_id, &lock);
   }
-
-  return true;
-
 }
 
-//create a new page and assign it a position in the buffer pool
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
-  // 0.   Make sure you call DiskManager::AllocatePage!
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  auto lock = AcquireLatch();
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+  frame_id_t frame_id;
+  while (!FindFreeFrame(&frame_id, &lock, strategy)) {
+    if (!WaitForPrefetchRead(&lock)) {
+      return nullptr;
+    }
+  }
+
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
+  *page_id = disk_manager_->AllocatePage();
+  DropStalePage(*page_id, &lock);
+  RememberInRing(strategy, frame_id, *page_id);
+  return InitNewPage(frame_id, *page_id);
+}
 
-  latch_.lock();
-  frame_id_t free_frame_id = -1;
-  if (!free_list_.empty()) {
-    //give more priority to the free list --> allot free_frame_id = first page from free list
-    free_frame_id = free_list_.front();
-    free_list_.pop_front();
-  } 
-  else {
-    //if neither free list or replacer has an unpinned page, return nullptr
-    if (!replacer_->Victim(&free_frame_id)) {
-      latch_.unlock();
-      return nullptr;
+bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  auto lock = AcquireLatch();
+  while (true) {
+    // 1.   Search the page table for the requested page (P).
+    // 1.   If P does not exist, return true.
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      disk_manager_->DeallocatePage(page_id);
+      return true;
     }
 
-    //page to be replaced in replacer
-    Page *replacedPage = &pages_[free_frame_id];
-    if (replacedPage->is_dirty_) {
-      FlushPageImpl(replacedPage->page_id_);
-      replacedPage->is_dirty_ = false;
+    // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+    Page *page = frames_[frame_id];
+    if (page->pin_count_ > 0) {
+      return false;
+    }
+    if (page->io_state_ != PageIOState::NONE || page->evicting_) {
+      page->io_done_.wait(lock, [page] { return page->io_state_ == PageIOState::NONE && !page->evicting_; });
+      continue;
     }
 
-    page_table_.erase(replacedPage->page_id_);
+    // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free
+    //      list. The frame is removed from the replacer so that it cannot be handed out twice.
+    if (!ClaimFrame(page)) {
+      return false;
+    }
+    disk_manager_->DeallocatePage(page_id);
+    page_table_.Erase(page_id);
+    replacer_->Remove(frame_id);
+    page->ResetMemory();
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    // A frame that is being retired stays claimed instead.
+    if (static_cast<size_t>(frame_id) < pool_size_) {
+      free_list_.emplace_back(frame_id);
+    }
+    return true;
   }
+}
 
-  //update P's metadata after allocating position for the new page 
-  *page_id = disk_manager_->AllocatePage();
-  pages_[free_frame_id].page_id_ = *page_id;
-  page_table_.insert({*page_id, free_frame_id});
-  pages_[free_frame_id].ResetMemory();
-  replacer_->Pin(free_frame_id);
-  pages_[free_frame_id].pin_count_ = 1;
-  pages_[free_frame_id].is_dirty_ = false;  
+void BufferPoolManager::FlushAllPagesImpl() {
+  auto lock = AcquireLatch();
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  std::vector<page_id_t> busy;
+  for (size_t i = 0; i < num_allocated_frames_; i++) {
+    Page *page = frames_[i];
+    if (page->pin_count_ < 0 || !page->is_dirty_) {
+      continue;
+    }
+    if (page->io_state_ == PageIOState::NONE && !page->evicting_) {
+      batch.emplace_back(page->page_id_, static_cast<frame_id_t>(i));
+    } else {
+      busy.push_back(page->page_id_);
+    }
+  }
 
-  latch_.unlock();
-  return &(pages_[free_frame_id]);
+  // Write the dirty pages in page id order, runs of contiguous pages with one vectored write each, and make them
+  // durable with a single sync. As with FlushFrame, the dirty flag is cleared before the write; it is set again if the
+  // write fails.
+  if (!batch.empty()) {
+    std::sort(batch.begin(), batch.end());
+    for (const auto &[page_id, frame_id] : batch) {
+      frames_[frame_id]->is_dirty_ = false;
+      frames_[frame_id]->io_state_ = PageIOState::WRITING;
+    }
+    auto remaining = std::make_shared<std::atomic<size_t>>(0);
+    auto written = std::make_shared<std::promise<void>>();
+    auto failed = std::make_shared<std::vector<char>>(batch.size(), 0);
+    auto requests = MakeRunRequests(true, batch, [remaining, written, failed](size_t begin, size_t end) {
+      return [remaining, written, failed, begin, end](bool ok) {
+        if (!ok) {
+          std::fill(failed->begin() + begin, failed->begin() + end, 1);
+        }
+        if (--*remaining == 0) {
+          written->set_value();
+        }
+      };
+    });
+    *remaining = requests.size();
+    auto done = written->get_future();
+    lock.unlock();
+    disk_manager_->SubmitRequests(std::move(requests));
+    done.wait();
+    disk_manager_->SyncPages();
+    lock.lock();
+    MarkFailedWritesDirty(batch, *failed);
+    for (const auto &[page_id, frame_id] : batch) {
+      frames_[frame_id]->io_state_ = PageIOState::NONE;
+      frames_[frame_id]->io_done_.notify_all();
+    }
+    metrics_.Add(BufferPoolCounter::FLUSH, batch.size());
+  }
+  lock.unlock();
 
+  // Pages that were being read or written meanwhile are left to FlushPage, which waits for their I/O.
+  for (auto page_id : busy) {
+    FlushPageImpl(page_id);
+  }
 }
 
-//this function deallocates the page from the buffer pool
-bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
-  // 0.   Make sure you call DiskManager::DeallocatePage!
-  // 1.   Search the page table for the requested page (P).
-  // 1.   If P does not exist, return true.
-  // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
-  // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
-
-  //if P does not exist in page table return true
-  if (page_table_.find(page_id) == page_table_.end()) {
-    disk_manager_->DeallocatePage(page_id);
+BasicPageGuard BufferPoolManager::FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy) {
+  // Go straight to the instance that owns the page; its frame is what the guard unpins later.
+  BufferPoolManager *owner = GetBufferPoolManager(page_id);
+  return owner->MakeGuard(owner->FetchPageImpl(page_id, strategy));
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchPageBasic(page_id, strategy).UpgradeRead();
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return FetchPageBasic(page_id, strategy).UpgradeWrite();
+}
+
+BasicPageGuard BufferPoolManager::NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent,
+                                                  BufferAccessStrategy *strategy) {
+  page_id_t new_page_id = extent->AllocatePage(disk_manager_);
+  BufferPoolManager *owner = GetBufferPoolManager(new_page_id);
+  Page *page = owner->InstallNewPage(new_page_id, strategy);
+  if (page == nullptr) {
+    extent->ReturnPage(disk_manager_, new_page_id);
+    return {};
+  }
+  *page_id = new_page_id;
+  return owner->MakeGuard(page);
+}
+
+BasicPageGuard BufferPoolManager::NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  Page *page = NewPageImpl(page_id, strategy);
+  if (page == nullptr) {
+    return {};
+  }
+  return GetBufferPoolManager(*page_id)->MakeGuard(page);
+}
+
+BasicPageGuard BufferPoolManager::MakeGuard(Page *page) {
+  if (page == nullptr) {
+    return {};
+  }
+  return {this, page, page->frame_id_};
+}
+
+Page *BufferPoolManager::InstallNewPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  auto lock = AcquireLatch();
+  frame_id_t frame_id;
+  while (!FindFreeFrame(&frame_id, &lock, strategy)) {
+    if (!WaitForPrefetchRead(&lock)) {
+      return nullptr;
+    }
+  }
+  DropStalePage(page_id, &lock);
+  RememberInRing(strategy, frame_id, page_id);
+  return InitNewPage(frame_id, page_id);
+}
+
+bool BufferPoolManager::FindFreeFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock,
+                                      BufferAccessStrategy *strategy) {
+  if (strategy != nullptr && RecycleRingFrame(frame_id, lock, strategy)) {
     return true;
   }
+  while (true) {
+    if (!free_list_.empty()) {
+      *frame_id = free_list_.front();
+      free_list_.pop_front();
+      return true;
+    }
+    if (!replacer_->Victim(frame_id)) {
+      return false;
+    }
+    // A frame beyond the pool size is left to ResizeBufferPool, which may also have started retiring it while it was
+    // being reclaimed.
+    if (static_cast<size_t>(*frame_id) < pool_size_ && ReclaimFrame(*frame_id, lock) &&
+        static_cast<size_t>(*frame_id) < pool_size_) {
+      return true;
+    }
+  }
+}
 
-  //get frame_id of page with given page_id
-  frame_id_t frame_id = page_table_[page_id];
-  Page *pageToDelete = &pages_[frame_id];
+bool BufferPoolManager::ReclaimFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = frames_[frame_id];
+  page->evicting_ = true;
+  // R may be in the middle of a flush, which leaves it clean unless it is modified meanwhile.
+  page->io_done_.wait(*lock, [page] { return page->io_state_ == PageIOState::NONE; });
+  if (page->is_dirty_ && page->pin_count_ == 0) {
+    // Write R back with the latch released. R stays in the page table, so requests for it can still pin the frame;
+    // if that happens, or if R is dirtied again, the frame is no longer a good victim and the caller looks for another.
+    page->is_dirty_ = false;
+    page->io_state_ = PageIOState::WRITING;
+    lock->unlock();
+    disk_manager_->WritePage(page->page_id_, page->GetData());
+    lock->lock();
+    page->io_state_ = PageIOState::NONE;
+    metrics_.Add(BufferPoolCounter::DIRTY_WRITEBACK);
+    // The cleaner has fallen behind.
+    cleaner_cv_.notify_one();
+  }
+  page->evicting_ = false;
+  page->io_done_.notify_all();
+  if (!ClaimFrame(page)) {
+    return false;
+  }
+  if (page->is_dirty_) {
+    page->pin_count_ = 0;
+    MakeEvictable(frame_id);
+    return false;
+  }
+  page_table_.Erase(page->page_id_);
+  page->page_id_ = INVALID_PAGE_ID;
+  metrics_.Add(BufferPoolCounter::EVICTION);
+  return true;
+}
 
-  // 2.   If P exists, but has a non-zero pin-count, return false, as page is currently under use
-  if (pageToDelete->GetPinCount() > 0) {
+bool BufferPoolManager::RecycleRingFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock,
+                                         BufferAccessStrategy *strategy) {
+  const BufferAccessStrategy::Slot &slot = CurrentRingSlot(strategy);
+  if (slot.page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  // Since the operation left it, the frame may have been evicted and reused or retired, or someone else may be using
+  // its page.
+  if (static_cast<size_t>(slot.frame_id_) >= pool_size_) {
+    return false;
+  }
+  Page *page = frames_[slot.frame_id_];
+  if (page->page_id_ != slot.page_id_ || page->pin_count_ > 0 || page->evicting_ ||
+      page->io_state_ == PageIOState::LOADING) {
+    return false;
+  }
+  // The replacer forgets the page, as it would after a victim; no history is kept for a page the operation is done
+  // with.
+  replacer_->Remove(slot.frame_id_);
+  if (!ReclaimFrame(slot.frame_id_, lock)) {
     return false;
   }
+  *frame_id = slot.frame_id_;
+  return true;
+}
+
+BufferAccessStrategy::Slot &BufferPoolManager::CurrentRingSlot(BufferAccessStrategy *strategy) {
+  auto &ring = strategy->rings_[this];
+  if (ring.slots_.empty()) {
+    ring.slots_.resize(std::max<size_t>(1, std::min(strategy->ring_size_, pool_size_ / 8)));
+  }
+  return ring.slots_[ring.next_];
+}
+
+void BufferPoolManager::RememberInRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id) {
+  if (strategy == nullptr) {
+    return;
+  }
+  CurrentRingSlot(strategy) = {frame_id, page_id};
+  auto &ring = strategy->rings_[this];
+  ring.next_ = (ring.next_ + 1) % ring.slots_.size();
+}
 
-  // 3.   Otherwise, P can be deleted.
-  // Remove P from the page table, reset its metadata and return it to the free list.
-  free_list_.emplace_back(page_table_[page_id]);
-  page_table_.erase(pageToDelete->page_id_);
-  pageToDelete->ResetMemory();
-  //reset page parameters
-  pageToDelete->page_id_ = INVALID_PAGE_ID;
-  pageToDelete->is_dirty_ = false;
-  pageToDelete->pin_count_ = 0;
+void BufferPoolManager::DropStalePage(page_id_t page_id, std::unique_lock<std::mutex> *lock) {
+  frame_id_t frame_id;
+  while (page_table_.Find(page_id, &frame_id)) {
+    Page *page = frames_[frame_id];
+    if (page->io_state_ != PageIOState::NONE || page->evicting_) {
+      page->io_done_.wait(*lock, [page] { return page->io_state_ == PageIOState::NONE && !page->evicting_; });
+      continue;
+    }
+    // Nobody can hold a pin on a page that was free, short of fetching an id it never allocated.
+    bool claimed = ClaimFrame(page);
+    BUSTUB_ASSERT(claimed, "a page that was deallocated is still pinned");
+    if (!claimed) {
+      return;
+    }
+    page_table_.Erase(page_id);
+    replacer_->Remove(frame_id);
+    page->page_id_ = INVALID_PAGE_ID;
+    page->is_dirty_ = false;
+    if (static_cast<size_t>(frame_id) < pool_size_) {
+      free_list_.emplace_back(frame_id);
+    }
+  }
+}
+
+Page *BufferPoolManager::InitNewPage(frame_id_t frame_id, page_id_t page_id) {
+  Page *page = frames_[frame_id];
+  page->ResetMemory();
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page_table_.Insert(page_id, frame_id);
+  page->pin_count_ = 1;
+  replacer_->RecordAccess(frame_id, page_id);
+  replacer_->Pin(frame_id);
+  metrics_.Add(BufferPoolCounter::NEW_PAGE);
+  return page;
+}
+
+void BufferPoolManager::FlushFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = frames_[frame_id];
+  if (!page->is_dirty_) {
+    return;
+  }
+  // Clear the dirty flag before writing, so that a modification made during the write is not lost.
+  page->is_dirty_ = false;
+  page->io_state_ = PageIOState::WRITING;
+  lock->unlock();
+  disk_manager_->WritePage(page->page_id_, page->GetData());
+  lock->lock();
+  page->io_state_ = PageIOState::NONE;
+  page->io_done_.notify_all();
+  metrics_.Add(BufferPoolCounter::FLUSH);
+}
+
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  auto lock = AcquireLatch();
+  for (auto page_id : page_ids) {
+    // A page id that is not allocated may be allocated later, and must not be shadowed by a stale frame.
+    if (!disk_manager_->IsPageAllocated(page_id) || page_table_.Contains(page_id)) {
+      continue;
+    }
+    if (prefetch_queue_.size() >= pool_size_) {
+      break;
+    }
+    prefetch_queue_.push_back(page_id);
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (!prefetch_thread_.joinable()) {
+    prefetcher_running_ = true;
+    prefetch_thread_ = std::thread(&BufferPoolManager::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::RunPrefetcher() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] {
+      return !prefetcher_running_ || (!prefetch_queue_.empty() && prefetch_reads_in_flight_ < MaxPrefetchReads());
+    });
+    if (!prefetcher_running_) {
+      return;
+    }
+
+    // Set up frames for as many queued pages as the disk manager keeps in flight, then read them all at once. The
+    // frames are out of reach until the reads complete, so only up to half of the pool is taken.
+    std::vector<std::pair<page_id_t, frame_id_t>> batch;
+    size_t max_batch_size = std::min<size_t>(ASYNC_IO_QUEUE_DEPTH, MaxPrefetchReads() - prefetch_reads_in_flight_);
+    while (!prefetch_queue_.empty() && batch.size() < max_batch_size) {
+      page_id_t page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      // The page may have been deleted since it was queued.
+      if (page_table_.Contains(page_id) || !disk_manager_->IsPageAllocated(page_id)) {
+        continue;
+      }
+      frame_id_t frame_id;
+      if (!FindFreeFrame(&frame_id, &lock)) {
+        // Every frame is pinned or being read, so anything further down the queue would not fit either.
+        prefetch_queue_.clear();
+        break;
+      }
+      if (page_table_.Contains(page_id)) {
+        free_list_.emplace_back(frame_id);
+        continue;
+      }
+
+      // Same as a miss in FetchPageImpl, except that nobody holds a pin. The frame stays out of the replacer until the
+      // read is done; a fetch that arrives meanwhile pins it and waits.
+      Page *page = frames_[frame_id];
+      page->page_id_ = page_id;
+      page->is_dirty_ = false;
+      page->io_state_ = PageIOState::LOADING;
+      page_table_.Insert(page_id, frame_id);
+      page->pin_count_ = 0;
+      batch.emplace_back(page_id, frame_id);
+    }
+    if (batch.empty()) {
+      continue;
+    }
+    metrics_.Add(BufferPoolCounter::PREFETCH_READ, batch.size());
+    prefetch_reads_in_flight_ += batch.size();
+
+    // The reads complete on an I/O thread while this one goes on with the queue. Pages queued in order of their ids,
+    // as a scan of a table allocated in extents queues them, are read in runs.
+    auto start = std::chrono::steady_clock::now();
+    std::sort(batch.begin(), batch.end());
+    auto requests = MakeRunRequests(false, batch, [this, &batch, start](size_t begin, size_t end) {
+      std::vector<frame_id_t> run;
+      for (size_t i = begin; i < end; i++) {
+        run.push_back(batch[i].second);
+      }
+      return [this, run = std::move(run), start](bool ok) {
+        metrics_.Record(BufferPoolLatency::DISK_READ, std::chrono::steady_clock::now() - start);
+        std::unique_lock<std::mutex> lock(latch_);
+        for (auto frame_id : run) {
+          Page *page = frames_[frame_id];
+          if (!ok) {
+            // The frame holds whatever it held before. If nobody has pinned it, forget the page, so that the next
+            // fetch reads it again; otherwise a fetch is waiting for it, and it is read here the way that fetch would
+            // have read it.
+            if (ClaimFrame(page)) {
+              page_table_.Erase(page->page_id_);
+              replacer_->Remove(frame_id);
+              page->ResetMemory();
+              page->page_id_ = INVALID_PAGE_ID;
+              page->io_state_ = PageIOState::NONE;
+              if (static_cast<size_t>(frame_id) < pool_size_) {
+                free_list_.emplace_back(frame_id);
+              }
+              page->io_done_.notify_all();
+              continue;
+            }
+            lock.unlock();
+            ReadPageFromDisk(page->page_id_, page);
+            lock.lock();
+          }
+          page->io_state_ = PageIOState::NONE;
+          page->io_done_.notify_all();
+          if (page->pin_count_ == 0) {
+            MakeEvictable(frame_id);
+          }
+        }
+        prefetch_reads_in_flight_ -= run.size();
+        prefetch_cv_.notify_all();
+      };
+    });
+    lock.unlock();
+    disk_manager_->SubmitRequests(std::move(requests));
+    lock.lock();
+  }
+}
+
+bool BufferPoolManager::WaitForPrefetchRead(std::unique_lock<std::mutex> *lock) {
+  size_t reads_in_flight = prefetch_reads_in_flight_;
+  if (reads_in_flight == 0) {
+    return false;
+  }
+  prefetch_cv_.wait(*lock, [this, reads_in_flight] { return prefetch_reads_in_flight_ < reads_in_flight; });
+  return true;
+}
+
+void BufferPoolManager::MarkFailedWritesDirty(const std::vector<std::pair<page_id_t, frame_id_t>> &batch,
+                                              const std::vector<char> &failed) {
+  for (size_t i = 0; i < batch.size(); i++) {
+    if (failed[i] != 0) {
+      LOG_WARN("failed to write back page %d, it stays dirty", batch[i].first);
+      frames_[batch[i].second]->is_dirty_ = true;
+    }
+  }
+}
+
+std::vector<DiskRequest> BufferPoolManager::MakeRunRequests(
+    bool is_write, const std::vector<std::pair<page_id_t, frame_id_t>> &batch,
+    const std::function<std::function<void(bool)>(size_t begin, size_t end)> &make_callback) {
+  std::vector<DiskRequest> requests;
+  size_t begin = 0;
+  while (begin < batch.size()) {
+    size_t end = begin + 1;
+    while (end < batch.size() && end - begin < static_cast<size_t>(EXTENT_SIZE) &&
+           batch[end].first == batch[end - 1].first + 1) {
+      end++;
+    }
+    DiskRequest request{is_write, batch[begin].first, frames_[batch[begin].second]->GetData(),
+                        make_callback(begin, end)};
+    for (size_t i = begin + 1; i < end; i++) {
+      request.more_data_.push_back(frames_[batch[i].second]->GetData());
+    }
+    requests.push_back(std::move(request));
+    begin = end;
+  }
+  return requests;
+}
+
+void BufferPoolManager::StartPageCleaner(size_t min_clean_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (cleaner_running_) {
+    return;
+  }
+  cleaner_running_ = true;
+  min_clean_frames_ = min_clean_frames;
+  cleaner_thread_ = std::thread(&BufferPoolManager::RunPageCleaner, this);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (!cleaner_running_) {
+      return;
+    }
+    cleaner_running_ = false;
+  }
+  cleaner_cv_.notify_all();
+  cleaner_thread_.join();
+}
+
+void BufferPoolManager::RunPageCleaner() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (cleaner_running_) {
+    CleanFrames(&lock);
+    cleaner_cv_.wait_for(lock, page_cleaner_interval);
+  }
+}
+
+void BufferPoolManager::CleanFrames(std::unique_lock<std::mutex> *lock) {
+  if (free_list_.size() >= min_clean_frames_) {
+    return;
+  }
+  std::vector<frame_id_t> victims;
+  replacer_->PeekVictims(min_clean_frames_ - free_list_.size(), &victims);
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  for (auto frame_id : victims) {
+    Page *page = frames_[frame_id];
+    if (page->is_dirty_ && page->pin_count_ == 0 && page->io_state_ == PageIOState::NONE && !page->evicting_) {
+      batch.emplace_back(page->page_id_, frame_id);
+    }
+  }
+  if (batch.empty()) {
+    return;
+  }
+
+  // The frames stay in the replacer while they are written, exactly as with FlushFrame. Writing them in page id
+  // order keeps the batch as sequential on disk as the victims allow.
+  std::sort(batch.begin(), batch.end());
+  auto remaining = std::make_shared<std::atomic<size_t>>(0);
+  auto written = std::make_shared<std::promise<void>>();
+  auto failed = std::make_shared<std::vector<char>>(batch.size(), 0);
+  for (const auto &[page_id, frame_id] : batch) {
+    frames_[frame_id]->is_dirty_ = false;
+    frames_[frame_id]->io_state_ = PageIOState::WRITING;
+  }
+  auto requests = MakeRunRequests(true, batch, [remaining, written, failed](size_t begin, size_t end) {
+    return [remaining, written, failed, begin, end](bool ok) {
+      if (!ok) {
+        std::fill(failed->begin() + begin, failed->begin() + end, 1);
+      }
+      if (--*remaining == 0) {
+        written->set_value();
+      }
+    };
+  });
+  *remaining = requests.size();
+  // The whole batch is in flight at once.
+  auto done = written->get_future();
+  lock->unlock();
+  disk_manager_->SubmitRequests(std::move(requests));
+  done.wait();
+  lock->lock();
+  MarkFailedWritesDirty(batch, *failed);
+  for (const auto &[page_id, frame_id] : batch) {
+    frames_[frame_id]->io_state_ = PageIOState::NONE;
+    frames_[frame_id]->io_done_.notify_all();
+  }
+  metrics_.Add(BufferPoolCounter::CLEANER_WRITE, batch.size());
+}
+
+bool BufferPoolManager::ResizeBufferPool(size_t pool_size) {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  // Only ResizeBufferPool allocates frames, so the chunk can be allocated and zeroed before taking the latch.
+  std::unique_ptr<Page[]> chunk;
+  size_t chunk_size = pool_size > num_allocated_frames_ ? pool_size - num_allocated_frames_ : 0;
+  if (chunk_size > 0) {
+    chunk = AllocateFrames(chunk_size);
+  }
+
+  std::unique_lock<std::mutex> lock(latch_);
+  size_t old_pool_size = pool_size_;
+  if (chunk_size > 0) {
+    InstallFrames(std::move(chunk), chunk_size);
+  }
+  pool_size_ = pool_size;
+  replacer_->SetCapacity(pool_size);
+  if (pool_size >= old_pool_size) {
+    // Retired frames are clean and hold no page, just like new ones.
+    for (size_t i = old_pool_size; i < pool_size; i++) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    return true;
+  }
+
+  // The surplus frames are no longer handed out from here on: the free list drops them, FindFreeFrame skips them as
+  // victims and unpinning them wakes us up instead of making them evictable.
+  free_list_.remove_if([pool_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= pool_size; });
+  for (size_t i = pool_size; i < old_pool_size; i++) {
+    RetireFrame(static_cast<frame_id_t>(i), &lock);
+  }
+  return true;
+}
+
+std::unique_ptr<Page[]> BufferPoolManager::AllocateFrames(size_t num_frames) {
+  auto chunk = std::make_unique<Page[]>(num_frames);
+  for (size_t i = 0; i < num_frames; i++) {
+    chunk[i].pin_count_ = -1;
+  }
+  return chunk;
+}
+
+void BufferPoolManager::InstallFrames(std::unique_ptr<Page[]> chunk, size_t num_frames) {
+  BUSTUB_ASSERT(num_allocated_frames_ + num_frames <= max_pool_size_, "Too many frames.");
+  for (size_t i = 0; i < num_frames; i++) {
+    chunk[i].frame_id_ = static_cast<frame_id_t>(num_allocated_frames_ + i);
+    frames_[num_allocated_frames_ + i] = &chunk[i];
+  }
+  num_allocated_frames_ += num_frames;
+  chunks_.push_back(std::move(chunk));
+}
+
+void BufferPoolManager::RetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = frames_[frame_id];
+  replacer_->Remove(frame_id);
+  while (true) {
+    // Hits may keep pinning the page until it is out of the page table; every unpin to zero wakes us up.
+    page->io_done_.wait(*lock, [page] {
+      return page->io_state_ == PageIOState::NONE && !page->evicting_ && page->pin_count_ <= 0;
+    });
+    if (page->pin_count_ < 0) {
+      // The frame was free, or has been retired already.
+      return;
+    }
+    if (page->is_dirty_) {
+      FlushFrame(frame_id, lock);
+      continue;
+    }
+    if (ClaimFrame(page)) {
+      page_table_.Erase(page->page_id_);
+      page->page_id_ = INVALID_PAGE_ID;
+      metrics_.Add(BufferPoolCounter::EVICTION);
+      return;
+    }
+  }
+}
+
+void BufferPoolManager::MakeEvictable(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    replacer_->Unpin(frame_id);
+  } else {
+    frames_[frame_id]->io_done_.notify_all();
+  }
+}
+
+bool BufferPoolManager::TryPin(Page *page) {
+  int pin_count = page->pin_count_.load();
+  while (pin_count >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+      return true;
+    }
+  }
   return false;
+}
 
-}  
+bool BufferPoolManager::ClaimFrame(Page *page) {
+  int pin_count = 0;
+  return page->pin_count_.compare_exchange_strong(pin_count, -1);
+}
 
-void BufferPoolManager::FlushAllPagesImpl() {
-  //flush all pages from buffer pool to disk 
-  for (size_t i = 0; i < pool_size_; i++) {
-    FlushPageImpl(pages_[i].page_id_);
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats = metrics_.Snapshot();
+  stats.disk_writes_ = disk_manager_->GetNumWrites();
+  stats.log_flushes_ = disk_manager_->GetNumFlushes();
+  return stats;
+}
+
+std::unique_lock<std::mutex> BufferPoolManager::AcquireLatch() {
+  // An uncontended latch is not worth two clock reads; it goes into the 0ns bucket.
+  std::unique_lock<std::mutex> lock(latch_, std::try_to_lock);
+  if (lock.owns_lock()) {
+    metrics_.Record(BufferPoolLatency::LATCH_WAIT, std::chrono::nanoseconds(0));
+    return lock;
   }
+  auto start = std::chrono::steady_clock::now();
+  lock.lock();
+  metrics_.Record(BufferPoolLatency::LATCH_WAIT, std::chrono::steady_clock::now() - start);
+  return lock;
+}
+
+void BufferPoolManager::ReadPageFromDisk(page_id_t page_id, Page *page) {
+  auto start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, page->GetData());
+  metrics_.Record(BufferPoolLatency::DISK_READ, std::chrono::steady_clock::now() - start);
+}
+
+void BufferPoolManager::WaitForIO(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = frames_[frame_id];
+  page->io_done_.wait(*lock, [page] { return page->io_state_ == PageIOState::NONE; });
 }
 
 }  // namespace bustub
@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.cpp
+//
+// Identification: src/buffer/buffer_pool_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <sstream>
+
+namespace bustub {
+
+void LatencyHistogram::Merge(const LatencyHistogram &that) {
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    buckets_[i] += that.buckets_[i];
+  }
+  count_ += that.count_;
+  total_nanos_ += that.total_nanos_;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  auto rank = static_cast<uint64_t>(fraction * static_cast<double>(count_));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; i++) {
+    seen += buckets_[i];
+    if (seen > rank) {
+      return i == 0 ? 0 : (static_cast<uint64_t>(1) << i) - 1;
+    }
+  }
+  return (static_cast<uint64_t>(1) << (NUM_BUCKETS - 1)) - 1;
+}
+
+double BufferPoolStats::HitRatio() const {
+  uint64_t fetches = Get(BufferPoolCounter::HIT) + Get(BufferPoolCounter::MISS);
+  return fetches == 0 ? 0 : static_cast<double>(Get(BufferPoolCounter::HIT)) / static_cast<double>(fetches);
+}
+
+void BufferPoolStats::Merge(const BufferPoolStats &that) {
+  for (size_t i = 0; i < counters_.size(); i++) {
+    counters_[i] += that.counters_[i];
+  }
+  for (size_t i = 0; i < latencies_.size(); i++) {
+    latencies_[i].Merge(that.latencies_[i]);
+  }
+}
+
+std::string BufferPoolStats::ToString() const {
+  static const char *counter_names[] = {"hits",           "misses",         "new_pages", "evictions",
+                                        "dirty_writebacks", "cleaner_writes", "flushes",   "prefetch_reads"};
+  static const char *latency_names[] = {"latch_wait", "disk_read"};
+  std::ostringstream os;
+  for (size_t i = 0; i < counters_.size(); i++) {
+    os << counter_names[i] << "=" << counters_[i] << "\n";
+  }
+  for (size_t i = 0; i < latencies_.size(); i++) {
+    const LatencyHistogram &histogram = latencies_[i];
+    os << latency_names[i] << ": count=" << histogram.count_ << " mean_ns=" << histogram.Mean()
+       << " p50_ns<=" << histogram.Percentile(0.5) << " p99_ns<=" << histogram.Percentile(0.99) << "\n";
+  }
+  os << "disk_writes=" << disk_writes_ << "\n";
+  os << "log_flushes=" << log_flushes_ << "\n";
+  return os.str();
+}
+
+BufferPoolMetrics::BufferPoolMetrics() : shards_(std::make_unique<Shard[]>(NUM_SHARDS)) {}
+
+uint64_t BufferPoolMetrics::Get(BufferPoolCounter counter) const {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < NUM_SHARDS; i++) {
+    sum += shards_[i].counters_[static_cast<size_t>(counter)].load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+BufferPoolStats BufferPoolMetrics::Snapshot() const {
+  BufferPoolStats stats;
+  for (size_t i = 0; i < NUM_SHARDS; i++) {
+    const Shard &shard = shards_[i];
+    for (size_t c = 0; c < stats.counters_.size(); c++) {
+      stats.counters_[c] += shard.counters_[c].load(std::memory_order_relaxed);
+    }
+    for (size_t l = 0; l < stats.latencies_.size(); l++) {
+      LatencyHistogram &histogram = stats.latencies_[l];
+      for (size_t b = 0; b < LatencyHistogram::NUM_BUCKETS; b++) {
+        uint64_t count = shard.latencies_[l].buckets_[b].load(std::memory_order_relaxed);
+        histogram.buckets_[b] += count;
+        histogram.count_ += count;
+      }
+      histogram.total_nanos_ += shard.latencies_[l].total_nanos_.load(std::memory_order_relaxed);
+    }
+  }
+  return stats;
+}
+
+}  // namespace bustub
@@ -14,16 +14,58 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), states_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  // One sweep clears every reference bit it passes and a second one finds whatever is left, so a replacer with an
+  // evictable frame always yields a victim within two sweeps unless other threads keep referencing it.
+  for (size_t step = 0; step < 2 * num_pages_; step++) {
+    size_t slot = hand_.fetch_add(1, std::memory_order_relaxed) % num_pages_;
+    uint8_t state = states_[slot].load(std::memory_order_acquire);
+    while ((state & EVICTABLE) != 0) {
+      if ((state & REFERENCED) != 0) {
+        // Second chance. If the CAS fails the frame was pinned or unpinned meanwhile and keeps its new state.
+        states_[slot].compare_exchange_weak(state, EVICTABLE, std::memory_order_acq_rel);
+        break;
+      }
+      if (states_[slot].compare_exchange_weak(state, 0, std::memory_order_acq_rel)) {
+        *frame_id = static_cast<frame_id_t>(slot);
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) { states_[frame_id].store(REFERENCED, std::memory_order_release); }
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  states_[frame_id].store(EVICTABLE | REFERENCED, std::memory_order_release);
+}
 
-size_t ClockReplacer::Size() { return 0; }
+void ClockReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  // The hand takes unreferenced frames on its first sweep and the referenced ones on the second. Frames may change
+  // state while we look, so this is only a hint.
+  size_t start = hand_.load(std::memory_order_relaxed);
+  for (uint8_t wanted : {EVICTABLE, static_cast<uint8_t>(EVICTABLE | REFERENCED)}) {
+    for (size_t step = 0; step < num_pages_ && max_frames > 0; step++) {
+      size_t slot = (start + step) % num_pages_;
+      if (states_[slot].load(std::memory_order_relaxed) == wanted) {
+        frame_ids->push_back(static_cast<frame_id_t>(slot));
+        max_frames--;
+      }
+    }
+  }
+}
+
+size_t ClockReplacer::Size() {
+  size_t size = 0;
+  for (const auto &state : states_) {
+    size += (state.load(std::memory_order_relaxed) & EVICTABLE) != 0 ? 1 : 0;
+  }
+  return size;
+}
 
 }  // namespace bustub
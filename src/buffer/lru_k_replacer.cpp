@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : k_(k) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs to track at least one reference.");
+  records_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::set<Key> *candidates = infinite_distance_.empty() ? &finite_distance_ : &infinite_distance_;
+  if (candidates->empty()) {
+    return false;
+  }
+  *frame_id = candidates->begin()->second;
+  candidates->erase(candidates->begin());
+  // The frame is about to hold a different page, whose history starts from scratch.
+  records_.erase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = records_.find(frame_id);
+  if (it == records_.end() || !it->second.is_evictable_) {
+    return;
+  }
+  SetOf(it->second)->erase(KeyOf(frame_id, it->second));
+  it->second.is_evictable_ = false;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  FrameRecord &record = records_[frame_id];
+  // An evictable frame changes its position in the sets, so it is taken out and put back around the update.
+  if (record.is_evictable_) {
+    SetOf(record)->erase(KeyOf(frame_id, record));
+  }
+  record.history_.push_back(current_timestamp_++);
+  if (record.history_.size() > k_) {
+    record.history_.pop_front();
+  }
+  if (record.is_evictable_) {
+    SetOf(record)->insert(KeyOf(frame_id, record));
+  }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = records_.find(frame_id);
+  if (it == records_.end()) {
+    return;
+  }
+  if (it->second.is_evictable_) {
+    SetOf(it->second)->erase(KeyOf(frame_id, it->second));
+  }
+  records_.erase(it);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  FrameRecord &record = records_[frame_id];
+  if (record.is_evictable_) {
+    return;
+  }
+  if (record.history_.empty()) {
+    record.history_.push_back(current_timestamp_++);
+  }
+  record.is_evictable_ = true;
+  SetOf(record)->insert(KeyOf(frame_id, record));
+}
+
+void LRUKReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (const auto *candidates : {&infinite_distance_, &finite_distance_}) {
+    for (auto it = candidates->begin(); it != candidates->end() && max_frames > 0; ++it, --max_frames) {
+      frame_ids->push_back(it->second);
+    }
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return infinite_distance_.size() + finite_distance_.size();
+}
+
+std::set<LRUKReplacer::Key> *LRUKReplacer::SetOf(const FrameRecord &record) {
+  return record.history_.size() < k_ ? &infinite_distance_ : &finite_distance_;
+}
+
+LRUKReplacer::Key LRUKReplacer::KeyOf(frame_id_t frame_id, const FrameRecord &record) const {
+  // Frames with a full history are ranked by their K-th most recent reference, the others by their most recent one.
+  return {record.history_.size() < k_ ? record.history_.back() : record.history_.front(), frame_id};
+}
+
+}  // namespace bustub
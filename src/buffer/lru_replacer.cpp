@@ -57,6 +57,13 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
     
 }
 
+void LRUReplacer::PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {
+    std::lock_guard<std::mutex> lck(latch);
+    for (auto it = lst.rbegin(); it != lst.rend() && max_frames > 0; ++it, --max_frames) {
+        frame_ids->push_back(*it);
+    }
+}
+
 size_t LRUReplacer::Size() { 
     std::lock_guard<std::mutex> lck(latch);
     return replacer.size();
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(2), shift_(63) {
+  while (capacity_ < 2 * num_frames) {
+    capacity_ <<= 1;
+    shift_--;
+  }
+  mask_ = capacity_ - 1;
+  slots_ = std::make_unique<std::atomic<uint64_t>[]>(capacity_);
+  for (size_t i = 0; i < capacity_; i++) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  size_t slot = HomeSlot(page_id);
+  for (size_t probes = 0; probes < capacity_; probes++) {
+    uint64_t value = slots_[slot].load(std::memory_order_acquire);
+    if (value == EMPTY_SLOT) {
+      return false;
+    }
+    if (PageOf(value) == page_id) {
+      *frame_id = FrameOf(value);
+      return true;
+    }
+    slot = (slot + 1) & mask_;
+  }
+  return false;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(size_ + 1 < capacity_, "Page table is full.");
+  size_t slot = HomeSlot(page_id);
+  while (slots_[slot].load(std::memory_order_relaxed) != EMPTY_SLOT) {
+    slot = (slot + 1) & mask_;
+  }
+  slots_[slot].store(Pack(page_id, frame_id), std::memory_order_release);
+  size_++;
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  size_t hole = HomeSlot(page_id);
+  while (true) {
+    uint64_t value = slots_[hole].load(std::memory_order_relaxed);
+    if (value == EMPTY_SLOT) {
+      return false;
+    }
+    if (PageOf(value) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Backward-shift deletion: rather than leaving a tombstone, move later entries of the cluster into the hole as long
+  // as that does not put them before their home slot, so that probe sequences stay short without ever rehashing.
+  size_t slot = hole;
+  while (true) {
+    slot = (slot + 1) & mask_;
+    uint64_t value = slots_[slot].load(std::memory_order_relaxed);
+    if (value == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = HomeSlot(PageOf(value));
+    if (((slot - home) & mask_) >= ((slot - hole) & mask_)) {
+      slots_[hole].store(value, std::memory_order_release);
+      hole = slot;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size)
+    : BufferPoolManager(disk_manager, log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "A parallel buffer pool needs at least one instance.");
+  pool_size_ = num_instances * pool_size;
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.push_back(new BufferPoolManager(pool_size, disk_manager, log_manager, replacer_type, max_pool_size));
+  }
+  max_pool_size_ = num_instances * instances_.front()->GetMaxPoolSize();
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  // Page ids are handed out sequentially, so the modulo spreads them evenly and keeps neighbouring pages of a table
+  // in different instances.
+  return instances_[static_cast<size_t>(page_id) % instances_.size()];
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i]);
+    }
+  }
+}
+
+bool ParallelBufferPoolManager::ResizeBufferPool(size_t pool_size) {
+  size_t instance_pool_size = (pool_size + instances_.size() - 1) / instances_.size();
+  if (instance_pool_size == 0 || instance_pool_size > instances_.front()->GetMaxPoolSize()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  for (auto *instance : instances_) {
+    instance->ResizeBufferPool(instance_pool_size);
+  }
+  pool_size_ = instance_pool_size * instances_.size();
+  return true;
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(size_t min_clean_frames) {
+  for (auto *instance : instances_) {
+    instance->StartPageCleaner(min_clean_frames);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto *instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+uint64_t ParallelBufferPoolManager::GetCleanerWrites() {
+  uint64_t writes = 0;
+  for (auto *instance : instances_) {
+    writes += instance->GetCleanerWrites();
+  }
+  return writes;
+}
+
+uint64_t ParallelBufferPoolManager::GetForegroundWrites() {
+  uint64_t writes = 0;
+  for (auto *instance : instances_) {
+    writes += instance->GetForegroundWrites();
+  }
+  return writes;
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats = BufferPoolManager::GetStats();
+  // The instances share the disk manager, whose counters the base class has already filled in.
+  for (auto *instance : instances_) {
+    stats.Merge(instance->GetStats());
+  }
+  return stats;
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->FetchPageImpl(page_id, strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  return GetBufferPoolManager(page_id)->UnpinPageImpl(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPageImpl(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  // The disk manager decides the page id and the id decides the instance. Reused ids come lowest first and may all
+  // belong to the same full instance, so ids are allocated until one belongs to an instance with room, or until every
+  // instance has turned one down. The rejected ids are held until then: the disk manager moves on to fresh ids, which
+  // go round all instances, and gets them back afterwards.
+  std::vector<page_id_t> rejected;
+  std::vector<bool> full(instances_.size(), false);
+  size_t num_full = 0;
+  Page *page = nullptr;
+  while (page == nullptr && num_full < instances_.size()) {
+    page_id_t new_page_id = disk_manager_->AllocatePage();
+    size_t index = static_cast<size_t>(new_page_id) % instances_.size();
+    if (!full[index]) {
+      page = instances_[index]->InstallNewPage(new_page_id, strategy);
+    }
+    if (page == nullptr) {
+      rejected.push_back(new_page_id);
+      if (!full[index]) {
+        full[index] = true;
+        num_full++;
+      }
+    } else {
+      *page_id = new_page_id;
+    }
+  }
+  for (auto rejected_page_id : rejected) {
+    disk_manager_->DeallocatePage(rejected_page_id);
+  }
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->DeletePageImpl(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  for (auto *instance : instances_) {
+    instance->FlushAllPagesImpl();
+  }
+}
+
+}  // namespace bustub
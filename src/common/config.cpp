@@ -20,4 +20,10 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(10);
+
+size_t buffer_pool_frames = BUFFER_POOL_SIZE;
+
+size_t buffer_pool_max_frames = BUFFER_POOL_SIZE;
+
 }  // namespace bustub
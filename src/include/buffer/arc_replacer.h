@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST '03).
+ *
+ * Resident frames are kept in two LRU lists: T1 holds pages that were accessed once since they were brought in, T2
+ * pages that were accessed at least twice. The page ids of pages recently evicted from T1 and T2 are remembered in the
+ * ghost lists B1 and B2. A miss on a page in B1 means T1 was too small and grows its target size p; a miss on a page
+ * in B2 shrinks it. Scans only ever fill T1 and leave the frequently used pages in T2 alone, while a workload of
+ * recency-driven point lookups lets T1 grow.
+ *
+ * The buffer pool manager picks its victim before it installs the missing page, so the target is adjusted when the
+ * page is recorded in its new frame, i.e. one replacement later than in the original algorithm.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  /**
+   * Unpins a frame. A frame that was never accessed is treated as a new page in T1.
+   * @param frame_id the id of the frame to unpin
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  size_t Size() override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * Resizes the cache the policy adapts to. The target size of T1 is capped and the ghost lists are trimmed to match.
+   * @param num_pages the number of frames in the buffer pool
+   */
+  void SetCapacity(size_t num_pages) override;
+
+  /** @return the current target size of T1 */
+  size_t GetTarget();
+
+ private:
+  struct FrameEntry {
+    /** The page held by the frame. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** True if the frame is in T2, false if it is in T1. */
+    bool frequent_{false};
+    /** True if the frame can currently be victimized. */
+    bool is_evictable_{false};
+    /** Position of the frame in T1 or T2. */
+    std::list<frame_id_t>::iterator pos_;
+  };
+
+  /** A list of page ids of evicted pages, most recently evicted first, with an index for lookups. */
+  struct GhostList {
+    std::list<page_id_t> list_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+
+    size_t Size() const { return list_.size(); }
+    bool Contains(page_id_t page_id) const { return index_.count(page_id) != 0; }
+    void PushFront(page_id_t page_id);
+    void Erase(page_id_t page_id);
+    void PopBack();
+  };
+
+  /** Drops the oldest ghosts until the directory is within the bounds of capacity_. Must be called with latch_ held. */
+  void TrimGhosts();
+
+  /** Puts the frame at the most recently used end of T1 or T2. Must be called with latch_ held. */
+  void Insert(frame_id_t frame_id, FrameEntry *entry, bool frequent);
+
+  /** Takes the frame out of T1 or T2. Must be called with latch_ held. */
+  void Detach(const FrameEntry &entry);
+
+  /**
+   * Takes the least recently used evictable frame out of the given list and remembers its page in the matching ghost
+   * list. Must be called with latch_ held.
+   * @return false if the list has no evictable frame
+   */
+  bool EvictFrom(bool frequent, frame_id_t *frame_id);
+
+  /** The number of frames, c in the paper. */
+  size_t capacity_;
+  /** The target size of T1, p in the paper. */
+  size_t target_{0};
+  /** Resident frames accessed once (T1) and more than once (T2), most recently used first. */
+  std::list<frame_id_t> recent_;
+  std::list<frame_id_t> frequent_;
+  /** Ghosts of pages evicted from T1 (B1) and T2 (B2). */
+  GhostList recent_ghosts_;
+  GhostList frequent_ghosts_;
+  /** Every frame in T1 or T2. */
+  std::unordered_map<frame_id_t, FrameEntry> frames_;
+  /** Number of evictable frames. */
+  size_t num_evictable_{0};
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
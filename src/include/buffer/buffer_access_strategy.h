@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy confines an operation that touches many pages once, such as a sequential scan or a bulk
+ * insert, to a small ring of frames. Every miss the operation takes goes to the next slot of the ring: if the frame in
+ * that slot still holds the page the operation put there and nobody else is using it, the frame is recycled directly,
+ * without asking the replacer. Otherwise a frame is found the usual way and takes over the slot. The operation thus
+ * keeps cycling through the same few frames and leaves the rest of the buffer pool alone.
+ *
+ * A ParallelBufferPoolManager gives the operation one ring in every instance it touches. A ring never takes more than
+ * an eighth of its buffer pool, so that a strategy cannot starve everybody else in a small pool.
+ *
+ * A strategy belongs to one operation and must not be shared between threads.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size the number of frames the operation may cycle through in every buffer pool instance
+   */
+  explicit BufferAccessStrategy(size_t ring_size) : ring_size_(ring_size) {}
+
+  /** @return the requested number of frames per ring */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  friend class BufferPoolManager;
+
+  /** A frame that the operation loaded a page into. */
+  struct Slot {
+    frame_id_t frame_id_{-1};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** The slots of one buffer pool instance, recycled round-robin. */
+  struct Ring {
+    std::vector<Slot> slots_;
+    size_t next_{0};
+  };
+
+  /** Requested number of frames per ring. */
+  size_t ring_size_;
+  /** One ring per buffer pool instance the operation has missed in, sized by that instance. */
+  std::unordered_map<const BufferPoolManager *, Ring> rings_;
+};
+
+}  // namespace bustub
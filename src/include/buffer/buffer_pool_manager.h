@@ -12,14 +12,31 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <list>
-#include <mutex>  // NOLINT
-#include <unordered_map>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent_allocator.h"
 #include "storage/page/page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -36,13 +53,16 @@ class BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param max_pool_size the size ResizeBufferPool may grow the buffer pool to; 0 means pool_size
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -91,13 +111,148 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /**
+   * Fetches a page on behalf of an operation that runs under a buffer access strategy. A miss recycles a frame from
+   * the strategy's ring where it can. Pages are unpinned with UnpinPage as usual.
+   * @param page_id id of page to be fetched
+   * @param strategy the strategy of the operation, or nullptr for the behavior of FetchPage
+   * @return the requested page, or nullptr if no frame could be found
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPageImpl(page_id, strategy);
+  }
+
+  /**
+   * Creates a new page on behalf of an operation that runs under a buffer access strategy, see FetchPageWithStrategy.
+   * @param[out] page_id id of created page
+   * @param strategy the strategy of the operation, or nullptr for the behavior of NewPage
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+    return NewPageImpl(page_id, strategy);
+  }
+
+  /**
+   * Fetches a page and returns it pinned inside a guard, which unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return a guard for the page, empty if no frame could be found
+   */
+  BasicPageGuard FetchPageBasic(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetches a page and returns it pinned and read-latched inside a guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return a guard for the page, empty if no frame could be found
+   */
+  ReadPageGuard FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Fetches a page and returns it pinned and write-latched inside a guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return a guard for the page, empty if no frame could be found
+   */
+  WritePageGuard FetchPageWrite(page_id_t page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Creates a new page and returns it pinned inside a guard.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return a guard for the page, empty if no new page could be created
+   */
+  BasicPageGuard NewPageGuarded(page_id_t *page_id, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Creates a new page whose id comes from the extent of a table or index rather than straight from the disk manager,
+   * and returns it pinned inside a guard.
+   * @param[out] page_id id of created page
+   * @param extent the extent allocator of the table or index
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return a guard for the page, empty if no new page could be created
+   */
+  BasicPageGuard NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * @param page_id the page id to look up
+   * @return the buffer pool instance whose frames hold page_id; this buffer pool itself unless it is made of several
+   */
+  virtual BufferPoolManager *GetBufferPoolManager(page_id_t page_id) { return this; }
+
+  /** @return pointer to the pages allocated when the buffer pool was created, its first GetPoolSize() frames */
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /** @return the size the buffer pool may be grown to */
+  size_t GetMaxPoolSize() { return max_pool_size_; }
+
+  /**
+   * Changes the number of frames of the buffer pool while it is in use.
+   *
+   * Growing adds frames to the free list; frames beyond those allocated so far are allocated as a new chunk, so the
+   * existing frames never move. Shrinking stops handing out the frames with the highest ids at once, then writes back
+   * and evicts the pages they hold. A pinned page is evicted when its last pin goes away, so this blocks until
+   * everybody has unpinned the pages in the surplus frames. The memory of retired frames is kept for a later grow.
+   *
+   * @param pool_size the new number of frames, between 1 and GetMaxPoolSize()
+   * @return false if pool_size is out of range
+   */
+  virtual bool ResizeBufferPool(size_t pool_size);
+
+  /**
+   * Asks for pages to be read into the buffer pool ahead of their use. Returns immediately; a background thread sets
+   * up frames for the pages in order, without pinning them, and has the disk manager read up to ASYNC_IO_QUEUE_DEPTH
+   * of them at a time asynchronously, runs of contiguous pages with one I/O each. At most half of the pool is being
+   * prefetched at any time. Each page becomes evictable once it is loaded. A FetchPage that comes in while the read
+   * is in flight waits for it instead of issuing its own, and one that finds no free frame waits for a read to
+   * complete. Pages that are already resident, that were never allocated, or that do not fit in the queue are
+   * skipped, so this is only a hint.
+   * @param page_ids ids of the pages to read, in the order they will be needed
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * Starts a background thread that writes dirty pages back before the replacer gets to them, so that a miss usually
+   * finds a clean victim instead of waiting for a write. Every PAGE_CLEANER_INTERVAL, and whenever a miss had to
+   * write back its victim itself, the cleaner asks the replacer for the next victims and writes the dirty ones as one
+   * batch of asynchronous writes, submitted in page id order. Does nothing if the cleaner is already running.
+   * @param min_clean_frames the number of free or clean evictable frames the cleaner tries to keep available
+   */
+  virtual void StartPageCleaner(size_t min_clean_frames);
+
+  /**
+   * Stops and joins the page cleaner thread, if it is running.
+   */
+  virtual void StopPageCleaner();
+
+  /** @return the number of pages written back by the page cleaner */
+  virtual uint64_t GetCleanerWrites() { return metrics_.Get(BufferPoolCounter::CLEANER_WRITE); }
+
+  /** @return the number of pages written back by a miss or NewPage because their victim was dirty */
+  virtual uint64_t GetForegroundWrites() { return metrics_.Get(BufferPoolCounter::DIRTY_WRITEBACK); }
+
+  /**
+   * Takes a snapshot of the counters and latency histograms of the buffer pool, along with the write and flush counts
+   * of its disk manager. The counters are always on; they are cheap enough for that.
+   * @return the snapshot
+   */
+  virtual BufferPoolStats GetStats();
+
  protected:
+  friend class ParallelBufferPoolManager;
+  friend class BasicPageGuard;
+
+  /**
+   * Creates a BufferPoolManager that owns no frames of its own. Used by managers that route requests to other
+   * buffer pools, e.g. ParallelBufferPoolManager.
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   */
+  BufferPoolManager(DiskManager *disk_manager, LogManager *log_manager);
+
   /**
    * Grading function. Do not modify!
    * Invokes the callback function if it is not null.
@@ -116,7 +271,15 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  Page *FetchPageImpl(page_id_t page_id) { return FetchPageImpl(page_id, nullptr); }
+
+  /**
+   * Fetch the requested page from the buffer pool, recycling the strategy's ring on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return the requested page
+   */
+  virtual Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,49 +287,309 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+
+  /**
+   * Unpins the page held in the given frame, without looking it up in the page table. Used by page guards.
+   * @param frame_id the frame that holds the page
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool UnpinFrame(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Drops one pin of the page held in the given frame. Must be called with latch_ held.
+   * @param frame_id the frame that holds the page
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  bool ReleasePin(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Wraps a page that was just pinned by this buffer pool instance in a guard.
+   * @param page the pinned page, or nullptr
+   * @return the guard, empty if page is nullptr
+   */
+  BasicPageGuard MakeGuard(Page *page);
 
   /**
    * Flushes the target page to disk.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id);
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  Page *NewPageImpl(page_id_t *page_id) { return NewPageImpl(page_id, nullptr); }
+
+  /**
+   * Creates a new page in the buffer pool, recycling the strategy's ring.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy);
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id);
 
   /**
    * Flushes all the pages in the buffer pool to disk.
    */
-  void FlushAllPagesImpl();
+  virtual void FlushAllPagesImpl();
 
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
+  /**
+   * Brings a page that has already been allocated on disk into the buffer pool as a new, zeroed and pinned page.
+   * @param page_id id of the page to install
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return nullptr if no frame could be found, otherwise pointer to the new page
+   */
+  Page *InstallNewPage(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Finds a frame that can hold a new page, taking it from the free list first and the replacer second. A dirty
+   * victim is written back with the latch released; its old page stays in the page table until the write is done, so
+   * concurrent requests for it keep hitting the frame. The victim is marked Page::evicting_ meanwhile, which keeps it
+   * out of the replacer and out of DeletePage. With a strategy, the frame in the current slot of its ring is tried
+   * before anything else.
+   * @param[out] frame_id id of the frame that was found
+   * @param lock the held lock on latch_, released during write-back
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindFreeFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock,
+                     BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Takes the page out of a frame that has just been removed from the replacer, writing it back first if it is dirty.
+   * Gives up if the page is pinned or dirtied again while the latch is released.
+   * @param frame_id the frame to reclaim
+   * @param lock the held lock on latch_, released during write-back
+   * @return true if the frame is now empty and belongs to the caller
+   */
+  bool ReclaimFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Reclaims the frame in the current slot of the strategy's ring, if it still holds the page the strategy left there
+   * and nobody is using it.
+   * @param[out] frame_id the recycled frame
+   * @param lock the held lock on latch_
+   * @param strategy the buffer access strategy of the caller
+   * @return true if the frame could be recycled
+   */
+  bool RecycleRingFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock, BufferAccessStrategy *strategy);
+
+  /** @return the current slot of the strategy's ring in this buffer pool, creating the ring if needed */
+  BufferAccessStrategy::Slot &CurrentRingSlot(BufferAccessStrategy *strategy);
+
+  /**
+   * Records the page that a miss under the strategy brought into frame_id in the current slot of its ring and moves
+   * on to the next slot. Does nothing without a strategy.
+   */
+  void RememberInRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Drops the copy of a page id that was just allocated from the buffer pool, if there is one: the prefetcher may
+   * have read the page while its id was free. Waits for I/O in flight on it first.
+   * @param page_id id of the new page
+   * @param lock the held lock on latch_, released while waiting
+   */
+  void DropStalePage(page_id_t page_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Zeroes the given frame, installs page_id in it with a pin count of one and registers it in the page table.
+   * Must be called with latch_ held.
+   * @param frame_id id of a frame obtained from FindFreeFrame
+   * @param page_id id of the new page
+   * @return pointer to the new page
+   */
+  Page *InitNewPage(frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Writes the page held in the given frame back to disk if it is dirty. The latch is released during the write. The
+   * frame keeps its place in the replacer; if it is picked as a victim meanwhile, FindFreeFrame waits for the write.
+   * @param frame_id id of the frame to flush, must not have any I/O in flight
+   * @param lock the held lock on latch_
+   */
+  void FlushFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Marks the pages of a batch whose write failed dirty again, so that they are written later, and logs the failure.
+   * @param batch the pages and the frames that hold them
+   * @param failed for each page of the batch, nonzero if its write failed
+   */
+  void MarkFailedWritesDirty(const std::vector<std::pair<page_id_t, frame_id_t>> &batch,
+                             const std::vector<char> &failed);
+
+  /**
+   * Turns a batch of pages, sorted by page id, into disk requests, one per run of at most EXTENT_SIZE contiguous page
+   * ids.
+   * @param is_write true to write the pages, false to read them
+   * @param batch the pages and the frames that hold them
+   * @param make_callback makes the callback of the request for the pages batch[begin, end)
+   * @return the requests
+   */
+  std::vector<DiskRequest> MakeRunRequests(
+      bool is_write, const std::vector<std::pair<page_id_t, frame_id_t>> &batch,
+      const std::function<std::function<void(bool)>(size_t begin, size_t end)> &make_callback);
+
+  /**
+   * Body of the prefetch thread.
+   */
+  void RunPrefetcher();
+
+  /** @return how many prefetched pages may be read at once; the other frames stay available to fetches */
+  size_t MaxPrefetchReads() const { return std::max<size_t>(pool_size_ / 2, 1); }
+
+  /**
+   * Waits for a prefetched page to be read, after FindFreeFrame came back empty handed: frames being prefetched are
+   * neither free nor evictable until then.
+   * @param lock the held lock on latch_, released while waiting
+   * @return false, without waiting, if no prefetched page is being read
+   */
+  bool WaitForPrefetchRead(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Body of the page cleaner thread.
+   */
+  void RunPageCleaner();
+
+  /**
+   * Writes back the dirty frames among the next victims of the replacer, until min_clean_frames_ frames are free or
+   * clean, or the replacer has nothing more to offer. The latch is released during the writes.
+   * @param lock the held lock on latch_
+   */
+  void CleanFrames(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Allocates a chunk of new frames, which are retired until ResizeBufferPool puts them in the free list.
+   * @param num_frames the number of frames, such that at most max_pool_size_ frames are allocated
+   * @return the chunk, to be installed with InstallFrames
+   */
+  static std::unique_ptr<Page[]> AllocateFrames(size_t num_frames);
+
+  /**
+   * Makes a chunk from AllocateFrames the next frames of the buffer pool. Must be called with latch_ held.
+   * @param chunk the chunk
+   * @param num_frames the number of frames in the chunk
+   */
+  void InstallFrames(std::unique_ptr<Page[]> chunk, size_t num_frames);
+
+  /**
+   * Writes back and evicts the page held by a frame beyond pool_size_, waiting for it to be unpinned first.
+   * @param frame_id the frame to retire
+   * @param lock the held lock on latch_, released while waiting
+   */
+  void RetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Hands a frame that just became unpinned to the replacer, unless it is being retired; ResizeBufferPool is woken up
+   * instead. Must be called with latch_ held.
+   * @param frame_id the frame
+   */
+  void MakeEvictable(frame_id_t frame_id);
+
+  /**
+   * Pins a page without the latch, unless its frame is free or being handed to another page.
+   * @param page the page to pin
+   * @return true if the page was pinned
+   */
+  static bool TryPin(Page *page);
+
+  /**
+   * Takes an unpinned frame away from its page, so that a hit that has found the frame through a stale page table
+   * entry can no longer pin it. Must be called with latch_ held.
+   * @param page the page held by the frame
+   * @return false if the page is pinned
+   */
+  static bool ClaimFrame(Page *page);
+
+  /**
+   * Locks latch_ on behalf of a foreground request, recording how long it had to wait for it.
+   * @return the held lock
+   */
+  std::unique_lock<std::mutex> AcquireLatch();
+
+  /**
+   * Reads a page from disk with the latch released, recording how long the read took.
+   * @param page_id id of the page to read
+   * @param page the frame to read it into
+   */
+  void ReadPageFromDisk(page_id_t page_id, Page *page);
+
+  /**
+   * Blocks until no I/O is in flight on the given frame.
+   * @param frame_id id of the frame to wait for
+   * @param lock the held lock on latch_, released while waiting
+   */
+  void WaitForIO(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /** Number of frames in use. Frames with a higher id are retired or not allocated yet. Changed under latch_. */
+  std::atomic<size_t> pool_size_;
+  /** Upper bound of pool_size_, which sizes the page table, the replacer and frames_. */
+  size_t max_pool_size_;
+  /** Array of the buffer pool pages allocated at construction. */
   Page *pages_;
+  /**
+   * Every allocated frame by frame id. Its size is max_pool_size_ from the start, so that it is never reallocated
+   * under a hit that reads it without the latch.
+   */
+  std::unique_ptr<Page *[]> frames_;
+  /** The chunks of frames allocated so far, the first one being pages_. Changed under latch_. */
+  std::vector<std::unique_ptr<Page[]>> chunks_;
+  /** Number of frames allocated so far. Changed under latch_. */
+  size_t num_allocated_frames_{0};
+  /** Serializes ResizeBufferPool. */
+  std::mutex resize_latch_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Written under latch_, read by hits without it. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects page_table_, free_list_, the replacer and the book-keeping fields of every page. It is never
+   * held across disk I/O; frames with I/O in flight are marked through Page::io_state_ instead. Hits look up
+   * page_table_ and pin their frame without it; see TryPin and ClaimFrame.
+   */
   std::mutex latch_;
+
+  /** The prefetch thread, started by the first PrefetchPages. */
+  std::thread prefetch_thread_;
+  /** True while the prefetch thread should keep running, protected by latch_. */
+  bool prefetcher_running_{false};
+  /** Pages waiting to be prefetched, protected by latch_. Never longer than the pool. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Prefetched pages whose read has not completed yet, protected by latch_. */
+  size_t prefetch_reads_in_flight_{0};
+  /**
+   * Wakes up the prefetch thread when pages are queued, when it is stopped or when a prefetched page has been read, and
+   * whoever waits for prefetched pages to be read.
+   */
+  std::condition_variable prefetch_cv_;
+
+  /** The page cleaner thread, if started. */
+  std::thread cleaner_thread_;
+  /** True while the page cleaner should keep running, protected by latch_. */
+  bool cleaner_running_{false};
+  /** The number of free or clean evictable frames the page cleaner tries to keep, protected by latch_. */
+  size_t min_clean_frames_{0};
+  /** Wakes the page cleaner up early, e.g. when it is stopped or when a miss had to write back its victim. */
+  std::condition_variable cleaner_cv_;
+
+  /** Counters and latency histograms, see GetStats. */
+  BufferPoolMetrics metrics_;
 };
 }  // namespace bustub
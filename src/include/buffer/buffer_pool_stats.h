@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace bustub {
+
+/** The events counted by a buffer pool. */
+enum class BufferPoolCounter {
+  /** FetchPage found the page in the buffer pool. */
+  HIT = 0,
+  /** FetchPage had to read the page from disk. */
+  MISS,
+  /** NewPage created a page. */
+  NEW_PAGE,
+  /** A page was taken out of its frame to make room for another one. */
+  EVICTION,
+  /** A miss or NewPage had to write back its dirty victim itself. */
+  DIRTY_WRITEBACK,
+  /** The page cleaner wrote back a dirty page. */
+  CLEANER_WRITE,
+  /** FlushPage, FlushAllPages or a shrinking ResizeBufferPool wrote back a dirty page. */
+  FLUSH,
+  /** The prefetch thread read a page ahead of its use. */
+  PREFETCH_READ,
+  NUM_COUNTERS
+};
+
+/** The latencies recorded by a buffer pool. */
+enum class BufferPoolLatency {
+  /** Time spent waiting for the buffer pool latch. */
+  LATCH_WAIT = 0,
+  /** Time spent reading a page from disk, by a miss or by the prefetch thread. */
+  DISK_READ,
+  NUM_LATENCIES
+};
+
+/**
+ * A histogram of latencies in nanoseconds with power-of-two buckets: bucket 0 counts the latencies of 0ns, and bucket
+ * i > 0 those in [2^(i-1), 2^i) ns. The last bucket also takes everything above it.
+ */
+struct LatencyHistogram {
+  static constexpr size_t NUM_BUCKETS = 40;
+
+  /** @return the bucket of a latency */
+  static size_t BucketOf(uint64_t nanos) {
+    size_t bucket = nanos == 0 ? 0 : 64 - __builtin_clzll(nanos);
+    return bucket < NUM_BUCKETS ? bucket : NUM_BUCKETS - 1;
+  }
+
+  /** Adds up the buckets of another histogram. */
+  void Merge(const LatencyHistogram &that);
+
+  /** @return the mean latency in nanoseconds, 0 if the histogram is empty */
+  uint64_t Mean() const { return count_ == 0 ? 0 : total_nanos_ / count_; }
+
+  /**
+   * @param fraction a number between 0 and 1, e.g. 0.99
+   * @return an upper bound of the given percentile in nanoseconds, i.e. the end of the bucket that holds it
+   */
+  uint64_t Percentile(double fraction) const;
+
+  std::array<uint64_t, NUM_BUCKETS> buckets_{};
+  /** Number of latencies recorded. */
+  uint64_t count_{0};
+  /** Sum of the latencies recorded, in nanoseconds. */
+  uint64_t total_nanos_{0};
+};
+
+/**
+ * A snapshot of the counters and latency histograms of a buffer pool, together with the counters of its disk manager.
+ * For a ParallelBufferPoolManager the buffer pool figures are summed over its instances.
+ */
+struct BufferPoolStats {
+  /** @return the value of a counter */
+  uint64_t Get(BufferPoolCounter counter) const { return counters_[static_cast<size_t>(counter)]; }
+
+  /** @return the histogram of a latency */
+  const LatencyHistogram &Get(BufferPoolLatency latency) const { return latencies_[static_cast<size_t>(latency)]; }
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  double HitRatio() const;
+
+  /** Adds up the counters and histograms of another buffer pool, leaving the disk manager counters alone. */
+  void Merge(const BufferPoolStats &that);
+
+  /** @return the snapshot in a human-readable form, one figure per line */
+  std::string ToString() const;
+
+  std::array<uint64_t, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+  std::array<LatencyHistogram, static_cast<size_t>(BufferPoolLatency::NUM_LATENCIES)> latencies_{};
+  /** DiskManager::GetNumWrites(). */
+  uint64_t disk_writes_{0};
+  /** DiskManager::GetNumFlushes(), i.e. log flushes. */
+  uint64_t log_flushes_{0};
+};
+
+/**
+ * BufferPoolMetrics holds the counters and latency histograms of a buffer pool instance. They are split into shards so
+ * that they can stay enabled in production: each thread sticks to one shard, which lives on cache lines of its own, and
+ * updates it with relaxed atomic increments. Snapshot sums the shards up; it may run concurrently with updates, and
+ * then sees each of them or not.
+ */
+class BufferPoolMetrics {
+ public:
+  BufferPoolMetrics();
+
+  /** Adds n to a counter. */
+  void Add(BufferPoolCounter counter, uint64_t n = 1) {
+    LocalShard().counters_[static_cast<size_t>(counter)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /** Records a latency. */
+  void Record(BufferPoolLatency latency, std::chrono::nanoseconds elapsed) {
+    auto nanos = static_cast<uint64_t>(elapsed.count());
+    Histogram &histogram = LocalShard().latencies_[static_cast<size_t>(latency)];
+    histogram.buckets_[LatencyHistogram::BucketOf(nanos)].fetch_add(1, std::memory_order_relaxed);
+    histogram.total_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+  }
+
+  /** @return the sum of one counter over all shards */
+  uint64_t Get(BufferPoolCounter counter) const;
+
+  /** @return the counters and histograms summed over all shards; the disk manager counters are left at 0 */
+  BufferPoolStats Snapshot() const;
+
+ private:
+  /** Number of shards, a power of two. Threads beyond it share shards, which is still correct. */
+  static constexpr size_t NUM_SHARDS = 16;
+
+  struct Histogram {
+    std::array<std::atomic<uint64_t>, LatencyHistogram::NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> total_nanos_{0};
+  };
+
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(BufferPoolCounter::NUM_COUNTERS)> counters_{};
+    std::array<Histogram, static_cast<size_t>(BufferPoolLatency::NUM_LATENCIES)> latencies_{};
+  };
+
+  /** @return the shard of the calling thread; threads are spread over the shards in the order they first get here */
+  Shard &LocalShard() {
+    static std::atomic<size_t> next_shard{0};
+    thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) & (NUM_SHARDS - 1);
+    return shards_[shard];
+  }
+
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace bustub
@@ -12,8 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +23,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * The state of every frame is one byte in a flat array of atomics, holding an evictable bit and a reference bit, so
+ * sixty-four frames share a cache line and no latch is taken. Pin and Unpin are a single atomic store each and never
+ * touch the clock hand. Victim advances the hand and claims frames with compare-and-swap, so concurrent victims
+ * never claim the same frame.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -43,10 +48,23 @@ class ClockReplacer : public Replacer {
 
   void Unpin(frame_id_t frame_id) override;
 
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  /** @return the number of evictable frames; this scans every frame and is not meant for the hot path */
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** Set while the frame is unpinned and can be victimized. */
+  static constexpr uint8_t EVICTABLE = 0x1;
+  /** Set whenever the frame is used; cleared by the clock hand as it passes. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  /** Number of frames tracked. */
+  size_t num_pages_;
+  /** Per-frame EVICTABLE and REFERENCED bits. */
+  std::vector<std::atomic<uint8_t>> states_;
+  /** The clock hand. Its value modulo num_pages_ is the next frame to look at. */
+  std::atomic<size_t> hand_{0};
 };
 
 }  // namespace bustub
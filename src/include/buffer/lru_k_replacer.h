@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every recorded access is a reference to the frame and is stamped with a logical timestamp; the last K of them are
+ * kept. The backward K-distance of a frame is the time since its K-th most recent reference, and the evictable frame
+ * with the largest distance is the victim. Frames with fewer than K references have an infinite distance and are
+ * evicted first, least recently referenced first. A page touched once by a large scan therefore leaves before a page
+ * that index lookups keep coming back to.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of references tracked per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * Unpins a frame. A frame that was never accessed counts as referenced now.
+   * @param frame_id the id of the frame to unpin
+   */
+  void Unpin(frame_id_t frame_id) override;
+
+  void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) override;
+
+  size_t Size() override;
+
+ private:
+  /** Ordering key of an evictable frame: the timestamp it is ranked by, then the frame id. */
+  using Key = std::pair<size_t, frame_id_t>;
+
+  struct FrameRecord {
+    /** The timestamps of the last (up to) K references, oldest first. */
+    std::deque<size_t> history_;
+    /** True if the frame can currently be victimized. */
+    bool is_evictable_{false};
+  };
+
+  /** @return the set that an evictable frame with this record belongs in */
+  std::set<Key> *SetOf(const FrameRecord &record);
+
+  /** @return the key of an evictable frame with this record */
+  Key KeyOf(frame_id_t frame_id, const FrameRecord &record) const;
+
+  /** Number of references tracked per frame. */
+  size_t k_;
+  /** Logical clock, incremented on every reference. */
+  size_t current_timestamp_{0};
+  /** Reference history of every frame the replacer has seen since it was last victimized. */
+  std::unordered_map<frame_id_t, FrameRecord> records_;
+  /** Evictable frames with fewer than K references, ordered by their most recent reference. */
+  std::set<Key> infinite_distance_;
+  /** Evictable frames with K references, ordered by their K-th most recent reference. */
+  std::set<Key> finite_distance_;
+  /** Protects all of the above. */
+  std::mutex latch_;
+};
+
+}  // namespace bustub
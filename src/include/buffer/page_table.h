@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages held by a buffer pool instance to their frames. It is an open-addressing hash
+ * table with linear probing and a fixed number of slots, at least twice the number of frames, so it never allocates
+ * after construction and never gets more than half full.
+ *
+ * Every slot is a single atomic word holding both the page id and the frame id. Insert and Erase must be serialized by
+ * the caller, but Find may run concurrently with them without any latch. Such a Find can miss an entry that Erase is
+ * shifting back into a hole, or return a frame that is being given to another page; the caller validates the frame
+ * and falls back to a latched lookup, which is exact.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_frames the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Looks up the frame of a page. Safe to call concurrently with Insert and Erase.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame that holds the page
+   * @return true if the page was found
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * @param page_id the page to look up
+   * @return true if the page is in the table
+   */
+  bool Contains(page_id_t page_id) const {
+    frame_id_t frame_id;
+    return Find(page_id, &frame_id);
+  }
+
+  /**
+   * Adds a page that is not in the table yet.
+   * @param page_id the page
+   * @param frame_id the frame that holds the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a page.
+   * @param page_id the page
+   * @return true if the page was in the table
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of entries */
+  size_t Size() const { return size_; }
+
+ private:
+  /** The value of an empty slot; no entry packs to it, since page ids are never INVALID_PAGE_ID. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static page_id_t PageOf(uint64_t slot) { return static_cast<page_id_t>(slot >> 32); }
+  static frame_id_t FrameOf(uint64_t slot) { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot where probing for page_id starts; Fibonacci hashing spreads out consecutive page ids */
+  size_t HomeSlot(page_id_t page_id) const {
+    return static_cast<size_t>((static_cast<uint32_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> shift_);
+  }
+
+  /** Number of slots, a power of two. */
+  size_t capacity_;
+  /** capacity_ - 1. */
+  size_t mask_;
+  /** 64 - log2(capacity_). */
+  int shift_;
+  /** Number of entries, only touched by the serialized writers. */
+  size_t size_{0};
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager splits the buffer pool into several independent BufferPoolManager instances, each with its
+ * own frames, page table, replacer and latch. Every page id is owned by exactly one instance, so requests for
+ * different pages rarely contend on the same latch.
+ *
+ * ParallelBufferPoolManager is a BufferPoolManager, so it can be handed to TableHeap, BPlusTree, the hash table, etc.
+ * without any changes on their side. GetPages() returns nullptr because the frames are not contiguous.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the size of each individual instance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param max_pool_size the size ResizeBufferPool may grow each instance to; 0 means pool_size
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return the number of individual instances */
+  size_t GetNumInstances() const { return instances_.size(); }
+
+  /**
+   * @param page_id the page id to look up
+   * @return the instance that is responsible for page_id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id) override;
+
+  /**
+   * Hands every page to the instance that owns it, so that the instances read their share in parallel.
+   * @param page_ids ids of the pages to read, in the order they will be needed
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids) override;
+
+  /**
+   * Resizes every instance to an equal share of the given size, rounded up.
+   * @param pool_size the new total number of frames
+   * @return false if the share of an instance is out of its range
+   */
+  bool ResizeBufferPool(size_t pool_size) override;
+
+  /**
+   * Starts a page cleaner in every instance.
+   * @param min_clean_frames the number of free or clean evictable frames each instance tries to keep available
+   */
+  void StartPageCleaner(size_t min_clean_frames) override;
+
+  void StopPageCleaner() override;
+
+  uint64_t GetCleanerWrites() override;
+
+  uint64_t GetForegroundWrites() override;
+
+  /** @return the counters and latency histograms summed over every instance, and those of the disk manager */
+  BufferPoolStats GetStats() override;
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  /**
+   * Allocates a page id on disk and creates the page in the instance that owns it.
+   * @param[out] page_id id of created page
+   * @param strategy the buffer access strategy of the caller, may be nullptr
+   * @return nullptr if no instance has a frame available, otherwise pointer to new page
+   */
+  Page *NewPageImpl(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The individual buffer pools. Page p lives in instances_[p % instances_.size()]. */
+  std::vector<BufferPoolManager *> instances_;
+};
+
+}  // namespace bustub
@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManager can be created with. */
+enum class ReplacerType { LRU, LRU_K, ARC, CLOCK };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -45,6 +50,36 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
+
+  /**
+   * Records an access to a page. The buffer pool manager calls this on every hit, and on every miss once the page has
+   * been given its frame, before pinning the frame. Policies that only look at frames can ignore it.
+   * @param frame_id the id of the frame that holds the page
+   * @param page_id the id of the page that was accessed
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Removes a frame whose page was deleted, so that it is neither victimized nor remembered. By default this only
+   * pins the frame.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * Lists the frames that Victim would pick next, most likely victim first, without removing them. The buffer pool
+   * manager uses this to clean dirty frames before they are evicted. By default nothing is listed.
+   * @param max_frames the maximum number of frames to list
+   * @param[out] frame_ids the frames, appended in eviction order
+   */
+  virtual void PeekVictims(size_t max_frames, std::vector<frame_id_t> *frame_ids) {}
+
+  /**
+   * Tells the replacer that the buffer pool now has the given number of frames, never more than it was created for.
+   * Policies that size their history by the pool adjust it; by default nothing happens.
+   * @param num_pages the number of frames in the buffer pool
+   */
+  virtual void SetCapacity(size_t num_pages) {}
 };
 
 }  // namespace bustub
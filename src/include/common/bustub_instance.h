@@ -32,7 +32,8 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_ = new BufferPoolManager(buffer_pool_frames, disk_manager_, log_manager_, ReplacerType::LRU,
+                                                 buffer_pool_max_frames);
 
     // txn related
     lock_manager_ = new LockManager();
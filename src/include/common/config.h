@@ -27,6 +27,15 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The buffer pool page cleaner, if started, looks for dirty frames every PAGE_CLEANER_INTERVAL. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** The number of frames a BustubInstance starts its buffer pool with. Defaults to BUFFER_POOL_SIZE. */
+extern size_t buffer_pool_frames;
+
+/** The number of frames a BustubInstance may grow its buffer pool to at runtime, at least BUFFER_POOL_FRAMES. */
+extern size_t buffer_pool_max_frames;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +44,14 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // references tracked by LRU-K
+static constexpr int TABLE_SCAN_PREFETCH_WINDOW = 16;                         // pages read ahead of a table scan
+static constexpr int SEQ_SCAN_RING_SIZE = 32;                                 // frames a sequential scan cycles through
+static constexpr int BULK_INSERT_RING_SIZE = 128;                             // frames a bulk insert cycles through
+static constexpr int DIRECT_IO_ALIGNMENT = 512;                               // buffer alignment O_DIRECT needs
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;                               // asynchronous page I/Os in flight
+static constexpr int EXTENT_SIZE = 64;                                        // pages a table or index takes at once
+static constexpr int EXTERNAL_SORT_MEMORY_PAGES = 64;                         // pages of pairs an external sort holds
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
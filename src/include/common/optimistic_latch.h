@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimistic_latch.h
+//
+// Identification: src/include/common/optimistic_latch.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>  // NOLINT
+
+#include "common/macros.h"
+#include "common/rwlatch.h"
+
+namespace bustub {
+
+/**
+ * Reader-writer latch with an optimistic read mode.
+ *
+ * Besides the usual shared and exclusive modes, which behave exactly like ReaderWriterLatch, the latch keeps a version
+ * counter that is odd while a writer holds the latch and bumped on both WLock and WUnlock. An optimistic reader takes
+ * the version with ReadVersion, reads the protected data without writing any shared memory, and then asks Validate
+ * whether a writer came in meanwhile; if so, whatever it read must be thrown away and the read retried, possibly in
+ * shared mode. Readers therefore never move the latch's cache line around, which matters for data that is read by
+ * every thread and rarely written, such as the upper levels of a B+tree.
+ *
+ * An optimistic read may see the data in the middle of a write, so it must not follow pointers or offsets it reads
+ * before they have been validated, or it must check them for sanity first.
+ */
+class OptimisticLatch {
+ public:
+  OptimisticLatch() = default;
+
+  DISALLOW_COPY(OptimisticLatch);
+
+  /**
+   * Acquire a write latch. Invalidates every optimistic read in progress.
+   */
+  void WLock() {
+    latch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    // Keeps the writes to the data from being seen before the version is odd.
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  /**
+   * Release a write latch.
+   */
+  void WUnlock() {
+    version_.fetch_add(1, std::memory_order_release);
+    latch_.WUnlock();
+  }
+
+  /**
+   * Acquire a read latch. Shared readers exclude writers, so they do not touch the version.
+   */
+  void RLock() { latch_.RLock(); }
+
+  /**
+   * Release a read latch.
+   */
+  void RUnlock() { latch_.RUnlock(); }
+
+  /**
+   * Starts an optimistic read, waiting for a writer that holds the latch to be done first.
+   * @return the version to hand to Validate at the end of the read
+   */
+  uint64_t ReadVersion() const {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while ((version & 1) != 0) {
+      std::this_thread::yield();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  /**
+   * Ends an optimistic read.
+   * @param version the version returned by ReadVersion when the read started
+   * @return true if no writer has acquired the latch since, i.e. everything read in between is consistent
+   */
+  bool Validate(uint64_t version) const {
+    // Keeps the reads of the data from moving below the version check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
+ private:
+  ReaderWriterLatch latch_;
+  std::atomic<uint64_t> version_{0};
+};
+
+}  // namespace bustub
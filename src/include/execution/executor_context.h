@@ -12,10 +12,12 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -60,12 +62,25 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /**
+   * Creates a buffer access strategy for one operation of the query, e.g. SEQ_SCAN_RING_SIZE frames for a sequential
+   * scan or BULK_INSERT_RING_SIZE frames for an insert of many tuples. The strategy lives as long as the context.
+   * @param ring_size the number of frames the operation may cycle through
+   * @return the new strategy
+   */
+  BufferAccessStrategy *MakeBufferAccessStrategy(size_t ring_size) {
+    strategies_.emplace_back(std::make_unique<BufferAccessStrategy>(ring_size));
+    return strategies_.back().get();
+  }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  /** The buffer access strategies of the operations of the query. */
+  std::vector<std::unique_ptr<BufferAccessStrategy>> strategies_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,196 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.h
+//
+// Identification: src/include/storage/disk/async_disk_io.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class DiskManager;
+
+/**
+ * A page read or write handed to DiskManager::SubmitRequests. A request may also cover a run of contiguous pages,
+ * which is read or written with a single vectored I/O.
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The page to read or write. */
+  page_id_t page_id_;
+  /** PAGE_SIZE bytes to write the page from or read it into; must stay valid until the callback has run. */
+  char *data_;
+  /**
+   * Called once the I/O is done, with false if it failed. It runs on an I/O thread, so it must be short and must not
+   * wait for other requests.
+   */
+  std::function<void(bool)> callback_;
+  /** Buffers of the pages that follow page_id_, one PAGE_SIZE buffer per page; empty for a single page. */
+  std::vector<char *> more_data_{};
+
+  /** @return the number of pages the request covers */
+  size_t NumPages() const { return 1 + more_data_.size(); }
+
+  /** @return the buffer of the i-th page of the request */
+  char *Data(size_t i) const { return i == 0 ? data_ : more_data_[i - 1]; }
+};
+
+/** The ways DiskManager can carry out asynchronous requests. */
+enum class AsyncIOBackendType { AUTO, IO_URING, THREAD_POOL };
+
+/**
+ * AsyncDiskIO carries out the asynchronous requests of a DiskManager. There are two backends: io_uring, which keeps
+ * up to ASYNC_IO_QUEUE_DEPTH requests in flight in the kernel and reaps their completions in batches on a single
+ * thread, and a pool of threads doing blocking I/O, for kernels without io_uring.
+ */
+class AsyncDiskIO {
+ public:
+  virtual ~AsyncDiskIO() = default;
+
+  /**
+   * Starts the given requests and returns without waiting for them. May block while the queue is full.
+   * @param requests the requests, moved out of the vector
+   */
+  virtual void Submit(std::vector<DiskRequest> *requests) = 0;
+
+  /** Blocks until every request submitted so far has completed and its callback has returned. */
+  virtual void Drain() = 0;
+
+  /** @return the name of the backend */
+  virtual const char *Name() const = 0;
+
+  /**
+   * Creates a backend.
+   * @param type IO_URING or THREAD_POOL; AUTO tries io_uring first and falls back to the thread pool
+   * @param disk_manager the disk manager the requests are for
+   * @param fd the database file descriptor
+   * @return the backend, or nullptr if io_uring was asked for and is not available
+   */
+  static std::unique_ptr<AsyncDiskIO> Create(AsyncIOBackendType type, DiskManager *disk_manager, int fd);
+};
+
+/**
+ * ThreadPoolDiskIO runs every request as a blocking ReadPage or WritePage on one of a few worker threads.
+ */
+class ThreadPoolDiskIO : public AsyncDiskIO {
+ public:
+  /**
+   * @param disk_manager the disk manager the requests are for
+   * @param num_threads the number of workers, i.e. of requests in flight at a time
+   */
+  ThreadPoolDiskIO(DiskManager *disk_manager, size_t num_threads);
+  ~ThreadPoolDiskIO() override;
+
+  void Submit(std::vector<DiskRequest> *requests) override;
+  void Drain() override;
+  const char *Name() const override { return "thread_pool"; }
+
+ private:
+  void RunWorker();
+
+  DiskManager *disk_manager_;
+  std::vector<std::thread> workers_;
+  std::mutex latch_;
+  /** Signalled when requests are queued or the pool is stopped. */
+  std::condition_variable queued_;
+  /** Signalled when the last request in flight has completed. */
+  std::condition_variable drained_;
+  std::deque<DiskRequest> queue_;
+  /** Requests queued or running, protected by latch_. */
+  size_t pending_{0};
+  bool stopped_{false};
+};
+
+/**
+ * IoUringDiskIO submits requests to an io_uring instance, set up with raw system calls so that liburing is not needed.
+ * Submitters fill submission queue entries under a latch; a completion thread waits for completions, reaps all that
+ * are available at once and runs their callbacks.
+ */
+class IoUringDiskIO : public AsyncDiskIO {
+ public:
+  /**
+   * Sets up the ring.
+   * @param disk_manager the disk manager the requests are for
+   * @param fd the database file descriptor
+   * @return the backend, or nullptr if io_uring, or one of the operations it is used for, is not available
+   */
+  static std::unique_ptr<IoUringDiskIO> Open(DiskManager *disk_manager, int fd);
+  ~IoUringDiskIO() override;
+
+  void Submit(std::vector<DiskRequest> *requests) override;
+  void Drain() override;
+  const char *Name() const override { return "io_uring"; }
+
+ private:
+  IoUringDiskIO(DiskManager *disk_manager, int fd) : disk_manager_(disk_manager), fd_(fd) {}
+
+  /** Maps the rings of ring_fd_; false if that fails. */
+  bool MapRings();
+
+  /** A request the kernel is working on, with the vector of a multi-page request. */
+  struct InFlight {
+    DiskRequest request_;
+    std::vector<iovec> iovecs_;
+  };
+
+  /** Queues one submission queue entry; the caller holds latch_ and has made room for it. */
+  void PushEntry(uint8_t opcode, const InFlight *in_flight);
+
+  /** Hands the queued entries to the kernel. */
+  void Enter(unsigned to_submit);
+
+  /** Body of the completion thread. */
+  void RunReaper();
+
+  /** Finishes a request whose I/O completed with the given result, then deletes it. */
+  void Complete(InFlight *in_flight, int result);
+
+  DiskManager *disk_manager_;
+  int fd_;
+  int ring_fd_{-1};
+
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  unsigned cq_entries_{0};
+
+  std::thread reaper_;
+  /** Serializes submitters, and protects in_flight_. */
+  std::mutex latch_;
+  /** Signalled whenever requests complete. */
+  std::condition_variable completed_;
+  /** Requests submitted and not completed yet, at most cq_entries_ so that the completion queue never overflows. */
+  unsigned in_flight_{0};
+};
+
+}  // namespace bustub
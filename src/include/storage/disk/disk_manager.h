@@ -15,25 +15,46 @@
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_disk_io.h"
+#include "storage/disk/free_space_map.h"
 
 namespace bustub {
 
+class ExtentAllocator;
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on a file descriptor, so ReadPage and WritePage may be called from
+ * several threads at once without any latch. With direct I/O the database file bypasses the OS page cache, which
+ * would otherwise hold a second copy of the pages the buffer pool already caches.
+ *
+ * Pages may also be read and written asynchronously, see SubmitRequests, so that a caller can keep many I/Os in flight.
+ *
+ * Which page ids are in use is tracked by a FreeSpaceMap kept in "<db>.fsm", so that deallocated pages are reused and
+ * a database that is opened again continues where it left off.
+ *
+ * Subclasses may keep the pages and the log somewhere else by overriding the page I/O, see DiskManagerMemory.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to open the database file with O_DIRECT; ignored if the file system does not support it
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
-  ~DiskManager() = default;
+  /** Closes the files if ShutDown has not done so already. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
@@ -54,12 +75,51 @@ class DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Makes the pages written so far durable, with a single fdatasync of the database file for all of them.
+   * @return false if the sync failed
+   */
+  virtual bool SyncPages();
+
+  /**
+   * Starts reading or writing the given pages and returns without waiting for them. Each request's callback runs on an
+   * I/O thread once it is done. The backend, io_uring where the kernel has it and a thread pool otherwise, is set up
+   * by the first call.
+   * @param requests the requests, in the order they should preferably be issued
+   */
+  void SubmitRequests(std::vector<DiskRequest> requests);
+
+  /**
+   * Starts reading a page, see SubmitRequests.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must stay valid until the future is ready
+   * @return a future that becomes true once the page has been read, false if the read failed
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Starts writing a page, see SubmitRequests.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay valid and unchanged until the future is ready
+   * @return a future that becomes true once the page has been written, false if the write failed
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Chooses the backend of the asynchronous requests. Only has an effect before the first request.
+   * @param type the backend; AUTO, the default, prefers io_uring
+   */
+  void SetAsyncIOBackend(AsyncIOBackendType type);
+
+  /** @return the name of the backend that carries out asynchronous requests, setting it up if needed */
+  const char *GetAsyncIOBackendName();
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -68,20 +128,60 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  virtual bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk, reusing the lowest deallocated page id if there is one.
    * @return the id of the allocated page
    */
   page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Allocate contiguous pages on disk.
+   * @param num_pages the number of pages, at most FreeSpaceMap::MAX_EXTENT_SIZE
+   * @return the id of the first page
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Deallocate a page on disk, so that its id may be handed out again.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Deallocate contiguous pages on disk.
+   * @param first_page_id id of the first page
+   * @param num_pages the number of pages
+   */
+  void DeallocateExtent(page_id_t first_page_id, size_t num_pages);
+
+  /** @return true if the page is allocated */
+  bool IsPageAllocated(page_id_t page_id) const;
+
+  /**
+   * Registers an extent allocator that takes extents from this disk manager, so that the rest of its current extent
+   * is given back on shut down if the allocator is still around.
+   * @param allocator the allocator
+   */
+  void RegisterExtentAllocator(ExtentAllocator *allocator);
+
+  /**
+   * Unregisters an extent allocator and gives the rest of its current extent back. Does nothing if the allocator is
+   * not registered, e.g. because the disk manager has shut down since.
+   * @param allocator the allocator
+   */
+  void UnregisterExtentAllocator(ExtentAllocator *allocator);
+
+  /** @return the high-water mark of the allocated pages; every allocated page id is below it */
+  page_id_t GetNumPages() const;
+
+  /** Writes the free space map back to its file; ShutDown does so too. */
+  void SyncFreeSpaceMap();
+
+  /** @return true if the database file is accessed with direct I/O */
+  bool IsDirectIO() const { return direct_io_; }
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -91,6 +191,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of SyncPages calls */
+  int GetNumSyncs() const { return num_syncs_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -100,19 +203,59 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without any files, for subclasses that keep the pages elsewhere. Page ids are tracked by a
+   * free space map kept in memory, and asynchronous requests run on the thread pool backend.
+   */
+  DiskManager();
+
+  /** ReadPage without the bookkeeping. @return false on an I/O error */
+  virtual bool ReadPageData(page_id_t page_id, char *page_data);
+
+  /** WritePage without the bookkeeping. @return false on an I/O error */
+  virtual bool WritePageData(page_id_t page_id, const char *page_data);
+
+  /** Carries out a request synchronously, a run of pages with one vectored I/O. @return false on an I/O error */
+  virtual bool ExecuteRequest(const DiskRequest &request);
+
+  int num_flushes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_syncs_{0};
+  bool flush_log_;
+  std::future<void> *flush_log_f_;
+
  private:
+  friend class ThreadPoolDiskIO;
+  friend class IoUringDiskIO;
+
+  /** @return the backend of the asynchronous requests, set up on first use */
+  AsyncDiskIO *GetAsyncIO();
+
+  /** @return true if every buffer of the request is aligned for direct I/O */
+  static bool IsAligned(const DiskRequest &request);
+
   int GetFileSize(const std::string &file_name);
+
+  /** Gives the rest of the current extent of every registered allocator back, and unregisters them all. */
+  void ReleaseExtents();
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // descriptor of the db file, only used with pread and pwrite so that it has no cursor to share
+  int db_fd_{-1};
+  bool direct_io_{false};
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
+  // which page ids are in use, persisted next to the db file
+  std::unique_ptr<FreeSpaceMap> free_space_map_;
+  // extent allocators holding pages they have not handed out yet; always latched before any of them
+  std::mutex extent_allocators_latch_;
+  std::unordered_set<ExtentAllocator *> extent_allocators_;
+  // backend of the asynchronous requests, set up by the first one
+  std::unique_ptr<AsyncDiskIO> async_io_;
+  AsyncIOBackendType async_io_type_{AsyncIOBackendType::AUTO};
+  std::mutex async_io_latch_;
 };
 
 }  // namespace bustub
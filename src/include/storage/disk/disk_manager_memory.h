@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.h
+//
+// Identification: src/include/storage/disk/disk_manager_memory.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <vector>
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * The timing of a storage device, as DiskManagerMemory simulates it. Each I/O occupies the device for its seek, if it
+ * does not start where the previous one ended, and for the transfer of its bytes at the given bandwidth; I/Os queue
+ * up for the device, as they would for a disk head or a saturated link. The access latency comes on top, and
+ * overlaps between concurrent I/Os, as on a device with internal parallelism.
+ */
+struct DiskLatencyProfile {
+  /** Time until a read is done, besides seek and transfer. */
+  std::chrono::nanoseconds read_latency_{0};
+  /** Time until a write is done, besides seek and transfer. */
+  std::chrono::nanoseconds write_latency_{0};
+  /** Time the device is busy before an I/O that does not continue the previous one. */
+  std::chrono::nanoseconds seek_latency_{0};
+  /** Transfer rate in bytes per second; 0 for no limit. */
+  uint64_t bandwidth_{0};
+
+  /** @return no latency at all: the pages are copied as fast as memory allows */
+  static DiskLatencyProfile None() { return {}; }
+
+  /** @return a 7200 rpm hard disk: a seek and half a rotation for random access, 150 MB/s sequentially */
+  static DiskLatencyProfile Hdd() {
+    return {std::chrono::microseconds(100), std::chrono::microseconds(100), std::chrono::microseconds(8000),
+            150'000'000};
+  }
+
+  /** @return a SATA SSD: tens of microseconds per access, capped at the 550 MB/s of the interface */
+  static DiskLatencyProfile SataSsd() {
+    return {std::chrono::microseconds(80), std::chrono::microseconds(40), std::chrono::microseconds(0), 550'000'000};
+  }
+
+  /** @return an NVMe SSD: about ten microseconds per access, 3 GB/s */
+  static DiskLatencyProfile Nvme() {
+    return {std::chrono::microseconds(12), std::chrono::microseconds(10), std::chrono::microseconds(0),
+            3'000'000'000};
+  }
+};
+
+/**
+ * DiskManagerMemory keeps the pages and the log in memory instead of files, optionally with the timing of a storage
+ * device, so that benchmarks of the buffer pool, indexes and executors measure the code rather than the file system
+ * and the OS page cache, and give the same numbers on every machine. It can stand in for DiskManager anywhere; the
+ * buffer pool, B+ tree and table heap tests and benchmarks run against it when BUSTUB_TEST_DISK_MANAGER=memory is set.
+ *
+ * Pages live in a sparse array; a page that was never written reads as zeros, as it does past the end of a file. The
+ * simulated latency is slept away, so it is only accurate to the granularity of the OS timer, i.e. tens of
+ * microseconds.
+ */
+class DiskManagerMemory : public DiskManager {
+ public:
+  /** @param profile the timing of the simulated device */
+  explicit DiskManagerMemory(DiskLatencyProfile profile = DiskLatencyProfile::None());
+
+  ~DiskManagerMemory() override;
+
+  /**
+   * Changes the timing of the simulated device, e.g. to build a database quickly before measuring against it.
+   * @param profile the new timing
+   */
+  void SetLatencyProfile(const DiskLatencyProfile &profile);
+
+  void WriteLog(char *log_data, int size) override;
+
+  bool ReadLog(char *log_data, int size, int offset) override;
+
+  /** @return the bytes of page data held in memory */
+  size_t GetMemoryUsage();
+
+ protected:
+  bool ReadPageData(page_id_t page_id, char *page_data) override;
+
+  bool WritePageData(page_id_t page_id, const char *page_data) override;
+
+  bool ExecuteRequest(const DiskRequest &request) override;
+
+ private:
+  /** Log records start at this byte offset of the simulated device, far away from the pages. */
+  static constexpr uint64_t LOG_OFFSET = static_cast<uint64_t>(1) << 48;
+
+  /** Blocks for as long as the simulated device takes to transfer size bytes at the given offset. */
+  void SimulateIO(bool is_write, uint64_t offset, size_t size);
+
+  void CopyOut(page_id_t page_id, char *page_data);
+
+  void CopyIn(page_id_t page_id, const char *page_data);
+
+  /** Protects the array of pages; held shared to copy a page, exclusively to add one. */
+  std::shared_mutex pages_latch_;
+  std::vector<std::unique_ptr<char[]>> pages_;
+  size_t num_stored_pages_{0};
+
+  std::mutex log_latch_;
+  std::vector<char> log_;
+
+  /** Protects the state of the simulated device. */
+  std::mutex device_latch_;
+  DiskLatencyProfile profile_;
+  /** The device is busy with earlier I/Os until then. */
+  std::chrono::steady_clock::time_point busy_until_;
+  /** Where the previous I/O ended. */
+  uint64_t head_offset_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/storage/disk/extent_allocator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+
+namespace bustub {
+
+class DiskManager;
+
+/**
+ * ExtentAllocator hands out the new pages of one table or index. It takes EXTENT_SIZE contiguous pages from the disk
+ * manager at a time and gives them out in order, so that the pages of the object lie next to each other on disk and
+ * a scan of it reads and writes runs of pages rather than pages scattered among those of every other object.
+ *
+ * The allocator registers with the disk manager it takes extents from. The pages of the current extent that have not
+ * been handed out go back to the disk manager when the allocator goes away, or when the disk manager shuts down first,
+ * whichever comes first. After a crash they stay in use, like the pages a crash keeps FreeSpaceMap from freeing.
+ */
+class ExtentAllocator {
+ public:
+  /** @param extent_size pages per extent, at most FreeSpaceMap::MAX_EXTENT_SIZE */
+  explicit ExtentAllocator(size_t extent_size = EXTENT_SIZE) : extent_size_(extent_size) {}
+
+  /** Gives the rest of the current extent back to the disk manager, if it is still around. */
+  ~ExtentAllocator();
+
+  /**
+   * @param disk_manager the disk manager to take a new extent from when the current one is used up
+   * @return the id of the next page of the current extent
+   */
+  page_id_t AllocatePage(DiskManager *disk_manager);
+
+  /**
+   * Takes back a page that AllocatePage handed out and that could not be used, so that the next call returns it
+   * again. If other pages were handed out meanwhile, the page goes back to the disk manager instead.
+   * @param disk_manager the disk manager the page came from
+   * @param page_id the page
+   */
+  void ReturnPage(DiskManager *disk_manager, page_id_t page_id);
+
+  /**
+   * Gives the rest of the current extent back to the disk manager and forgets about it. Called by the disk manager
+   * with its list of allocators latched, when the allocator unregisters or when the disk manager shuts down.
+   */
+  void ReleaseExtent();
+
+ private:
+  friend class DiskManager;
+
+  std::mutex latch_;
+  size_t extent_size_;
+  /** The disk manager this allocator is registered with, if any. Changed with its list of allocators latched. */
+  std::atomic<DiskManager *> disk_manager_{nullptr};
+  /** The next page to hand out, and the end of the current extent. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
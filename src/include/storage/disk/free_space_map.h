@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps track of which page ids of a database file are in use, with one bit per page id. It is kept in
+ * memory and persisted in a file of its own next to the database file, "<db>.fsm", whose page k holds the bits of
+ * page ids [k * BITS_PER_MAP_PAGE, (k + 1) * BITS_PER_MAP_PAGE). Keeping it apart from the database file leaves every
+ * page id of the database file to the pages themselves.
+ *
+ * Page ids are handed out from the lowest free id, so deleted pages are reused before the file grows. Allocation takes
+ * no latch: while nothing is free, it bumps a high-water mark; otherwise it first takes one of the free pages from a
+ * counter, which guarantees that there is a free bit to find, then claims the bit with a compare-and-swap. Extents of
+ * up to 64 contiguous pages are taken from within a single word of the bitmap the same way.
+ *
+ * The map is written back by Sync, i.e. on DiskManager::ShutDown, and by SyncIfReused before a page is written to the
+ * database file if a free id was reused since the last sync. After a crash, pages the database file holds beyond the
+ * last synced high-water mark are taken to be in use, and so is every reused page that reached the file; only ids
+ * freed since the last sync are lost, and stay in use.
+ */
+class FreeSpaceMap {
+ public:
+  /** Number of page ids whose bits fit on one page of the map file. */
+  static constexpr size_t BITS_PER_MAP_PAGE = PAGE_SIZE * 8;
+  /** Largest extent AllocateExtent hands out. */
+  static constexpr size_t MAX_EXTENT_SIZE = 64;
+
+  /**
+   * Opens the map of a database file, or creates it.
+   * @param file_name the name of the map file; if it is empty the map is kept in memory only
+   * @param db_num_pages the number of pages the database file holds; if it is empty the map starts empty, and if the
+   * map file is missing every page of the database file is taken to be in use
+   */
+  FreeSpaceMap(const std::string &file_name, page_id_t db_num_pages);
+
+  /** Syncs the map and closes its file. */
+  ~FreeSpaceMap();
+
+  /** @return the lowest free page id, now marked in use */
+  page_id_t Allocate() { return AllocateExtent(1); }
+
+  /**
+   * Allocates contiguous page ids.
+   * @param num_pages the number of pages, between 1 and MAX_EXTENT_SIZE
+   * @return the first of the page ids
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Marks a page id free. Does nothing if it is not in use.
+   * @param page_id the page id
+   */
+  void Deallocate(page_id_t page_id);
+
+  /** @return true if the page id is in use */
+  bool IsAllocated(page_id_t page_id) const;
+
+  /** @return the high-water mark: every page id in use is below it */
+  page_id_t GetNumPages() const { return next_page_id_.load(); }
+
+  /** @return the number of free page ids below the high-water mark */
+  size_t GetNumFreePages() const { return free_pages_.load(); }
+
+  /** Writes the pages of the map that changed since the last sync to the map file. */
+  void Sync();
+
+  /**
+   * Syncs the map if a free page id was reused since the last sync, so that the reused page is in use on disk before
+   * its data is. Called before pages are written to the database file.
+   */
+  void SyncIfReused();
+
+ private:
+  static constexpr size_t BITS_PER_WORD = 64;
+  static constexpr size_t WORDS_PER_MAP_PAGE = BITS_PER_MAP_PAGE / BITS_PER_WORD;
+  /** Map pages per chunk; chunks are allocated as the high-water mark grows and never move. */
+  static constexpr size_t MAP_PAGES_PER_CHUNK = 8;
+  static constexpr size_t WORDS_PER_CHUNK = WORDS_PER_MAP_PAGE * MAP_PAGES_PER_CHUNK;
+  /** Enough chunks for every non-negative page id. */
+  static constexpr size_t MAX_CHUNKS = (static_cast<size_t>(1) << 31) / (WORDS_PER_CHUNK * BITS_PER_WORD);
+
+  struct Chunk {
+    std::atomic<uint64_t> words_[WORDS_PER_CHUNK]{};
+    std::atomic<bool> dirty_[MAP_PAGES_PER_CHUNK]{};
+  };
+
+  /** @return the word that holds the bit of the given word index, allocating its chunk if needed */
+  std::atomic<uint64_t> &Word(size_t word_index);
+
+  /** @return the word at word_index, or nullptr if its chunk was never allocated */
+  const std::atomic<uint64_t> *FindWord(size_t word_index) const;
+
+  void MarkDirty(size_t word_index);
+
+  /**
+   * Sets the bits of [first, first + num_pages), which were just taken from above the high-water mark.
+   * @return false, with none of the bits set, if a scan claimed one of them first
+   */
+  bool SetBits(page_id_t first, size_t num_pages);
+
+  /**
+   * Looks for num_pages contiguous free bits within one word below the high-water mark and claims them. The caller
+   * has taken num_pages from free_pages_.
+   * @return the first page id, or INVALID_PAGE_ID if the free pages are too fragmented
+   */
+  page_id_t ClaimFreeBits(size_t num_pages);
+
+  /** Sync with sync_latch_ held. */
+  void SyncLocked();
+
+  int fd_{-1};
+  /** Serializes syncs, so that an older copy of a map page is never written over a newer one. */
+  std::mutex sync_latch_;
+  /** Counts the reuses of free page ids. */
+  std::atomic<uint64_t> reuses_{0};
+  /** The value of reuses_ when the last sync started; every reuse up to it is on disk. */
+  std::atomic<uint64_t> synced_reuses_{0};
+  std::unique_ptr<std::atomic<Chunk *>[]> chunks_;
+  /** Every page id in use is below it. */
+  std::atomic<page_id_t> next_page_id_{0};
+  /** Free page ids below next_page_id_ that no allocation has reserved yet. */
+  std::atomic<size_t> free_pages_{0};
+  /** The word scans for free bits start at; free bits below it are rare, but the scan wraps around for them. */
+  std::atomic<size_t> search_hint_{0};
+};
+
+}  // namespace bustub
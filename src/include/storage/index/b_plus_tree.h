@@ -10,10 +10,13 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <functional>
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -23,6 +26,9 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/** How a B+ tree synchronizes concurrent operations, see the class comment. */
+enum class BPlusTreeLatching { CRABBING, B_LINK };
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
@@ -32,6 +38,29 @@ namespace bustub {
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency: readers descend with read latches, latching each child before they let go of its parent. A writer
+ * first makes the same descent, but write-latches the leaf; if the leaf can take the change without splitting or
+ * underflowing, it is the only page the writer changes. Otherwise the writer starts over and write-latches its whole
+ * path, letting go of everything above a page that is safe, i.e. that the change cannot propagate past. The pages it
+ * holds are kept in the page set of the transaction, where the writer also finds the parent of a page it splits or
+ * merges, and the pages it frees go into the deleted page set until its latches are released. root_latch_ protects
+ * root_page_id_ and stands in for the parent of the root in this protocol.
+ *
+ * B-link mode (Lehman and Yao) instead holds one latch at a time. Every page links to its right sibling and keeps a
+ * high key, the smallest key that belongs past it, so a reader that lands on a page after a concurrent split sees the
+ * key is past the high key and moves right rather than waiting for the split to reach the parent. A writer
+ * write-latches only the leaf, and a split completes one level at a time: the new page is linked in first, then the
+ * separator goes into the parent found through the path of the descent, after the latch on the child is released.
+ * Pages are never merged or freed in this mode, so a leaf may be left empty and IsEmpty only reports a tree that never
+ * had a key; this suits the insert-heavy indexes it is meant for, e.g. time series appending to the right most leaf.
+ *
+ * Compression: pages leave out the bytes that all of their keys have in common (see BPlusTreeKeyArray), and the
+ * separator that goes up from a leaf split is truncated to as few significant bytes as tell the two leaves apart (see
+ * GenericComparator::Separator), so that separators have all the more in common. How many entries a page holds then
+ * depends on its keys as well as its max size: a page splits before an insert whose key would widen its slots past
+ * what fits, and pages merge or redistribute only if the keys fit where they would go, which may leave a page below
+ * its min size. KeyComparator must provide Separator.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,7 +69,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     BPlusTreeLatching latching = BPlusTreeLatching::CRABBING);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -54,6 +84,33 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Builds this tree, which must be empty, bottom-up from key & value pairs in ascending key order: leaves are packed
+   * one after the other, then each level of internal pages is built over the one below, and the root is set last.
+   * This takes one pass over the input and leaves no page half empty, unlike inserting the pairs one by one.
+   * @param next puts the next pair into its arguments, or returns false at the end of the input
+   * @param fill_factor the fraction of each page to fill, which is raised to the min size of a page if it is lower
+   * @return the number of pairs loaded; a pair whose key is the same as the one before is skipped, as Insert would
+   * reject it. Throws if the tree is not empty or a key is smaller than the one before.
+   */
+  size_t BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor = 1.0);
+
+  /** BulkLoad from a range of key & value pairs in ascending key order. */
+  template <typename InputIterator>
+  size_t BulkLoad(InputIterator first, InputIterator last, double fill_factor = 1.0) {
+    return BulkLoad(
+        [&first, &last](KeyType *key, ValueType *value) {
+          if (first == last) {
+            return false;
+          }
+          *key = first->first;
+          *value = first->second;
+          ++first;
+          return true;
+        },
+        fill_factor);
+  }
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
@@ -80,27 +137,145 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  /** The changes a writer descends the tree for, which decide when a page is safe. */
+  enum class Operation { INSERT, REMOVE };
+
+  /** @return the page, pinned; throws if the buffer pool has no frame for it */
+  Page *FetchTreePage(page_id_t page_id);
+
+  /** @return a guard on a new page of this index; throws if the buffer pool has no frame for it */
+  BasicPageGuard NewTreePage(page_id_t *page_id);
+
+  /**
+   * Descends to a leaf with read latches.
+   * @param key the key to find the leaf of
+   * @param left_most find the left most leaf instead
+   * @return the leaf, read-latched, or an empty guard if the tree is empty
+   */
+  ReadPageGuard FindLeafRead(const KeyType &key, bool left_most, std::vector<page_id_t> *path = nullptr);
+
+  /** @return the right sibling of the page if the key is past its high key, otherwise INVALID_PAGE_ID */
+  page_id_t RightOf(const BPlusTreePage *node, const KeyType &key) const;
+
+  /** In B-link mode, moves a guard right past the pages split off after it was found, until it holds the key. */
+  template <typename Guard>
+  void MoveRight(Guard *guard, const KeyType &key);
+
+  /**
+   * Descends from a page to the page at a lower level that holds a key, one latch at a time.
+   * @param page_id the page to start from
+   * @param level the level of that page, where leaves are level 0
+   * @param target_level the level to stop at
+   * @return the page at the target level, which may have moved right by the time it is latched
+   */
+  page_id_t FindPageAtLevel(page_id_t page_id, int level, int target_level, const KeyType &key);
+
+  /**
+   * The optimistic descent of a writer: read latches down to the leaf, which is write-latched instead.
+   * @param key the key to find the leaf of
+   * @param[out] is_root whether the leaf is the root
+   * @return the leaf, pinned and write-latched, or nullptr if the tree is empty
+   */
+  Page *FindLeafOptimistic(const KeyType &key, bool *is_root);
+
+  /**
+   * The pessimistic descent of a writer, which must hold the root latch and have recorded it in the page set.
+   * Write-latches the path to the leaf into the page set, releasing what is above each page that is safe.
+   * @return the leaf, which is the last page of the page set
+   */
+  Page *FindLeafPessimistic(const KeyType &key, Operation op, Transaction *transaction);
+
+  /** @return true if the operation on key cannot make the page split or underflow */
+  bool IsSafe(const BPlusTreePage *node, Operation op, bool is_root, const KeyType &key) const;
+
+  /**
+   * Finds the parent of a page in the page set.
+   * @param[out] parent the parent, or nullptr if the page is the root and the root latch is held in its place
+   * @return false if the ancestors of the page were released, which happens only if the page is safe
+   */
+  bool FindParentPage(page_id_t page_id, Transaction *transaction, Page **parent) const;
+
+  /** Unlatches and unpins the pages of the page set, and releases the root latch if it is held. */
+  void ReleasePageSet(Transaction *transaction, bool is_dirty);
+
+  /**
+   * Unlatches and unpins the pages that come after a page in the page set, i.e. the ones below it that a change has
+   * moved on from.
+   */
+  void ReleasePagesBelow(page_id_t page_id, Transaction *transaction);
+
+  /** Deletes the pages of the deleted page set, once the page set is released. */
+  void DeletePages(Transaction *transaction);
+
+  /** The insert of B-link mode. */
+  bool InsertBLink(const KeyType &key, const ValueType &value);
+
+  /**
+   * Posts a split to the level above in B-link mode, then any split that causes in turn.
+   * @param left_id the page that was split, no longer latched
+   * @param key the separator
+   * @param right_id the page split off it
+   * @param level the level of the split pages
+   * @param path the internal pages of the descent, root first; the ones used are popped
+   */
+  void InsertIntoParentBLink(page_id_t left_id, KeyType key, page_id_t right_id, int level,
+                             std::vector<page_id_t> *path);
+
+  /** The remove of B-link mode, which leaves underfull leaves in place. */
+  void RemoveBLink(const KeyType &key);
+
+  /**
+   * Packs the leaves of BulkLoad.
+   * @param[out] leaves the separator before and the page id of every leaf, in order; the first leaf has its first key
+   * @param[out] pages every page created, for cleaning up if the load fails
+   * @return the number of pairs loaded
+   */
+  size_t BulkLoadLeaves(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor,
+                        std::vector<std::pair<KeyType, page_id_t>> *leaves, std::vector<page_id_t> *pages);
+
+  /**
+   * Builds a level of internal pages for BulkLoad, filled up to the fill factor like the leaves.
+   * @param children the separator before and the page id of every page of the level below, in order
+   * @param[out] pages every page created
+   * @return the separator before and the page id of every page of the new level
+   */
+  std::vector<std::pair<KeyType, page_id_t>> BulkLoadLevel(const std::vector<std::pair<KeyType, page_id_t>> &children,
+                                                           double fill_factor, std::vector<page_id_t> *pages);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                        Transaction *transaction = nullptr);
+                        Transaction *transaction);
 
+  /**
+   * Splits a page, see the definition.
+   * @param[out] separator the key that goes into the parent
+   */
   template <typename N>
-  N *Split(N *node);
+  BasicPageGuard Split(N *node, KeyType *separator);
+
+  /**
+   * Inserts a pair into a page that splits if it has to, see the definition.
+   * @param[out] separator the key that goes into the parent if the page split
+   * @return a guard on the page split off, or an empty guard
+   */
+  template <typename N, typename V>
+  BasicPageGuard InsertOrSplit(N *node, const KeyType &key, const V &value, KeyType *separator);
+
+  void RemoveFromLeaf(const KeyType &key, Transaction *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, Transaction *transaction);
 
   template <typename N>
-  bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+  bool Coalesce(N **neighbor_node, N **node, InternalPage **parent, int index, Transaction *transaction);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index);
 
-  bool AdjustRoot(BPlusTreePage *node);
+  bool AdjustRoot(BPlusTreePage *old_root_node);
 
   void UpdateRootPageId(int insert_record = 0);
 
@@ -111,11 +286,18 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
+  // protects root_page_id_, see the class comment
+  mutable ReaderWriterLatch root_latch_;
   page_id_t root_page_id_;
+  // the number of levels, 0 for an empty tree; protected by root_latch_ like root_page_id_
+  int height_{0};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  BPlusTreeLatching latching_;
+  // hands out the new pages of this index
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
@@ -17,6 +17,7 @@
 
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
+#include "storage/table/table_heap.h"
 
 namespace bustub {
 
@@ -33,6 +34,18 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Fills this index, which must be empty, with an entry for every tuple of a table, as CREATE INDEX on an existing
+   * table does. The entries are sorted with an external merge sort through the buffer pool and bulk loaded, instead
+   * of being inserted one by one.
+   * @param table the table to index
+   * @param schema the schema of the tuples of the table
+   * @param transaction the transaction that scans the table
+   * @param fill_factor the fraction of each page of the index to fill
+   * @return the number of entries, which is less than the number of tuples if keys repeat
+   */
+  size_t BuildFromTable(TableHeap *table, const Schema &schema, Transaction *transaction, double fill_factor = 1.0);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
@@ -40,6 +53,7 @@ class BPlusTreeIndex : public Index {
   INDEXITERATOR_TYPE GetEndIterator();
 
  protected:
+  BufferPoolManager *buffer_pool_manager_;
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_merge_sort.h
+//
+// Identification: src/include/storage/index/external_merge_sort.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_MERGE_SORT_TYPE ExternalMergeSort<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalMergeSort sorts more key & value pairs than fit in memory, for building an index bottom-up. The pairs that
+ * are added are buffered until memory_pages pages' worth have come in; then they are sorted and written out as a run,
+ * a chain of temporary pages of the buffer pool. When the input ends, the runs are merged, memory_pages - 1 at a
+ * time, until few enough are left to merge while the output is read. Input that fits in memory is never written out.
+ *
+ * Pages of a run are deleted as soon as they have been read, and whatever is left when the sort goes away.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalMergeSort {
+ public:
+  /**
+   * @param buffer_pool_manager the buffer pool the runs are written to, which must have more than memory_pages frames
+   * that can be pinned
+   * @param comparator the order of the output
+   * @param memory_pages the pages' worth of pairs to sort in memory, and the number of pages a merge reads at once
+   */
+  ExternalMergeSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                    size_t memory_pages = EXTERNAL_SORT_MEMORY_PAGES);
+
+  ~ExternalMergeSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalMergeSort);
+
+  /** Adds a pair to sort. Must not be called after Finish. */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** Ends the input, after which Next returns the pairs in order. */
+  void Finish();
+
+  /**
+   * @param[out] key the next key in order
+   * @param[out] value its value
+   * @return false if every pair has been returned
+   */
+  bool Next(KeyType *key, ValueType *value);
+
+  /** @return the number of runs written out so far, merged ones included */
+  size_t GetNumRunsWritten() const { return num_runs_written_; }
+
+ private:
+  /** A page of a run: the pairs it holds, in order, and the page the run goes on with. */
+  struct RunPage {
+    page_id_t next_page_id_;
+    int size_;
+    MappingType array_[0];
+  };
+  static constexpr size_t RUN_PAGE_SIZE = (PAGE_SIZE - sizeof(RunPage)) / sizeof(MappingType);
+
+  /** Reads a run from the start, deleting its pages behind it. */
+  struct RunReader {
+    ReadPageGuard guard_;
+    int index_{0};
+  };
+
+  /** Runs being merged. */
+  struct Merge {
+    std::vector<RunReader> readers_;
+    /** A heap of the readers that are not done, the one with the smallest current key on top. */
+    std::vector<size_t> heap_;
+  };
+
+  /** Appends to a new run, page by page. */
+  struct RunWriter {
+    page_id_t first_page_id_{INVALID_PAGE_ID};
+    BasicPageGuard guard_;
+  };
+
+  /** Sorts the buffered pairs and writes them out as a run. */
+  void WriteRun();
+
+  /** Merges the first num_runs runs into one, which goes to the back of the runs. */
+  void MergeRuns(size_t num_runs);
+
+  /** Starts merge_ on the first num_runs runs, which are taken off the runs. */
+  void OpenMerge(size_t num_runs);
+
+  /** @return true if reader a of merge_ is at a larger key than reader b, which orders the heap */
+  bool IsAfter(size_t a, size_t b) const;
+
+  /**
+   * @param[out] pair the smallest pair that merge_ has not returned yet
+   * @return false if merge_ is done
+   */
+  bool NextFromMerge(MappingType *pair);
+
+  /**
+   * Moves a reader to its next pair, going on to the next page of its run if it has to.
+   * @return false if the run is done
+   */
+  bool Advance(RunReader *reader);
+
+  void Append(RunWriter *writer, const MappingType &pair);
+
+  /** Deletes the pages of a run from a page on. */
+  void DeleteRun(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t memory_pages_;
+  /** Keeps the pages of the runs, which are read and written once, from pushing everything else out of the pool. */
+  BufferAccessStrategy strategy_;
+  /** The pairs not written out yet; after Finish, the output if no run was written. */
+  std::vector<MappingType> buffer_;
+  size_t buffer_index_{0};
+  /** The first pages of the runs that have not been merged. */
+  std::deque<page_id_t> runs_;
+  /** The merge in progress; after Finish, the final merge, which Next reads. */
+  Merge merge_;
+  size_t num_runs_written_{0};
+  bool finished_{false};
+};
+
+}  // namespace bustub
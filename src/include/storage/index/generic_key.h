@@ -13,7 +13,10 @@
 #pragma once
 
 #include <cstring>
+#include <type_traits>
 
+#include "common/exception.h"
+#include "common/macros.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -35,6 +38,81 @@ class GenericKey {
     memcpy(data_, tuple.GetData(), tuple.GetLength());
   }
 
+  /**
+   * Sets the key to the normalized encoding of the key tuple, in which keys compare as their bytes do (see
+   * MemcmpComparator), instead of a copy of the tuple. Every column starts with a byte that is 0 for a null, which
+   * sorts first, and 1 otherwise, followed by the value:
+   * - integers in big endian, with the sign bit flipped
+   * - decimals as the bits of the double, all of them flipped if it is negative, or else only the sign bit
+   * - varchars as their bytes, with every 0 escaped as 0 0xff, followed by 0 0
+   * The rest of the key is zeroed. A normalized key cannot be read back with ToValue.
+   * @throws Exception if the encoding does not fit into KeySize bytes
+   */
+  inline void SetFromKey(const Tuple &tuple, Schema *key_schema) {
+    memset(data_, 0, KeySize);
+    size_t size = 0;
+    auto put = [this, &size](uint8_t byte) {
+      if (size == KeySize) {
+        throw Exception(ExceptionType::OUT_OF_RANGE, "the normalized key does not fit into the index key");
+      }
+      data_[size++] = static_cast<char>(byte);
+    };
+    auto put_big_endian = [&put](uint64_t bits, size_t length) {
+      for (size_t i = length; i > 0; i--) {
+        put(static_cast<uint8_t>(bits >> (8 * (i - 1))));
+      }
+    };
+
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      Value value = tuple.GetValue(key_schema, i);
+      if (value.IsNull()) {
+        put(0);
+        continue;
+      }
+      put(1);
+      switch (value.GetTypeId()) {
+        case TypeId::BOOLEAN:
+          put(value.GetAs<int8_t>());
+          break;
+        case TypeId::TINYINT:
+          put_big_endian(static_cast<uint64_t>(value.GetAs<int8_t>()) ^ 0x80, 1);
+          break;
+        case TypeId::SMALLINT:
+          put_big_endian(static_cast<uint64_t>(value.GetAs<int16_t>()) ^ 0x8000, 2);
+          break;
+        case TypeId::INTEGER:
+          put_big_endian(static_cast<uint64_t>(value.GetAs<int32_t>()) ^ 0x80000000, 4);
+          break;
+        case TypeId::BIGINT:
+          put_big_endian(static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (uint64_t{1} << 63), 8);
+          break;
+        case TypeId::DECIMAL: {
+          // -0.0 equals 0.0, and is encoded as it.
+          double decimal = value.GetAs<double>() == 0 ? 0 : value.GetAs<double>();
+          uint64_t bits;
+          memcpy(&bits, &decimal, sizeof(bits));
+          put_big_endian((bits >> 63) != 0 ? ~bits : bits ^ (uint64_t{1} << 63), 8);
+          break;
+        }
+        case TypeId::VARCHAR: {
+          // The length counts the terminating 0, which is left out.
+          const char *data = value.GetData();
+          for (uint32_t j = 0; j + 1 < value.GetLength(); j++) {
+            put(data[j]);
+            if (data[j] == 0) {
+              put(0xff);
+            }
+          }
+          put(0);
+          put(0);
+          break;
+        }
+        default:
+          UNREACHABLE("cannot normalize a key of this type");
+      }
+    }
+  }
+
   // NOTE: for test purpose only
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
@@ -94,6 +172,36 @@ class GenericComparator {
     return 0;
   }
 
+  /**
+   * Suffix truncation for the separators of a B+ tree: the columns after the first one in which the keys differ do not
+   * tell them apart, and are zeroed, so that separators have as many bytes in common as they can. Columns that are
+   * not inlined hold the offset of their data and cannot be zeroed.
+   * @return a key that sorts after lhs and no later than rhs, which must sort after lhs
+   */
+  inline GenericKey<KeySize> Separator(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    uint32_t column_count = key_schema_->GetColumnCount();
+    uint32_t first_difference = 0;
+    while (first_difference < column_count &&
+           lhs.ToValue(key_schema_, first_difference)
+                   .CompareEquals(rhs.ToValue(key_schema_, first_difference)) == CmpBool::CmpTrue) {
+      first_difference++;
+    }
+
+    GenericKey<KeySize> separator = rhs;
+    for (uint32_t i = first_difference + 1; i < column_count; i++) {
+      const auto &col = key_schema_->GetColumn(i);
+      if (!col.IsInlined()) {
+        return rhs;
+      }
+      memset(separator.data_ + col.GetOffset(), 0, col.GetFixedLength());
+    }
+    // A zero sorts after a negative value it replaces.
+    if ((*this)(lhs, separator) < 0 && (*this)(separator, rhs) <= 0) {
+      return separator;
+    }
+    return rhs;
+  }
+
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
 
   // constructor
@@ -103,4 +211,94 @@ class GenericComparator {
   Schema *key_schema_;
 };
 
+/**
+ * Function object for the keys of an index on a single INTEGER (KeySize 4) or BIGINT (KeySize 8) column, which
+ * compares them as the integers they hold rather than through Value. B+ tree pages keep such keys in an array of their
+ * own, and search it with SIMD instructions (see BPlusTreeKeyArray). A null is the smallest integer, and sorts first.
+ */
+template <size_t KeySize>
+class IntegerComparator {
+ public:
+  static_assert(KeySize == 4 || KeySize == 8, "the key is a 32 or 64 bit integer");
+  using IntegerType = std::conditional_t<KeySize == 4, int32_t, int64_t>;
+
+  inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    IntegerType lhs_value = ToInteger(lhs);
+    IntegerType rhs_value = ToInteger(rhs);
+    return lhs_value < rhs_value ? -1 : (lhs_value > rhs_value ? 1 : 0);
+  }
+
+  /** Integer keys have nothing to truncate. */
+  inline GenericKey<KeySize> Separator(const GenericKey<KeySize> & /* lhs */, const GenericKey<KeySize> &rhs) const {
+    return rhs;
+  }
+
+  static inline IntegerType ToInteger(const GenericKey<KeySize> &key) {
+    IntegerType value;
+    memcpy(&value, key.data_, sizeof(IntegerType));
+    return value;
+  }
+
+  // constructor
+  explicit IntegerComparator(Schema *key_schema) {
+    BUSTUB_ASSERT(key_schema->GetColumnCount() == 1 &&
+                      key_schema->GetColumn(0).GetType() == (KeySize == 4 ? TypeId::INTEGER : TypeId::BIGINT),
+                  "the key is a single integer column of the key size");
+    (void)key_schema;
+  }
+};
+
+/**
+ * Function object for keys in the normalized encoding of GenericKey::SetFromKey(tuple, key_schema), which compares
+ * them with a single memcmp, whatever the key columns are. It works for every index that takes a GenericComparator:
+ * the indexes build their keys with SetIndexKey, in the encoding that their comparator expects.
+ */
+template <size_t KeySize>
+class MemcmpComparator {
+ public:
+  inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    int order = memcmp(lhs.data_, rhs.data_, KeySize);
+    return order < 0 ? -1 : (order > 0 ? 1 : 0);
+  }
+
+  /**
+   * Suffix truncation for the separators of a B+ tree: the bytes of rhs after the first one in which the keys differ
+   * are zeroed.
+   * @return a key that sorts after lhs and no later than rhs, which must sort after lhs
+   */
+  inline GenericKey<KeySize> Separator(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
+    GenericKey<KeySize> separator = rhs;
+    size_t first_difference = 0;
+    while (first_difference < KeySize && lhs.data_[first_difference] == rhs.data_[first_difference]) {
+      first_difference++;
+    }
+    if (first_difference + 1 < KeySize) {
+      memset(separator.data_ + first_difference + 1, 0, KeySize - first_difference - 1);
+    }
+    return separator;
+  }
+
+  // constructor
+  explicit MemcmpComparator(Schema * /* key_schema */) {}
+};
+
+template <typename KeyComparator>
+struct IsMemcmpComparator : std::false_type {};
+
+template <size_t KeySize>
+struct IsMemcmpComparator<MemcmpComparator<KeySize>> : std::true_type {};
+
+/**
+ * Sets key from a key tuple in the encoding that KeyComparator compares: the normalized one for MemcmpComparator, and
+ * a copy of the tuple for the others.
+ */
+template <typename KeyComparator, typename KeyType>
+inline void SetIndexKey(KeyType *key, const Tuple &tuple, Schema *key_schema) {
+  if constexpr (IsMemcmpComparator<KeyComparator>::value) {
+    key->SetFromKey(tuple, key_schema);
+  } else {
+    key->SetFromKey(tuple);
+  }
+}
+
 }  // namespace bustub
@@ -14,30 +14,57 @@
  */
 #pragma once
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * IndexIterator walks the leaves of a B+ tree from left to right. It holds a read latch on the leaf it is in, and
+ * latches the next leaf before it lets go of the current one, the same left to right order in which writers latch
+ * neighbouring pages, so that a scan sees every entry that is not removed meanwhile and cannot deadlock with a
+ * writer. The thread that holds an iterator must not change the tree until it is done with it.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
+  using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
+
  public:
-  // you may define your own constructor based on your member variables
+  /** Creates the end iterator. */
   IndexIterator();
+
+  /**
+   * @param bpm the buffer pool manager to fetch the following leaves from
+   * @param leaf the read-latched leaf to start in
+   * @param index the entry to start at; if it is past the end of the leaf, the iterator starts in the next one
+   */
+  IndexIterator(BufferPoolManager *bpm, ReadPageGuard leaf, int index);
   ~IndexIterator();
 
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  IndexIterator &operator=(IndexIterator &&that) noexcept = default;
+
   bool isEnd();
 
   const MappingType &operator*();
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const;
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  /** Moves on to the next leaf for as long as the iterator is past the end of the one it is in. */
+  void SkipToValidEntry();
+
+  BufferPoolManager *bpm_{nullptr};
+  /** The leaf the iterator is in, empty at the end. */
+  ReadPageGuard leaf_guard_;
+  int index_{0};
+  /** The pair last returned, which leaf pages hold compressed and hand out by value. */
+  MappingType item_;
 };
 
 }  // namespace bustub
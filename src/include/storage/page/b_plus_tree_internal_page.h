@@ -12,13 +12,16 @@
 
 #include <queue>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE \
+  (28 + sizeof(KeyType) + sizeof(BPlusTreeKeyArray<KeyType, ValueType, KeyComparator, 0>))
+#define INTERNAL_PAGE_SLOTS ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
+#define INTERNAL_PAGE_SIZE (2 * INTERNAL_PAGE_SLOTS - 1)
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,6 +34,21 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Like a leaf page, an internal page starts with a NextPageId (4) and a HighKey
+ * (key) after the common header, which link it to the next page on its level
+ * (see BPlusTreeLeafPage).
+ *
+ * Like the pairs of a leaf page, the entries are kept in a BPlusTreeKeyArray,
+ * which leaves out the bytes that the keys have in common. The first key
+ * counts as well, and is always one of the keys around it: the separator it
+ * came down with, or the one beside it. INTERNAL_PAGE_SIZE leaves room for
+ * one more entry in either half of a page that is split to take it (see
+ * CanInsert). As in a leaf page, the keys of an integer column are kept apart
+ * from the page ids, and searched with SIMD instructions.
+ *
+ * The page does not touch its children: moving entries to another page does not update their parent page id, and
+ * the separator key that goes up to or comes down from the parent is handed in and out by the caller.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -38,33 +56,44 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   // must call initialize method after "create" a new node
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  const KeyType &GetHighKey() const;
+  void SetHighKey(const KeyType &high_key);
+  bool IsPastHighKey(const KeyType &key, const KeyComparator &comparator) const;
+
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
   int ValueIndex(const ValueType &value) const;
-  int KeyIndex(const KeyType &key)const;
   ValueType ValueAt(int index) const;
+  int GetMinSize() const;
+  bool CanInsert(const KeyType &key) const;
+  bool CanInsertAnyKey() const;
+  bool CanSetKey(const KeyType &key) const;
+  bool CanMoveAllTo(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
+  bool CanMoveLastToFrontOf(const BPlusTreeInternalPage *recipient, const KeyType &middle_key) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
   void SetValueAt(int index, const ValueType &value);
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent, BufferPoolManager *buffer_pool_manager);
-  void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient,int parent_index,
-                        BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, int parent_index,
-                         BufferPoolManager *buffer_pool_manager);
-  void CopyAllFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
+  void MoveHalfTo(BPlusTreeInternalPage *recipient);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key);
 
  private:
- void CopyHalfFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  //void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair,int parent_index, BufferPoolManager *buffer_pool_manager);
-  MappingType array[0];
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType, KeyComparator, PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE>;
+
+  void CopyLastFrom(const MappingType &pair);
+  void CopyFirstFrom(const MappingType &pair);
+  page_id_t next_page_id_;
+  KeyType high_key_;
+  KeyArray array_;
 };
 }  // namespace bustub
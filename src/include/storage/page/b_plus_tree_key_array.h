@@ -0,0 +1,344 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_array.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_array.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#include "common/macros.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_key_search.h"
+
+namespace bustub {
+
+/**
+ * BPlusTreeKeyArray holds the key & value pairs of a B+ tree page, in slots that leave out the bytes all of the keys
+ * have in common. If every key starts with the same Head bytes and ends with the same Tail bytes, those are stored
+ * once, and a slot holds only the sizeof(KeyType) - Head - Tail bytes in between, followed by the value. Keys whose
+ * leading columns repeat, small integers, whose high bytes are all zero, and separators whose trailing columns are
+ * zeroed take up a fraction of a full slot, and a page holds that many more of them.
+ *
+ * A key that has less in common with the others than they have among themselves widens every slot, so the page must
+ * check with WidthWith and Fits that the pairs it is about to take still fit. Keys that go away keep counting towards
+ * what the keys have in common until Compact.
+ *
+ * The array does not know how many pairs it holds, which the page passes in as size, and must be the last member of
+ * the page, which leaves BYTES for the slots. Its own size does not depend on BYTES.
+ *
+ * The keys of an index on an integer column are kept in an array of their own instead, see the specialization for
+ * IntegerComparator below.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------------------------
+ * | CommonKey (key) | Head (2) | Tail (2) | MIDDLE(0) + VALUE(0) | MIDDLE(1) + VALUE(1) | ...
+ *  -------------------------------------------------------------------------------------
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator, size_t BYTES>
+class BPlusTreeKeyArray {
+ public:
+  static constexpr int KEY_SIZE = sizeof(KeyType);
+  static constexpr int VALUE_SIZE = sizeof(ValueType);
+
+  /** @return true if size pairs fit into the page with width bytes of each key in its slot */
+  static bool Fits(int size, int width) { return static_cast<size_t>(size) * (width + VALUE_SIZE) <= BYTES; }
+
+  KeyType KeyAt(int index) const { return ReadKey(index, common_, head_, Width()); }
+
+  ValueType ValueAt(int index) const { return ReadValue(index, Width()); }
+
+  void SetValueAt(int index, const ValueType &value) {
+    memcpy(data_ + index * (Width() + VALUE_SIZE) + Width(), &value, VALUE_SIZE);
+  }
+
+  /** Replaces the key at index. The only key of an array is replaced with all it had in common with itself. */
+  void SetKeyAt(int index, const KeyType &key, int size) {
+    ValueType value = ValueAt(index);
+    if (size == 1) {
+      Reshape(0, {key, KEY_SIZE, KEY_SIZE});
+    } else {
+      Reshape(size, Share(size, nullptr, 0, {key}));
+    }
+    BUSTUB_ASSERT(Fits(size, Width()), "the slots must fit into the page");
+    WriteSlot(index, key, value, head_, Width());
+  }
+
+  /** Inserts a pair in front of the one at index. */
+  void Insert(int index, const KeyType &key, const ValueType &value, int size) {
+    Reshape(size, Share(size, nullptr, 0, {key}));
+    BUSTUB_ASSERT(Fits(size + 1, Width()), "the slots must fit into the page");
+    int slot_size = Width() + VALUE_SIZE;
+    memmove(data_ + (index + 1) * slot_size, data_ + index * slot_size, (size - index) * slot_size);
+    WriteSlot(index, key, value, head_, Width());
+  }
+
+  void Remove(int index, int size) {
+    int slot_size = Width() + VALUE_SIZE;
+    memmove(data_ + index * slot_size, data_ + (index + 1) * slot_size, (size - index - 1) * slot_size);
+  }
+
+  /** Appends pairs [begin, end) of other, which holds other_size pairs. */
+  void Append(const BPlusTreeKeyArray &other, int other_size, int begin, int end, int size) {
+    Reshape(size, Share(size, &other, other_size, {}));
+    BUSTUB_ASSERT(Fits(size + end - begin, Width()), "the slots must fit into the page");
+    for (int i = begin; i < end; i++) {
+      WriteSlot(size + i - begin, other.KeyAt(i), other.ValueAt(i), head_, Width());
+    }
+  }
+
+  /** Narrows the slots down to what the keys that are there have in common. */
+  void Compact(int size) {
+    if (size == 0) {
+      return;
+    }
+    Shared shared{KeyAt(0), KEY_SIZE, KEY_SIZE};
+    for (int i = 1; i < size; i++) {
+      Add(&shared, KeyAt(i), KEY_SIZE, KEY_SIZE);
+    }
+    Reshape(size, shared);
+  }
+
+  /** @return how many bytes of each key a slot would hold once keys were added to the size pairs there are */
+  int WidthWith(int size, std::initializer_list<KeyType> keys) const {
+    Shared shared = Share(size, nullptr, 0, keys);
+    return WidthOf(shared.head_, shared.tail_);
+  }
+
+  /** @return how many bytes of each key a slot would hold once the other_size pairs of other, and keys, were added */
+  int WidthWith(int size, const BPlusTreeKeyArray &other, int other_size, std::initializer_list<KeyType> keys) const {
+    Shared shared = Share(size, &other, other_size, keys);
+    return WidthOf(shared.head_, shared.tail_);
+  }
+
+  /** @return the first index in [begin, end) of a key that is not less than key, end if there is none */
+  int LowerBound(int begin, int end, const KeyType &key, const KeyComparator &comparator) const {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(KeyAt(mid), key) < 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+  /** @return the first index in [begin, end) of a key that is greater than key, end if there is none */
+  int UpperBound(int begin, int end, const KeyType &key, const KeyComparator &comparator) const {
+    while (begin < end) {
+      int mid = begin + (end - begin) / 2;
+      if (comparator(KeyAt(mid), key) <= 0) {
+        begin = mid + 1;
+      } else {
+        end = mid;
+      }
+    }
+    return begin;
+  }
+
+ private:
+  /** What a set of keys has in common: the first head_ and the last tail_ bytes of key_, which is one of them. */
+  struct Shared {
+    KeyType key_;
+    int head_;
+    int tail_;
+  };
+
+  /*
+   * The bytes that the keys have in common may overlap, if they are all the same, in which case a slot holds none.
+   */
+  static int WidthOf(int head, int tail) { return std::max(KEY_SIZE - head - tail, 0); }
+
+  int Width() const { return WidthOf(head_, tail_); }
+
+  /*
+   * Keys that agree with one key of a set on their first n bytes agree with each other on those, so the set can be
+   * compared with any key of it.
+   */
+  static void Add(Shared *shared, const KeyType &key, int head, int tail) {
+    auto *a = reinterpret_cast<const char *>(&shared->key_);
+    auto *b = reinterpret_cast<const char *>(&key);
+    int common_head = 0;
+    while (common_head < shared->head_ && common_head < head && a[common_head] == b[common_head]) {
+      common_head++;
+    }
+    int common_tail = 0;
+    while (common_tail < shared->tail_ && common_tail < tail &&
+           a[KEY_SIZE - 1 - common_tail] == b[KEY_SIZE - 1 - common_tail]) {
+      common_tail++;
+    }
+    shared->head_ = common_head;
+    shared->tail_ = common_tail;
+  }
+
+  Shared Share(int size, const BPlusTreeKeyArray *other, int other_size, std::initializer_list<KeyType> keys) const {
+    Shared shared{common_, head_, tail_};
+    bool is_empty = size == 0;
+    auto add = [&shared, &is_empty](const KeyType &key, int head, int tail) {
+      if (is_empty) {
+        shared = {key, head, tail};
+        is_empty = false;
+      } else {
+        Add(&shared, key, head, tail);
+      }
+    };
+    if (other != nullptr && other_size > 0) {
+      add(other->common_, other->head_, other->tail_);
+    }
+    for (const auto &key : keys) {
+      add(key, KEY_SIZE, KEY_SIZE);
+    }
+    return shared;
+  }
+
+  /*
+   * Rewrites the slots for what the keys have in common to be shared. Slots that widen are rewritten from the back,
+   * slots that narrow from the front, so that none is overwritten before it is read.
+   */
+  void Reshape(int size, const Shared &shared) {
+    int old_width = Width();
+    int new_width = WidthOf(shared.head_, shared.tail_);
+    if (size > 0 && (shared.head_ != head_ || shared.tail_ != tail_)) {
+      KeyType old_common = common_;
+      int old_head = head_;
+      auto move = [&](int i) {
+        KeyType key = ReadKey(i, old_common, old_head, old_width);
+        ValueType value = ReadValue(i, old_width);
+        WriteSlot(i, key, value, shared.head_, new_width);
+      };
+      if (new_width > old_width) {
+        for (int i = size - 1; i >= 0; i--) {
+          move(i);
+        }
+      } else {
+        for (int i = 0; i < size; i++) {
+          move(i);
+        }
+      }
+    }
+    common_ = shared.key_;
+    head_ = shared.head_;
+    tail_ = shared.tail_;
+  }
+
+  KeyType ReadKey(int index, const KeyType &common, int head, int width) const {
+    KeyType key = common;
+    memcpy(reinterpret_cast<char *>(&key) + head, data_ + index * (width + VALUE_SIZE), width);
+    return key;
+  }
+
+  ValueType ReadValue(int index, int width) const {
+    ValueType value;
+    memcpy(&value, data_ + index * (width + VALUE_SIZE) + width, VALUE_SIZE);
+    return value;
+  }
+
+  void WriteSlot(int index, const KeyType &key, const ValueType &value, int head, int width) {
+    char *slot = data_ + index * (width + VALUE_SIZE);
+    memcpy(slot, reinterpret_cast<const char *>(&key) + head, width);
+    memcpy(slot + width, &value, VALUE_SIZE);
+  }
+
+  KeyType common_;
+  uint16_t head_;
+  uint16_t tail_;
+  char data_[0];
+};
+
+/**
+ * The keys of an index on an integer column are compared as integers by IntegerComparator, so instead of going through
+ * the comparator one key at a time the search compares a block of keys at once with SIMD instructions (see
+ * SearchIntegerKeys). For that, the keys are kept in an array of their own, in front of the values, and are not
+ * compressed: a page holds CAPACITY pairs, whatever the keys are.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------------------------
+ * | KEY(0) | KEY(1) | ... | KEY(CAPACITY - 1) | VALUE(0) | VALUE(1) | ... | VALUE(CAPACITY - 1)
+ *  ---------------------------------------------------------------------------------
+ */
+template <size_t KeySize, typename ValueType, size_t BYTES>
+class BPlusTreeKeyArray<GenericKey<KeySize>, ValueType, IntegerComparator<KeySize>, BYTES> {
+ public:
+  using KeyType = GenericKey<KeySize>;
+  using KeyComparator = IntegerComparator<KeySize>;
+  using IntegerType = typename KeyComparator::IntegerType;
+  static constexpr int KEY_SIZE = KeySize;
+  static constexpr int VALUE_SIZE = sizeof(ValueType);
+  static constexpr int CAPACITY = BYTES / (KEY_SIZE + VALUE_SIZE);
+
+  /** @return true if size pairs fit into the page, which they do up to CAPACITY, whatever their keys are */
+  static bool Fits(int size, int /* width */) { return size <= CAPACITY; }
+
+  KeyType KeyAt(int index) const {
+    KeyType key;
+    memcpy(&key, data_ + index * KEY_SIZE, KEY_SIZE);
+    return key;
+  }
+
+  ValueType ValueAt(int index) const {
+    ValueType value;
+    memcpy(&value, Values() + index * VALUE_SIZE, VALUE_SIZE);
+    return value;
+  }
+
+  void SetValueAt(int index, const ValueType &value) { memcpy(Values() + index * VALUE_SIZE, &value, VALUE_SIZE); }
+
+  void SetKeyAt(int index, const KeyType &key, int /* size */) { memcpy(data_ + index * KEY_SIZE, &key, KEY_SIZE); }
+
+  /** Inserts a pair in front of the one at index. */
+  void Insert(int index, const KeyType &key, const ValueType &value, int size) {
+    BUSTUB_ASSERT(Fits(size + 1, KEY_SIZE), "the slots must fit into the page");
+    memmove(data_ + (index + 1) * KEY_SIZE, data_ + index * KEY_SIZE, (size - index) * KEY_SIZE);
+    memmove(Values() + (index + 1) * VALUE_SIZE, Values() + index * VALUE_SIZE, (size - index) * VALUE_SIZE);
+    SetKeyAt(index, key, size + 1);
+    SetValueAt(index, value);
+  }
+
+  void Remove(int index, int size) {
+    memmove(data_ + index * KEY_SIZE, data_ + (index + 1) * KEY_SIZE, (size - index - 1) * KEY_SIZE);
+    memmove(Values() + index * VALUE_SIZE, Values() + (index + 1) * VALUE_SIZE, (size - index - 1) * VALUE_SIZE);
+  }
+
+  /** Appends pairs [begin, end) of other, which holds other_size pairs. */
+  void Append(const BPlusTreeKeyArray &other, int /* other_size */, int begin, int end, int size) {
+    BUSTUB_ASSERT(Fits(size + end - begin, KEY_SIZE), "the slots must fit into the page");
+    memcpy(data_ + size * KEY_SIZE, other.data_ + begin * KEY_SIZE, (end - begin) * KEY_SIZE);
+    memcpy(Values() + size * VALUE_SIZE, other.Values() + begin * VALUE_SIZE, (end - begin) * VALUE_SIZE);
+  }
+
+  void Compact(int /* size */) {}
+
+  int WidthWith(int /* size */, std::initializer_list<KeyType> /* keys */) const { return KEY_SIZE; }
+
+  int WidthWith(int /* size */, const BPlusTreeKeyArray & /* other */, int /* other_size */,
+                std::initializer_list<KeyType> /* keys */) const {
+    return KEY_SIZE;
+  }
+
+  int LowerBound(int begin, int end, const KeyType &key, const KeyComparator & /* comparator */) const {
+    return SearchIntegerKeys<false>(data_, begin, end, KeyComparator::ToInteger(key));
+  }
+
+  int UpperBound(int begin, int end, const KeyType &key, const KeyComparator & /* comparator */) const {
+    return SearchIntegerKeys<true>(data_, begin, end, KeyComparator::ToInteger(key));
+  }
+
+ private:
+  char *Values() { return data_ + CAPACITY * KEY_SIZE; }
+  const char *Values() const { return data_ + CAPACITY * KEY_SIZE; }
+
+  char data_[0];
+};
+
+}  // namespace bustub
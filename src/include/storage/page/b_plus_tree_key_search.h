@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_search.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+/*
+ * Search of a sorted array of integer keys, which may be unaligned. A binary search narrows the keys down to a block
+ * of KEY_SEARCH_BLOCK_SIZE, in which the keys before the one searched for are counted with SIMD compares, as many at
+ * once as a register holds, without a branch on what they are. Which instructions are used is decided at compile
+ * time: AVX2, SSE4.2 (SSE2 for 32 bit keys), or plain compares on other CPUs.
+ */
+static constexpr int KEY_SEARCH_BLOCK_SIZE = 32;
+
+namespace key_search {
+
+template <typename IntegerType>
+inline IntegerType Load(const char *keys, int index) {
+  IntegerType key;
+  memcpy(&key, keys + index * sizeof(IntegerType), sizeof(IntegerType));
+  return key;
+}
+
+/** @return how many of the size keys are less than key, or not greater than key if OR_EQUAL */
+template <bool OR_EQUAL, typename IntegerType>
+inline int CountBelow(const char *keys, int size, IntegerType key) {
+  static_assert(std::is_same_v<IntegerType, int32_t> || std::is_same_v<IntegerType, int64_t>,
+                "the keys are 32 or 64 bit integers");
+  int count = 0;
+  int i = 0;
+  // A key is below if key > it, or, OR_EQUAL, unless it > key.
+#if defined(__AVX2__)
+  if constexpr (std::is_same_v<IntegerType, int64_t>) {
+    __m256i target = _mm256_set1_epi64x(key);
+    for (; i + 4 <= size; i += 4) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(IntegerType)));
+      __m256i greater = OR_EQUAL ? _mm256_cmpgt_epi64(block, target) : _mm256_cmpgt_epi64(target, block);
+      int mask = _mm256_movemask_pd(_mm256_castsi256_pd(greater));
+      count += OR_EQUAL ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  } else {
+    __m256i target = _mm256_set1_epi32(key);
+    for (; i + 8 <= size; i += 8) {
+      __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i * sizeof(IntegerType)));
+      __m256i greater = OR_EQUAL ? _mm256_cmpgt_epi32(block, target) : _mm256_cmpgt_epi32(target, block);
+      int mask = _mm256_movemask_ps(_mm256_castsi256_ps(greater));
+      count += OR_EQUAL ? 8 - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  }
+#elif defined(__SSE4_2__)
+  if constexpr (std::is_same_v<IntegerType, int64_t>) {
+    __m128i target = _mm_set1_epi64x(key);
+    for (; i + 2 <= size; i += 2) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(IntegerType)));
+      __m128i greater = OR_EQUAL ? _mm_cmpgt_epi64(block, target) : _mm_cmpgt_epi64(target, block);
+      int mask = _mm_movemask_pd(_mm_castsi128_pd(greater));
+      count += OR_EQUAL ? 2 - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  } else {
+    __m128i target = _mm_set1_epi32(key);
+    for (; i + 4 <= size; i += 4) {
+      __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i * sizeof(IntegerType)));
+      __m128i greater = OR_EQUAL ? _mm_cmpgt_epi32(block, target) : _mm_cmpgt_epi32(target, block);
+      int mask = _mm_movemask_ps(_mm_castsi128_ps(greater));
+      count += OR_EQUAL ? 4 - __builtin_popcount(mask) : __builtin_popcount(mask);
+    }
+  }
+#endif
+  for (; i < size; i++) {
+    IntegerType other = Load<IntegerType>(keys, i);
+    count += OR_EQUAL ? (other <= key) : (other < key);
+  }
+  return count;
+}
+
+}  // namespace key_search
+
+/**
+ * @return the first index in [begin, end) of a key that is not less than key, or, OR_EQUAL, greater than key; end if
+ * there is none
+ */
+template <bool OR_EQUAL, typename IntegerType>
+inline int SearchIntegerKeys(const char *keys, int begin, int end, IntegerType key) {
+  while (end - begin > KEY_SEARCH_BLOCK_SIZE) {
+    int mid = begin + (end - begin) / 2;
+    IntegerType other = key_search::Load<IntegerType>(keys, mid);
+    if (OR_EQUAL ? other <= key : other < key) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin + key_search::CountBelow<OR_EQUAL>(keys + begin * sizeof(IntegerType), end - begin, key);
+}
+
+}  // namespace bustub
@@ -13,13 +13,16 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE \
+  (28 + sizeof(KeyType) + sizeof(BPlusTreeKeyArray<KeyType, ValueType, KeyComparator, 0>))
+#define LEAF_PAGE_SLOTS ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
+#define LEAF_PAGE_SIZE (2 * LEAF_PAGE_SLOTS - 2)
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -31,13 +34,26 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ * The pairs are kept in a BPlusTreeKeyArray, which stores the bytes that all
+ * the keys of the page have in common once, so how many fit depends on the
+ * keys: LEAF_PAGE_SLOTS at the least, when the keys have nothing in common,
+ * and never more than LEAF_PAGE_SIZE, which leaves room for one more pair in
+ * either half of a page that is split to take it (see CanInsert). The keys
+ * of an index on an integer column (see IntegerComparator) are kept apart
+ * from the RIDs instead, and searched with SIMD instructions.
+ *
+ *  Header format (size in byte, 28 bytes, a key and the header of the key
+ *  array in total; the keys of an integer column, which are not compressed,
+ *  have no CommonKey, Head and Tail):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
  * | ParentPageId (4) | PageId (4) | NextPageId (4)
  *  -----------------------------------------------
+ *  -----------------------------------------------
+ * | HighKey (key) | CommonKey (key) | Head (2) | Tail (2)
+ *  -----------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,9 +64,15 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  const KeyType &GetHighKey() const;
+  void SetHighKey(const KeyType &high_key);
+  bool IsPastHighKey(const KeyType &key, const KeyComparator &comparator) const;
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+  int GetMinSize() const;
+  bool CanInsert(const KeyType &key) const;
+  bool CanMoveAllTo(const BPlusTreeLeafPage *recipient) const;
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
@@ -60,15 +82,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
-  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient, BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient, int parentIndex, BufferPoolManager *buffer_pool_manager);
-  void CopyAllFrom(MappingType *items, int size);
+  void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
+  void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType, KeyComparator, PAGE_SIZE - LEAF_PAGE_HEADER_SIZE>;
+
   void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item, int parentIndex, BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const MappingType &item);
   page_id_t next_page_id_;
-  MappingType array[0];
+  KeyType high_key_;
+  KeyArray array_;
 };
 }  // namespace bustub
\ No newline at end of file
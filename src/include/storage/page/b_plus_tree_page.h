@@ -39,11 +39,13 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * ----------------------------------------------------------------------------
  * | ParentPageId (4) | PageId(4) |
  * ----------------------------------------------------------------------------
+ *
+ * The parent page id is set when the page is created and not kept up to date afterwards: BPlusTree finds the parent
+ * of a page on the path it latched on the way down, rather than latching every child it moves to another parent.
  */
 class BPlusTreePage {
  public:
   bool IsLeafPage() const;
-  bool IsRootPage() const;
   void SetPageType(IndexPageType page_type);
 
   int GetSize() const;
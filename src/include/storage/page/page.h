@@ -12,14 +12,20 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <cstring>
 #include <iostream>
 
 #include "common/config.h"
-#include "common/rwlatch.h"
+#include "common/optimistic_latch.h"
 
 namespace bustub {
 
+/** I/O that the buffer pool manager is performing on a frame while it does not hold its latch. */
+enum class PageIOState { NONE, LOADING, WRITING };
+
 /**
  * Page is the basic unit of storage within the database system. Page provides a wrapper for actual data pages being
  * held in main memory. Page also contains book-keeping information that is used by the buffer pool manager, e.g.
@@ -43,7 +49,7 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
@@ -60,6 +66,18 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Starts an optimistic read of the page, which takes no latch. The page must be pinned for the whole read.
+   * @return the version of the page, to be checked with ValidateOptimisticRead once the read is done
+   */
+  inline uint64_t BeginOptimisticRead() const { return rwlatch_.ReadVersion(); }
+
+  /**
+   * @param version the version returned by BeginOptimisticRead
+   * @return true if the page has not been write-latched since, i.e. what was read is consistent
+   */
+  inline bool ValidateOptimisticRead(uint64_t version) const { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,16 +96,27 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, aligned so that a direct I/O DiskManager can use it as is. */
+  alignas(DIRECT_IO_ALIGNMENT) char data_[PAGE_SIZE]{};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The buffer pool frame this page object is, set once by the buffer pool manager. */
+  frame_id_t frame_id_ = -1;
+  /**
+   * The pin count of this page, or -1 while the frame is free or being handed to another page. Changed under the buffer
+   * pool manager latch, except that a hit may raise it from zero or more without the latch.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** The disk I/O currently in flight on this frame, changed under the buffer pool manager latch. */
+  std::atomic<PageIOState> io_state_{PageIOState::NONE};
+  /** True while the buffer pool manager is reclaiming this frame for another page, protected by its latch. */
+  bool evicting_ = false;
+  /** Signalled by the buffer pool manager when io_state_ goes back to NONE or evicting_ is cleared. */
+  std::condition_variable io_done_;
   /** Page latch. */
-  ReaderWriterLatch rwlatch_;
+  OptimisticLatch rwlatch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,226 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "storage/page/page.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
+
+/**
+ * BasicPageGuard holds the pin on a page and releases it when it goes out of scope. It remembers the frame the page
+ * lives in, so releasing the pin does not have to look the page up again. Guards are move-only: exactly one guard
+ * owns a pin at any time.
+ *
+ * A BasicPageGuard does not latch the page. Use ReadPageGuard or WritePageGuard for that, or UpgradeRead /
+ * UpgradeWrite to latch a page that is already pinned.
+ */
+class BasicPageGuard {
+ public:
+  /** Creates an empty guard, which holds no page. */
+  BasicPageGuard() = default;
+
+  /**
+   * Creates a guard for a page that the caller has just pinned.
+   * @param bpm the buffer pool instance whose frame holds the page
+   * @param page the pinned page
+   * @param frame_id the frame that holds the page
+   */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page, frame_id_t frame_id)
+      : bpm_(bpm), page_(page), frame_id_(frame_id) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+  /** Takes over the pin of that, which becomes empty. */
+  BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+  /** Releases the pin held by this guard, if any, and takes over the pin of that, which becomes empty. */
+  BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpins the page, marking it dirty if it was modified through this guard. The guard becomes empty. */
+  void Drop();
+
+  /**
+   * Takes the read latch of the page and moves the pin into a ReadPageGuard. This guard becomes empty.
+   * @return the read guard
+   */
+  ReadPageGuard UpgradeRead();
+
+  /**
+   * Takes the write latch of the page and moves the pin into a WritePageGuard. This guard becomes empty.
+   * @return the write guard
+   */
+  WritePageGuard UpgradeWrite();
+
+  /** @return true if the guard holds no page, e.g. because the buffer pool had no frame for it */
+  bool IsEmpty() const { return page_ == nullptr; }
+
+  /** @return the guarded page */
+  Page *GetPage() const { return page_; }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return page_->GetPageId(); }
+
+  /** @return the data of the guarded page */
+  const char *GetData() const { return page_->GetData(); }
+
+  /** @return the data of the guarded page, which is marked dirty when the pin is released */
+  char *GetDataMut() {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  /** @return the data of the guarded page, viewed as a T */
+  template <class T>
+  const T *As() const {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the data of the guarded page, viewed as a T; the page is marked dirty when the pin is released */
+  template <class T>
+  T *AsMut() {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /** Marks the page dirty when the pin is released, for callers that modify it through GetPage. */
+  void SetDirty() { is_dirty_ = true; }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  frame_id_t frame_id_{-1};
+  bool is_dirty_{false};
+};
+
+/**
+ * ReadPageGuard holds the pin and the read latch of a page, and releases both when it goes out of scope.
+ */
+class ReadPageGuard {
+ public:
+  /** Creates an empty guard, which holds no page. */
+  ReadPageGuard() = default;
+
+  /**
+   * Creates a guard for a page that the caller has just pinned and read-latched.
+   * @param bpm the buffer pool instance whose frame holds the page
+   * @param page the pinned and latched page
+   * @param frame_id the frame that holds the page
+   */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page, frame_id_t frame_id) : guard_(bpm, page, frame_id) {}
+
+  ReadPageGuard(const ReadPageGuard &) = delete;
+  ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+  ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Releases the read latch and the pin. The guard becomes empty. */
+  void Drop();
+
+  /** @return true if the guard holds no page */
+  bool IsEmpty() const { return guard_.IsEmpty(); }
+
+  /** @return the guarded page */
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the data of the guarded page, viewed as a T */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+/**
+ * WritePageGuard holds the pin and the write latch of a page, and releases both when it goes out of scope.
+ */
+class WritePageGuard {
+ public:
+  /** Creates an empty guard, which holds no page. */
+  WritePageGuard() = default;
+
+  /**
+   * Creates a guard for a page that the caller has just pinned and write-latched.
+   * @param bpm the buffer pool instance whose frame holds the page
+   * @param page the pinned and latched page
+   * @param frame_id the frame that holds the page
+   */
+  WritePageGuard(BufferPoolManager *bpm, Page *page, frame_id_t frame_id) : guard_(bpm, page, frame_id) {}
+
+  WritePageGuard(const WritePageGuard &) = delete;
+  WritePageGuard &operator=(const WritePageGuard &) = delete;
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+  WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Releases the write latch and the pin. The guard becomes empty. */
+  void Drop();
+
+  /** @return true if the guard holds no page */
+  bool IsEmpty() const { return guard_.IsEmpty(); }
+
+  /** @return the guarded page */
+  Page *GetPage() const { return guard_.GetPage(); }
+
+  /** @return the id of the guarded page */
+  page_id_t PageId() const { return guard_.PageId(); }
+
+  /** @return the data of the guarded page */
+  const char *GetData() const { return guard_.GetData(); }
+
+  /** @return the data of the guarded page, which is marked dirty when the pin is released */
+  char *GetDataMut() { return guard_.GetDataMut(); }
+
+  /** @return the data of the guarded page, viewed as a T */
+  template <class T>
+  const T *As() const {
+    return guard_.As<T>();
+  }
+
+  /** @return the data of the guarded page, viewed as a T; the page is marked dirty when the pin is released */
+  template <class T>
+  T *AsMut() {
+    return guard_.AsMut<T>();
+  }
+
+  /** Marks the page dirty when the pin is released, for callers that modify it through GetPage. */
+  void SetDirty() { guard_.SetDirty(); }
+
+ private:
+  friend class BasicPageGuard;
+
+  BasicPageGuard guard_;
+};
+
+}  // namespace bustub
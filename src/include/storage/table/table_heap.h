@@ -22,7 +22,8 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. New pages come from extents of EXTENT_SIZE contiguous pages, so that a
+ * scan of the table reads runs of pages.
  */
 class TableHeap {
   friend class TableIterator;
@@ -55,9 +56,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the buffer access strategy of a bulk insert, or nullptr
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -99,8 +101,14 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the scanning transaction
+   * @param prefetch_window how many pages the iterator reads ahead; 0 disables read-ahead
+   * @param strategy the buffer access strategy of the scan, or nullptr
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, size_t prefetch_window = TABLE_SCAN_PREFETCH_WINDOW,
+                      BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -113,6 +121,8 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Hands out the new pages of this table. */
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +30,24 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  /**
+   * Creates an iterator positioned at rid.
+   * @param table_heap the table to scan
+   * @param rid the first tuple, or an invalid page id for the end iterator
+   * @param txn the scanning transaction
+   * @param prefetch_window how many pages to read ahead while the table is laid out sequentially; 0 disables it
+   * @param strategy the buffer access strategy the scan fetches its pages with, or nullptr
+   */
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, size_t prefetch_window = 0,
+                BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        prefetch_window_(other.prefetch_window_),
+        prefetched_until_(other.prefetched_until_),
+        strategy_(other.strategy_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -52,13 +67,31 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    prefetch_window_ = other.prefetch_window_;
+    prefetched_until_ = other.prefetched_until_;
+    strategy_ = other.strategy_;
     return *this;
   }
 
  private:
+  /**
+   * Reads ahead of the scan once it reaches a page. The pages of a table form a linked list, so the pages ahead are
+   * not known until each one is read; but a table that grew by appending occupies consecutive page ids, and while the
+   * scan keeps finding that layout the next prefetch_window_ page ids are asked for in advance.
+   * @param page_id the page the scan is on
+   * @param next_page_id the page that follows it in the table
+   */
+  void PrefetchAhead(page_id_t page_id, page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** Number of pages to read ahead of the scan. */
+  size_t prefetch_window_;
+  /** The last page id that has been asked for. */
+  page_id_t prefetched_until_{INVALID_PAGE_ID};
+  /** The buffer access strategy of the scan, not owned. Read-ahead pages are loaded outside of its ring. */
+  BufferAccessStrategy *strategy_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,368 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io.cpp
+//
+// Identification: src/storage/disk/async_disk_io.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_io.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "common/logger.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+std::unique_ptr<AsyncDiskIO> AsyncDiskIO::Create(AsyncIOBackendType type, DiskManager *disk_manager, int fd) {
+  if (type != AsyncIOBackendType::THREAD_POOL) {
+    auto io_uring = IoUringDiskIO::Open(disk_manager, fd);
+    if (io_uring != nullptr || type == AsyncIOBackendType::IO_URING) {
+      return io_uring;
+    }
+    LOG_INFO("io_uring is not available, using a thread pool for asynchronous I/O");
+  }
+  return std::make_unique<ThreadPoolDiskIO>(disk_manager, std::min(ASYNC_IO_QUEUE_DEPTH, 8));
+}
+
+/*****************************************************************************
+ * THREAD POOL
+ *****************************************************************************/
+ThreadPoolDiskIO::ThreadPoolDiskIO(DiskManager *disk_manager, size_t num_threads) : disk_manager_(disk_manager) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPoolDiskIO::RunWorker, this);
+  }
+}
+
+ThreadPoolDiskIO::~ThreadPoolDiskIO() {
+  Drain();
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stopped_ = true;
+  }
+  queued_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolDiskIO::Submit(std::vector<DiskRequest> *requests) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &request : *requests) {
+      queue_.push_back(std::move(request));
+    }
+    pending_ += requests->size();
+  }
+  requests->clear();
+  queued_.notify_all();
+}
+
+void ThreadPoolDiskIO::Drain() {
+  std::unique_lock<std::mutex> lock(latch_);
+  drained_.wait(lock, [this] { return pending_ == 0; });
+}
+
+void ThreadPoolDiskIO::RunWorker() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    queued_.wait(lock, [this] { return stopped_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    DiskRequest request = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    bool ok = disk_manager_->ExecuteRequest(request);
+    request.callback_(ok);
+    lock.lock();
+    if (--pending_ == 0) {
+      drained_.notify_all();
+    }
+  }
+}
+
+/*****************************************************************************
+ * IO_URING
+ *****************************************************************************/
+namespace {
+
+/** Tells the completion thread to exit. Requests are heap pointers, so none of them is 0. */
+constexpr uint64_t STOP_REAPER = 0;
+
+int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+/**
+ * @return true if the kernel supports every opcode that is submitted to the ring. Setting up a ring says nothing about
+ * them: a kernel may take the ring and fail IORING_OP_READV with -EINVAL.
+ */
+bool SupportsOpcodes(int ring_fd) {
+  constexpr unsigned num_ops = 256;
+  std::vector<char> buffer(sizeof(io_uring_probe) + num_ops * sizeof(io_uring_probe_op));
+  auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+  // Kernels before 5.6 cannot be probed, and do not have IORING_OP_READ and IORING_OP_WRITE either.
+  if (IoUringRegister(ring_fd, IORING_REGISTER_PROBE, probe, num_ops) < 0) {
+    return false;
+  }
+  for (uint8_t opcode : {IORING_OP_NOP, IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READV, IORING_OP_WRITEV}) {
+    if (opcode >= probe->ops_len || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+unsigned *RingField(void *ring, uint32_t offset) {
+  return reinterpret_cast<unsigned *>(static_cast<char *>(ring) + offset);
+}
+
+}  // namespace
+
+std::unique_ptr<IoUringDiskIO> IoUringDiskIO::Open(DiskManager *disk_manager, int fd) {
+  std::unique_ptr<IoUringDiskIO> io(new IoUringDiskIO(disk_manager, fd));
+  io_uring_params params{};
+  io->ring_fd_ = IoUringSetup(ASYNC_IO_QUEUE_DEPTH, &params);
+  if (io->ring_fd_ < 0) {
+    // ENOSYS on kernels before 5.1; EPERM where it is disabled, e.g. by io_uring_disabled or a seccomp filter.
+    return nullptr;
+  }
+  if (!SupportsOpcodes(io->ring_fd_)) {
+    return nullptr;
+  }
+
+  io->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  io->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  io->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    io->sq_ring_size_ = io->cq_ring_size_ = std::max(io->sq_ring_size_, io->cq_ring_size_);
+  }
+  io->sq_ring_ = mmap(nullptr, io->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring_fd_,
+                      IORING_OFF_SQ_RING);
+  if (io->sq_ring_ == MAP_FAILED) {
+    io->sq_ring_ = nullptr;
+    return nullptr;
+  }
+  if (single_mmap) {
+    io->cq_ring_ = io->sq_ring_;
+  } else {
+    io->cq_ring_ = mmap(nullptr, io->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring_fd_,
+                        IORING_OFF_CQ_RING);
+    if (io->cq_ring_ == MAP_FAILED) {
+      io->cq_ring_ = nullptr;
+      return nullptr;
+    }
+  }
+  io->sqes_ = mmap(nullptr, io->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring_fd_,
+                   IORING_OFF_SQES);
+  if (io->sqes_ == MAP_FAILED) {
+    io->sqes_ = nullptr;
+    return nullptr;
+  }
+
+  io->sq_tail_ = RingField(io->sq_ring_, params.sq_off.tail);
+  io->sq_mask_ = RingField(io->sq_ring_, params.sq_off.ring_mask);
+  io->sq_array_ = RingField(io->sq_ring_, params.sq_off.array);
+  io->cq_head_ = RingField(io->cq_ring_, params.cq_off.head);
+  io->cq_tail_ = RingField(io->cq_ring_, params.cq_off.tail);
+  io->cq_mask_ = RingField(io->cq_ring_, params.cq_off.ring_mask);
+  io->cqes_ = static_cast<char *>(io->cq_ring_) + params.cq_off.cqes;
+  // The submission queue holds sq_entries; since entries are handed to the kernel as soon as they are queued, the
+  // completion queue is what limits the requests in flight.
+  io->cq_entries_ = params.cq_entries;
+
+  io->reaper_ = std::thread(&IoUringDiskIO::RunReaper, io.get());
+  return io;
+}
+
+IoUringDiskIO::~IoUringDiskIO() {
+  if (reaper_.joinable()) {
+    std::unique_lock<std::mutex> lock(latch_);
+    completed_.wait(lock, [this] { return in_flight_ == 0; });
+    in_flight_++;
+    PushEntry(IORING_OP_NOP, nullptr);
+    Enter(1);
+    lock.unlock();
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IoUringDiskIO::Submit(std::vector<DiskRequest> *requests) {
+  std::vector<DiskRequest> unaligned;
+  std::unique_lock<std::mutex> lock(latch_);
+  unsigned queued = 0;
+  for (auto &request : *requests) {
+    // O_DIRECT cannot take an unaligned buffer; DiskManager bounces those, synchronously.
+    if (disk_manager_->IsDirectIO() && !DiskManager::IsAligned(request)) {
+      unaligned.push_back(std::move(request));
+      continue;
+    }
+    if (in_flight_ == cq_entries_) {
+      Enter(queued);
+      queued = 0;
+      completed_.wait(lock, [this] { return in_flight_ < cq_entries_; });
+    }
+    in_flight_++;
+    auto *in_flight = new InFlight{std::move(request), {}};
+    uint8_t opcode = in_flight->request_.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+    if (in_flight->request_.NumPages() > 1) {
+      for (size_t i = 0; i < in_flight->request_.NumPages(); i++) {
+        in_flight->iovecs_.push_back({in_flight->request_.Data(i), PAGE_SIZE});
+      }
+      opcode = in_flight->request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    }
+    PushEntry(opcode, in_flight);
+    queued++;
+    // The submission queue is smaller than the completion queue.
+    if (queued == *sq_mask_ + 1) {
+      Enter(queued);
+      queued = 0;
+    }
+  }
+  Enter(queued);
+  lock.unlock();
+  requests->clear();
+  for (auto &request : unaligned) {
+    bool ok = disk_manager_->ExecuteRequest(request);
+    request.callback_(ok);
+  }
+}
+
+void IoUringDiskIO::Drain() {
+  std::unique_lock<std::mutex> lock(latch_);
+  completed_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void IoUringDiskIO::PushEntry(uint8_t opcode, const InFlight *in_flight) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  io_uring_sqe *sqe = static_cast<io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  if (in_flight != nullptr) {
+    sqe->fd = fd_;
+    sqe->off = static_cast<uint64_t>(in_flight->request_.page_id_) * PAGE_SIZE;
+    if (in_flight->iovecs_.empty()) {
+      sqe->addr = reinterpret_cast<uint64_t>(in_flight->request_.data_);
+      sqe->len = PAGE_SIZE;
+    } else {
+      sqe->addr = reinterpret_cast<uint64_t>(in_flight->iovecs_.data());
+      sqe->len = in_flight->iovecs_.size();
+    }
+    sqe->user_data = reinterpret_cast<uint64_t>(in_flight);
+  } else {
+    sqe->user_data = STOP_REAPER;
+  }
+  sq_array_[index] = index;
+  // The kernel reads the entry once it sees the new tail.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+}
+
+void IoUringDiskIO::Enter(unsigned to_submit) {
+  while (to_submit > 0) {
+    int rc = IoUringEnter(ring_fd_, to_submit, 0, 0);
+    if (rc < 0) {
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+        continue;
+      }
+      LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+      return;
+    }
+    to_submit -= rc;
+  }
+}
+
+void IoUringDiskIO::RunReaper() {
+  while (true) {
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+      int rc = IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      if (rc < 0 && errno != EINTR) {
+        LOG_ERROR("io_uring_enter failed: %s", strerror(errno));
+      }
+      continue;
+    }
+    // Reap every completion that is there in one go, then give the slots back to the kernel at once.
+    std::vector<std::pair<InFlight *, int>> batch;
+    bool stop = false;
+    for (; head != tail; head++) {
+      auto *cqe = static_cast<io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      if (cqe->user_data == STOP_REAPER) {
+        stop = true;
+      } else {
+        batch.emplace_back(reinterpret_cast<InFlight *>(cqe->user_data), cqe->res);
+      }
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    for (const auto &[in_flight, result] : batch) {
+      Complete(in_flight, result);
+    }
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      in_flight_ -= batch.size() + (stop ? 1 : 0);
+    }
+    completed_.notify_all();
+    if (stop) {
+      return;
+    }
+  }
+}
+
+void IoUringDiskIO::Complete(InFlight *in_flight, int result) {
+  const DiskRequest &request = in_flight->request_;
+  bool ok;
+  if (result == static_cast<int>(request.NumPages() * PAGE_SIZE)) {
+    ok = true;
+  } else if (result < 0) {
+    LOG_DEBUG("I/O error in io_uring request: %s", strerror(-result));
+    ok = false;
+  } else if (!request.is_write_ && result == 0) {
+    // Pages beyond the end of the file read as zeros, as with DiskManager::ReadPage.
+    for (size_t i = 0; i < request.NumPages(); i++) {
+      memset(request.Data(i), 0, PAGE_SIZE);
+    }
+    ok = true;
+  } else {
+    // A short transfer is rare enough to redo the whole request synchronously.
+    ok = disk_manager_->ExecuteRequest(request);
+  }
+  request.callback_(ok);
+  delete in_flight;
+}
+
+}  // namespace bustub
@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -20,6 +24,7 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent_allocator.h"
 
 namespace bustub {
 
@@ -29,8 +34,8 @@ static char *buffer_used;
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io)
+    : num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr), file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -52,74 +57,273 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);  // NOLINT
+    // e.g. tmpfs on older kernels; fall back to buffered I/O rather than fail
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("O_DIRECT is not supported for %s, using buffered I/O", db_file.c_str());
+    } else {
+      direct_io_ = true;
     }
   }
+  if (!direct_io_) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  page_id_t db_num_pages = fstat(db_fd_, &stat_buf) == 0 ? static_cast<page_id_t>(stat_buf.st_size / PAGE_SIZE) : 0;
+  free_space_map_ = std::make_unique<FreeSpaceMap>(file_name_.substr(0, n) + ".fsm", db_num_pages);
   buffer_used = nullptr;
 }
 
+DiskManager::DiskManager()
+    : num_flushes_(0),
+      num_writes_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr),
+      free_space_map_(std::make_unique<FreeSpaceMap>("", 0)),
+      async_io_type_(AsyncIOBackendType::THREAD_POOL) {}
+
+DiskManager::~DiskManager() {
+  ReleaseExtents();
+  // The backend's threads may still be finishing requests on the file.
+  async_io_.reset();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  async_io_.reset();
+  ReleaseExtents();
+  SyncFreeSpaceMap();
+  if (db_fd_ >= 0) {
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   log_io_.close();
 }
 
+/**
+ * With direct I/O, returns a buffer that O_DIRECT accepts for the given page data: the data itself if it is aligned,
+ * otherwise a per-thread bounce buffer. Buffer pool frames are always aligned; the bounce buffer is for callers that
+ * read or write pages from memory of their own.
+ */
+static char *DirectIOBuffer(const char *page_data) {
+  alignas(DIRECT_IO_ALIGNMENT) static thread_local char bounce[PAGE_SIZE];
+  if (reinterpret_cast<uintptr_t>(page_data) % DIRECT_IO_ALIGNMENT == 0) {
+    return const_cast<char *>(page_data);
+  }
+  return bounce;
+}
+
 /**
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
+  if (free_space_map_ != nullptr) {
+    free_space_map_->SyncIfReused();
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WritePageData(page_id, page_data);
+}
+
+bool DiskManager::WritePageData(page_id_t page_id, const char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  const char *buffer = page_data;
+  if (direct_io_) {
+    char *aligned = DirectIOBuffer(page_data);
+    if (aligned != page_data) {
+      memcpy(aligned, page_data, PAGE_SIZE);
+    }
+    buffer = aligned;
+  }
+  // pwrite goes straight to the file, there is no user-space buffer to flush
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_fd_, buffer + written, PAGE_SIZE - written, offset + written);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    written += rc;
+  }
+  return true;
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+void DiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadPageData(page_id, page_data); }
+
+bool DiskManager::ReadPageData(page_id_t page_id, char *page_data) {
+  off_t offset = static_cast<off_t>(page_id) * PAGE_SIZE;
+  char *buffer = direct_io_ ? DirectIOBuffer(page_data) : page_data;
+  // pread tells us about the end of the file, so there is no need to stat it first
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_fd_, buffer + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
       LOG_DEBUG("I/O error while reading");
-      return;
+      return false;
+    }
+    if (rc == 0) {
+      break;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE; a page that was never written reads as zeros
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    memset(buffer + read_count, 0, PAGE_SIZE - read_count);
+  }
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, PAGE_SIZE);
+  }
+  return true;
+}
+
+/**
+ * Sync the page data written so far to the device, in one go
+ */
+bool DiskManager::SyncPages() {
+  num_syncs_ += 1;
+  if (db_fd_ < 0) {
+    return true;
+  }
+  int rc;
+  do {
+    rc = fdatasync(db_fd_);
+  } while (rc < 0 && errno == EINTR);
+  if (rc < 0) {
+    LOG_DEBUG("I/O error while syncing");
+    return false;
+  }
+  return true;
+}
+
+bool DiskManager::IsAligned(const DiskRequest &request) {
+  for (size_t i = 0; i < request.NumPages(); i++) {
+    if (reinterpret_cast<uintptr_t>(request.Data(i)) % DIRECT_IO_ALIGNMENT != 0) {
+      return false;
     }
   }
+  return true;
+}
+
+/**
+ * Read or write the pages of a request, contiguous runs with preadv/pwritev
+ */
+bool DiskManager::ExecuteRequest(const DiskRequest &request) {
+  size_t num_pages = request.NumPages();
+  if (num_pages == 1 || (direct_io_ && !IsAligned(request))) {
+    bool ok = true;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id = request.page_id_ + static_cast<page_id_t>(i);
+      ok = (request.is_write_ ? WritePageData(page_id, request.Data(i)) : ReadPageData(page_id, request.Data(i))) && ok;
+    }
+    return ok;
+  }
+
+  off_t offset = static_cast<off_t>(request.page_id_) * PAGE_SIZE;
+  size_t total = num_pages * PAGE_SIZE;
+  size_t done = 0;
+  std::vector<iovec> iovecs(num_pages);
+  while (done < total) {
+    // Pick up where a short transfer left off.
+    size_t first = done / PAGE_SIZE;
+    size_t skip = done % PAGE_SIZE;
+    for (size_t i = first; i < num_pages; i++) {
+      size_t page_skip = i == first ? skip : 0;
+      iovecs[i - first] = {request.Data(i) + page_skip, PAGE_SIZE - page_skip};
+    }
+    int count = static_cast<int>(num_pages - first);
+    ssize_t rc = request.is_write_ ? pwritev(db_fd_, iovecs.data(), count, offset + done)
+                                   : preadv(db_fd_, iovecs.data(), count, offset + done);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0 || (rc == 0 && request.is_write_)) {
+      LOG_DEBUG("I/O error while %s pages", request.is_write_ ? "writing" : "reading");
+      return false;
+    }
+    if (rc == 0) {
+      // The file ends within the run; the rest reads as zeros.
+      for (size_t i = first; i < num_pages; i++) {
+        size_t page_skip = i == first ? skip : 0;
+        memset(request.Data(i) + page_skip, 0, PAGE_SIZE - page_skip);
+      }
+      break;
+    }
+    done += rc;
+  }
+  return true;
+}
+
+/**
+ * Hand a batch of page reads and writes to the asynchronous backend
+ */
+void DiskManager::SubmitRequests(std::vector<DiskRequest> requests) {
+  bool writes = false;
+  for (const auto &request : requests) {
+    if (request.is_write_) {
+      num_writes_ += request.NumPages();
+      writes = true;
+    }
+  }
+  // A reused page must be in use in the free space map on disk before its data is in the database file.
+  if (writes && free_space_map_ != nullptr) {
+    free_space_map_->SyncIfReused();
+  }
+  GetAsyncIO()->Submit(&requests);
+}
+
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  std::vector<DiskRequest> requests;
+  requests.push_back({false, page_id, page_data, [promise](bool ok) { promise->set_value(ok); }});
+  SubmitRequests(std::move(requests));
+  return future;
+}
+
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  std::future<bool> future = promise->get_future();
+  std::vector<DiskRequest> requests;
+  requests.push_back({true, page_id, const_cast<char *>(page_data), [promise](bool ok) { promise->set_value(ok); }});
+  SubmitRequests(std::move(requests));
+  return future;
+}
+
+void DiskManager::SetAsyncIOBackend(AsyncIOBackendType type) {
+  std::lock_guard<std::mutex> guard(async_io_latch_);
+  async_io_type_ = type;
+}
+
+const char *DiskManager::GetAsyncIOBackendName() { return GetAsyncIO()->Name(); }
+
+AsyncDiskIO *DiskManager::GetAsyncIO() {
+  std::lock_guard<std::mutex> guard(async_io_latch_);
+  if (async_io_ == nullptr) {
+    // io_uring works on the db file, so without one only the thread pool can do the requests.
+    async_io_ = AsyncDiskIO::Create(db_fd_ < 0 ? AsyncIOBackendType::THREAD_POOL : async_io_type_, this, db_fd_);
+    if (async_io_ == nullptr) {
+      throw Exception("io_uring is not available");
+    }
+  }
+  return async_io_.get();
 }
 
 /**
@@ -186,16 +390,58 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() { return free_space_map_->Allocate(); }
+
+/**
+ * Allocate contiguous pages, e.g. an extent of a table or index
+ */
+page_id_t DiskManager::AllocateExtent(size_t num_pages) { return free_space_map_->AllocateExtent(num_pages); }
+
+/**
+ * Returns the high-water mark of the allocated pages
+ */
+page_id_t DiskManager::GetNumPages() const { return free_space_map_->GetNumPages(); }
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+void DiskManager::DeallocatePage(page_id_t page_id) { free_space_map_->Deallocate(page_id); }
+
+void DiskManager::DeallocateExtent(page_id_t first_page_id, size_t num_pages) {
+  for (size_t i = 0; i < num_pages; i++) {
+    free_space_map_->Deallocate(first_page_id + static_cast<page_id_t>(i));
+  }
+}
+
+bool DiskManager::IsPageAllocated(page_id_t page_id) const { return free_space_map_->IsAllocated(page_id); }
+
+void DiskManager::RegisterExtentAllocator(ExtentAllocator *allocator) {
+  std::lock_guard<std::mutex> guard(extent_allocators_latch_);
+  extent_allocators_.insert(allocator);
+  allocator->disk_manager_ = this;
+}
+
+void DiskManager::UnregisterExtentAllocator(ExtentAllocator *allocator) {
+  std::lock_guard<std::mutex> guard(extent_allocators_latch_);
+  if (extent_allocators_.erase(allocator) != 0) {
+    allocator->ReleaseExtent();
+  }
+}
+
+void DiskManager::ReleaseExtents() {
+  std::lock_guard<std::mutex> guard(extent_allocators_latch_);
+  for (auto *allocator : extent_allocators_) {
+    allocator->ReleaseExtent();
+  }
+  extent_allocators_.clear();
+}
+
+void DiskManager::SyncFreeSpaceMap() {
+  if (free_space_map_ != nullptr) {
+    free_space_map_->Sync();
+  }
+}
 
 /**
  * Returns number of flushes made so far
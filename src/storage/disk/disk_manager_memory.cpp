@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.cpp
+//
+// Identification: src/storage/disk/disk_manager_memory.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+DiskManagerMemory::DiskManagerMemory(DiskLatencyProfile profile) : profile_(profile) {}
+
+DiskManagerMemory::~DiskManagerMemory() {
+  // The asynchronous backend calls back into this object, so it has to stop before the pages go away.
+  ShutDown();
+}
+
+void DiskManagerMemory::SetLatencyProfile(const DiskLatencyProfile &profile) {
+  std::lock_guard<std::mutex> guard(device_latch_);
+  profile_ = profile;
+}
+
+void DiskManagerMemory::SimulateIO(bool is_write, uint64_t offset, size_t size) {
+  std::chrono::steady_clock::time_point done;
+  {
+    std::lock_guard<std::mutex> guard(device_latch_);
+    std::chrono::nanoseconds busy{0};
+    if (offset != head_offset_) {
+      busy += profile_.seek_latency_;
+    }
+    head_offset_ = offset + size;
+    if (profile_.bandwidth_ > 0) {
+      busy += std::chrono::nanoseconds(static_cast<uint64_t>(size) * 1'000'000'000 / profile_.bandwidth_);
+    }
+    std::chrono::nanoseconds latency = is_write ? profile_.write_latency_ : profile_.read_latency_;
+    if (busy.count() == 0 && latency.count() == 0) {
+      return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    busy_until_ = std::max(busy_until_, now) + busy;
+    done = busy_until_ + latency;
+  }
+  std::this_thread::sleep_until(done);
+}
+
+void DiskManagerMemory::CopyOut(page_id_t page_id, char *page_data) {
+  std::shared_lock<std::shared_mutex> guard(pages_latch_);
+  auto index = static_cast<size_t>(page_id);
+  if (index < pages_.size() && pages_[index] != nullptr) {
+    memcpy(page_data, pages_[index].get(), PAGE_SIZE);
+  } else {
+    memset(page_data, 0, PAGE_SIZE);
+  }
+}
+
+void DiskManagerMemory::CopyIn(page_id_t page_id, const char *page_data) {
+  auto index = static_cast<size_t>(page_id);
+  {
+    std::shared_lock<std::shared_mutex> guard(pages_latch_);
+    if (index < pages_.size() && pages_[index] != nullptr) {
+      memcpy(pages_[index].get(), page_data, PAGE_SIZE);
+      return;
+    }
+  }
+  std::unique_lock<std::shared_mutex> guard(pages_latch_);
+  if (index >= pages_.size()) {
+    pages_.resize(std::max(index + 1, pages_.size() * 2));
+  }
+  if (pages_[index] == nullptr) {
+    pages_[index] = std::make_unique<char[]>(PAGE_SIZE);
+    num_stored_pages_++;
+  }
+  memcpy(pages_[index].get(), page_data, PAGE_SIZE);
+}
+
+bool DiskManagerMemory::ReadPageData(page_id_t page_id, char *page_data) {
+  SimulateIO(false, static_cast<uint64_t>(page_id) * PAGE_SIZE, PAGE_SIZE);
+  CopyOut(page_id, page_data);
+  return true;
+}
+
+bool DiskManagerMemory::WritePageData(page_id_t page_id, const char *page_data) {
+  SimulateIO(true, static_cast<uint64_t>(page_id) * PAGE_SIZE, PAGE_SIZE);
+  CopyIn(page_id, page_data);
+  return true;
+}
+
+bool DiskManagerMemory::ExecuteRequest(const DiskRequest &request) {
+  // A run costs one access and one seek, like the vectored I/O it stands for.
+  SimulateIO(request.is_write_, static_cast<uint64_t>(request.page_id_) * PAGE_SIZE, request.NumPages() * PAGE_SIZE);
+  for (size_t i = 0; i < request.NumPages(); i++) {
+    page_id_t page_id = request.page_id_ + static_cast<page_id_t>(i);
+    if (request.is_write_) {
+      CopyIn(page_id, request.Data(i));
+    } else {
+      CopyOut(page_id, request.Data(i));
+    }
+  }
+  return true;
+}
+
+size_t DiskManagerMemory::GetMemoryUsage() {
+  std::shared_lock<std::shared_mutex> guard(pages_latch_);
+  return num_stored_pages_ * PAGE_SIZE;
+}
+
+void DiskManagerMemory::WriteLog(char *log_data, int size) {
+  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+    return;
+  }
+  flush_log_ = true;
+  if (flush_log_f_ != nullptr) {
+    // used for checking non-blocking flushing
+    assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  }
+  num_flushes_ += 1;
+  {
+    std::lock_guard<std::mutex> guard(log_latch_);
+    SimulateIO(true, LOG_OFFSET + log_.size(), size);
+    log_.insert(log_.end(), log_data, log_data + size);
+  }
+  flush_log_ = false;
+}
+
+bool DiskManagerMemory::ReadLog(char *log_data, int size, int offset) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+    return false;
+  }
+  size_t read_count = std::min(static_cast<size_t>(size), log_.size() - offset);
+  SimulateIO(false, LOG_OFFSET + offset, read_count);
+  memcpy(log_data, log_.data() + offset, read_count);
+  // if log file ends before reading "size"
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+}  // namespace bustub
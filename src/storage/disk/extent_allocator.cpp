@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/storage/disk/extent_allocator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/extent_allocator.h"
+
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+ExtentAllocator::~ExtentAllocator() {
+  DiskManager *disk_manager = disk_manager_.load();
+  if (disk_manager != nullptr) {
+    disk_manager->UnregisterExtentAllocator(this);
+  }
+}
+
+page_id_t ExtentAllocator::AllocatePage(DiskManager *disk_manager) {
+  // Registering takes the disk manager's latch, which is always taken before ours.
+  if (disk_manager_.load() != disk_manager) {
+    disk_manager->RegisterExtentAllocator(this);
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  if (next_page_id_ == end_page_id_) {
+    next_page_id_ = disk_manager->AllocateExtent(extent_size_);
+    end_page_id_ = next_page_id_ + static_cast<page_id_t>(extent_size_);
+  }
+  return next_page_id_++;
+}
+
+void ExtentAllocator::ReturnPage(DiskManager *disk_manager, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (page_id + 1 == next_page_id_ && page_id != INVALID_PAGE_ID) {
+    next_page_id_--;
+    return;
+  }
+  disk_manager->DeallocatePage(page_id);
+}
+
+void ExtentAllocator::ReleaseExtent() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (next_page_id_ != end_page_id_) {
+    disk_manager_.load()->DeallocateExtent(next_page_id_, static_cast<size_t>(end_page_id_ - next_page_id_));
+    next_page_id_ = end_page_id_;
+  }
+  disk_manager_ = nullptr;
+}
+
+}  // namespace bustub
@@ -0,0 +1,323 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/** @return a word with the num_bits lowest bits set */
+static uint64_t LowBits(size_t num_bits) { return num_bits >= 64 ? ~static_cast<uint64_t>(0) : (1ULL << num_bits) - 1; }
+
+FreeSpaceMap::FreeSpaceMap(const std::string &file_name, page_id_t db_num_pages)
+    : chunks_(std::make_unique<std::atomic<Chunk *>[]>(MAX_CHUNKS)) {
+  if (file_name.empty()) {
+    return;
+  }
+  fd_ = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);  // NOLINT
+  if (fd_ < 0) {
+    throw Exception("can't open free space map file");
+  }
+  // A new database: whatever map is lying around belongs to a file that is gone.
+  if (db_num_pages == 0) {
+    if (ftruncate(fd_, 0) != 0) {
+      LOG_WARN("can't truncate free space map file %s", file_name.c_str());
+    }
+    return;
+  }
+
+  struct stat stat_buf;
+  size_t map_pages = fstat(fd_, &stat_buf) == 0 ? stat_buf.st_size / PAGE_SIZE : 0;
+  page_id_t high_water = 0;
+  size_t used_pages = 0;
+  uint64_t buffer[WORDS_PER_MAP_PAGE];
+  for (size_t map_page = 0; map_page < map_pages; map_page++) {
+    ssize_t rc = pread(fd_, buffer, PAGE_SIZE, static_cast<off_t>(map_page * PAGE_SIZE));
+    if (rc != static_cast<ssize_t>(PAGE_SIZE)) {
+      LOG_WARN("can't read page %zu of free space map file %s", map_page, file_name.c_str());
+      break;
+    }
+    for (size_t i = 0; i < WORDS_PER_MAP_PAGE; i++) {
+      if (buffer[i] == 0) {
+        continue;
+      }
+      size_t word_index = map_page * WORDS_PER_MAP_PAGE + i;
+      Word(word_index).store(buffer[i], std::memory_order_relaxed);
+      used_pages += __builtin_popcountll(buffer[i]);
+      high_water = static_cast<page_id_t>(word_index * BITS_PER_WORD + BITS_PER_WORD - __builtin_clzll(buffer[i]));
+    }
+  }
+
+  // Pages written after the last sync, or before there was a map at all, are in use as far as we can tell.
+  for (page_id_t page_id = high_water; page_id < db_num_pages; page_id++) {
+    size_t word_index = page_id / BITS_PER_WORD;
+    Word(word_index).fetch_or(1ULL << (page_id % BITS_PER_WORD), std::memory_order_relaxed);
+    MarkDirty(word_index);
+    used_pages++;
+  }
+  next_page_id_ = std::max(high_water, db_num_pages);
+  free_pages_ = next_page_id_ - used_pages;
+}
+
+FreeSpaceMap::~FreeSpaceMap() {
+  Sync();
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  for (size_t i = 0; i < MAX_CHUNKS; i++) {
+    delete chunks_[i].load();
+  }
+}
+
+page_id_t FreeSpaceMap::AllocateExtent(size_t num_pages) {
+  BUSTUB_ASSERT(num_pages >= 1 && num_pages <= MAX_EXTENT_SIZE, "extent size out of range");
+  while (true) {
+    // Reserve free pages below the high-water mark, if there are enough of them.
+    size_t free_pages = free_pages_.load();
+    bool reserved = false;
+    while (free_pages >= num_pages) {
+      if (free_pages_.compare_exchange_weak(free_pages, free_pages - num_pages)) {
+        reserved = true;
+        break;
+      }
+    }
+    if (reserved) {
+      page_id_t page_id = ClaimFreeBits(num_pages);
+      if (page_id != INVALID_PAGE_ID) {
+        return page_id;
+      }
+      free_pages_ += num_pages;
+    }
+
+    // Grow the file instead.
+    page_id_t first = next_page_id_.fetch_add(static_cast<page_id_t>(num_pages));
+    BUSTUB_ASSERT(static_cast<size_t>(first) + num_pages <= MAX_CHUNKS * WORDS_PER_CHUNK * BITS_PER_WORD,
+                  "out of page ids");
+    if (SetBits(first, num_pages)) {
+      return first;
+    }
+    // A scan that read the new high-water mark got to some of these ids first. They are free again, and so is the
+    // id that scan had reserved, which it did not take.
+    free_pages_ += num_pages;
+  }
+}
+
+bool FreeSpaceMap::SetBits(page_id_t first, size_t num_pages) {
+  size_t begin = first;
+  size_t end = begin + num_pages;
+  for (size_t bit = begin; bit < end;) {
+    size_t word_index = bit / BITS_PER_WORD;
+    size_t offset = bit % BITS_PER_WORD;
+    size_t count = std::min(end - bit, BITS_PER_WORD - offset);
+    uint64_t mask = LowBits(count) << offset;
+    uint64_t old = Word(word_index).fetch_or(mask);
+    if ((old & mask) != 0) {
+      // Take back what we set, in this word and the ones before it, but not the bits the scan claimed.
+      Word(word_index).fetch_and(~(mask & ~old));
+      for (size_t undo = begin; undo < bit;) {
+        size_t undo_offset = undo % BITS_PER_WORD;
+        size_t undo_count = std::min(bit - undo, BITS_PER_WORD - undo_offset);
+        Word(undo / BITS_PER_WORD).fetch_and(~(LowBits(undo_count) << undo_offset));
+        undo += undo_count;
+      }
+      return false;
+    }
+    MarkDirty(word_index);
+    bit += count;
+  }
+  return true;
+}
+
+page_id_t FreeSpaceMap::ClaimFreeBits(size_t num_pages) {
+  uint64_t run = LowBits(num_pages);
+  while (true) {
+    size_t limit = next_page_id_.load();
+    size_t num_words = (limit + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    size_t start = std::min(search_hint_.load(std::memory_order_relaxed), num_words);
+    for (size_t i = 0; i < num_words; i++) {
+      size_t word_index = (start + i) % num_words;
+      auto *word = const_cast<std::atomic<uint64_t> *>(FindWord(word_index));
+      if (word == nullptr) {
+        continue;
+      }
+      // Bits at and above the high-water mark are not free yet.
+      uint64_t beyond = 0;
+      if (word_index == num_words - 1 && limit % BITS_PER_WORD != 0) {
+        beyond = ~LowBits(limit % BITS_PER_WORD);
+      }
+      uint64_t bits = word->load();
+      while ((bits | beyond) != ~static_cast<uint64_t>(0)) {
+        uint64_t used = bits | beyond;
+        size_t offset = BITS_PER_WORD;
+        if (num_pages == 1) {
+          offset = __builtin_ctzll(~used);
+        } else {
+          for (size_t candidate = 0; candidate + num_pages <= BITS_PER_WORD; candidate++) {
+            if ((used & (run << candidate)) == 0) {
+              offset = candidate;
+              break;
+            }
+          }
+        }
+        if (offset == BITS_PER_WORD) {
+          break;
+        }
+        if (word->compare_exchange_weak(bits, bits | (run << offset))) {
+          MarkDirty(word_index);
+          reuses_ += 1;
+          if (num_pages == 1 && word_index != start) {
+            search_hint_.store(word_index, std::memory_order_relaxed);
+          }
+          return static_cast<page_id_t>(word_index * BITS_PER_WORD + offset);
+        }
+      }
+    }
+    // A single page is always there, since we hold a reservation for it: another allocation moved it under us.
+    if (num_pages > 1) {
+      return INVALID_PAGE_ID;
+    }
+  }
+}
+
+void FreeSpaceMap::Deallocate(page_id_t page_id) {
+  if (page_id < 0 || page_id >= next_page_id_.load()) {
+    return;
+  }
+  size_t word_index = page_id / BITS_PER_WORD;
+  if (FindWord(word_index) == nullptr) {
+    return;
+  }
+  uint64_t bit = 1ULL << (page_id % BITS_PER_WORD);
+  if ((Word(word_index).fetch_and(~bit) & bit) == 0) {
+    return;
+  }
+  MarkDirty(word_index);
+  size_t hint = search_hint_.load(std::memory_order_relaxed);
+  while (word_index < hint && !search_hint_.compare_exchange_weak(hint, word_index, std::memory_order_relaxed)) {
+  }
+  free_pages_ += 1;
+}
+
+bool FreeSpaceMap::IsAllocated(page_id_t page_id) const {
+  if (page_id < 0 || page_id >= next_page_id_.load()) {
+    return false;
+  }
+  const auto *word = FindWord(page_id / BITS_PER_WORD);
+  return word != nullptr && (word->load() & (1ULL << (page_id % BITS_PER_WORD))) != 0;
+}
+
+void FreeSpaceMap::Sync() {
+  if (fd_ < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(sync_latch_);
+  SyncLocked();
+}
+
+void FreeSpaceMap::SyncIfReused() {
+  if (fd_ < 0) {
+    return;
+  }
+  uint64_t reuses = reuses_.load();
+  if (synced_reuses_.load() >= reuses) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(sync_latch_);
+  // The sync we waited for may have covered our reuses already.
+  if (synced_reuses_.load() < reuses) {
+    SyncLocked();
+  }
+}
+
+void FreeSpaceMap::SyncLocked() {
+  // Every reuse counted so far has marked its map page dirty, so the pages written below cover it.
+  uint64_t reuses = reuses_.load();
+  uint64_t buffer[WORDS_PER_MAP_PAGE];
+  bool wrote = false;
+  bool ok = true;
+  for (size_t chunk_index = 0; chunk_index < MAX_CHUNKS; chunk_index++) {
+    Chunk *chunk = chunks_[chunk_index].load();
+    if (chunk == nullptr) {
+      continue;
+    }
+    for (size_t page = 0; page < MAP_PAGES_PER_CHUNK; page++) {
+      // Clear the flag first, so that a change made while we copy marks the page again.
+      if (!chunk->dirty_[page].exchange(false)) {
+        continue;
+      }
+      for (size_t i = 0; i < WORDS_PER_MAP_PAGE; i++) {
+        buffer[i] = chunk->words_[page * WORDS_PER_MAP_PAGE + i].load(std::memory_order_relaxed);
+      }
+      off_t offset = static_cast<off_t>((chunk_index * MAP_PAGES_PER_CHUNK + page) * PAGE_SIZE);
+      ssize_t rc;
+      do {
+        rc = pwrite(fd_, buffer, PAGE_SIZE, offset);
+      } while (rc < 0 && errno == EINTR);
+      if (rc != static_cast<ssize_t>(PAGE_SIZE)) {
+        LOG_DEBUG("I/O error while writing free space map");
+        chunk->dirty_[page] = true;
+        ok = false;
+      }
+      wrote = true;
+    }
+  }
+  if (wrote && fdatasync(fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing free space map");
+    ok = false;
+  }
+  if (ok) {
+    synced_reuses_ = reuses;
+  }
+}
+
+std::atomic<uint64_t> &FreeSpaceMap::Word(size_t word_index) {
+  size_t chunk_index = word_index / WORDS_PER_CHUNK;
+  BUSTUB_ASSERT(chunk_index < MAX_CHUNKS, "page id out of range");
+  Chunk *chunk = chunks_[chunk_index].load();
+  if (chunk == nullptr) {
+    auto *fresh = new Chunk();
+    if (chunks_[chunk_index].compare_exchange_strong(chunk, fresh)) {
+      chunk = fresh;
+    } else {
+      delete fresh;
+    }
+  }
+  return chunk->words_[word_index % WORDS_PER_CHUNK];
+}
+
+const std::atomic<uint64_t> *FreeSpaceMap::FindWord(size_t word_index) const {
+  size_t chunk_index = word_index / WORDS_PER_CHUNK;
+  if (chunk_index >= MAX_CHUNKS) {
+    return nullptr;
+  }
+  Chunk *chunk = chunks_[chunk_index].load();
+  return chunk == nullptr ? nullptr : &chunk->words_[word_index % WORDS_PER_CHUNK];
+}
+
+void FreeSpaceMap::MarkDirty(size_t word_index) {
+  Chunk *chunk = chunks_[word_index / WORDS_PER_CHUNK].load();
+  size_t page = (word_index % WORDS_PER_CHUNK) / WORDS_PER_MAP_PAGE;
+  if (!chunk->dirty_[page].load(std::memory_order_relaxed)) {
+    chunk->dirty_[page].store(true);
+  }
+}
+
+}  // namespace bustub
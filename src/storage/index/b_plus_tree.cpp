@@ -9,29 +9,46 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <memory>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
+/*
+ * The sizes are clamped to what the pages can hold: an internal page needs a spare slot for the child it takes before
+ * it splits, and at least three children so that it never ends up with a single child after a split (see
+ * BPlusTreePage::GetMinSize).
+ */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, BPlusTreeLatching latching)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      leaf_max_size_(std::clamp<int>(leaf_max_size, 2, LEAF_PAGE_SIZE)),
+      internal_max_size_(std::clamp<int>(internal_max_size, 3, INTERNAL_PAGE_SIZE - 1)),
+      latching_(latching) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const {
+  root_latch_.RLock();
+  bool is_empty = root_page_id_ == INVALID_PAGE_ID;
+  root_latch_.RUnlock();
+  return is_empty;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +59,16 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  ReadPageGuard guard = FindLeafRead(key, false);
+  if (guard.IsEmpty()) {
+    return false;
+  }
+  ValueType value;
+  if (!guard.template As<LeafPage>()->Lookup(key, value, comparator_)) {
+    return false;
+  }
+  result->push_back(value);
+  return true;
 }
 
 /*****************************************************************************
@@ -56,7 +82,37 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (latching_ == BPlusTreeLatching::B_LINK) {
+    return InsertBLink(key, value);
+  }
+
+  // Most inserts do not split the leaf, so the first try latches nothing but the leaf for writing.
+  bool is_root;
+  Page *page = FindLeafOptimistic(key, &is_root);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType old_value;
+    bool exists = leaf->Lookup(key, old_value, comparator_);
+    bool is_safe = !exists && IsSafe(leaf, Operation::INSERT, is_root, key);
+    if (is_safe) {
+      leaf->Insert(key, value, comparator_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe);
+    if (exists || is_safe) {
+      return is_safe;
+    }
+  }
+
+  // The pessimistic pass keeps its latches in a transaction, so it needs one even if the caller has none.
+  std::unique_ptr<Transaction> local_transaction;
+  if (transaction == nullptr) {
+    local_transaction = std::make_unique<Transaction>(INVALID_TXN_ID);
+    transaction = local_transaction.get();
+  }
+  return InsertIntoLeaf(key, value, transaction);
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,32 +120,98 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  BasicPageGuard guard = NewTreePage(&page_id);
+  auto *leaf = guard.template AsMut<LeafPage>();
+  leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  leaf->Insert(key, value, comparator_);
+  root_page_id_ = page_id;
+  height_ = 1;
+  UpdateRootPageId(1);
+}
 
 /*
- * Insert constant key & value pair into leaf page
- * User needs to first find the right leaf page as insertion target, then look
- * through leaf page to see whether insert key exist or not. If exist, return
- * immdiately, otherwise insert entry. Remember to deal with split if necessary.
+ * Insert constant key & value pair into leaf page, holding the write latches
+ * of every page the insert may split. This is the pessimistic pass of Insert,
+ * for when the leaf turned out to be full.
  * @return: since we only support unique key, if user try to insert duplicate
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    StartNewTree(key, value);
+    ReleasePageSet(transaction, true);
+    return true;
+  }
+
+  Page *page = FindLeafPessimistic(key, Operation::INSERT, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType old_value;
+  if (leaf->Lookup(key, old_value, comparator_)) {
+    ReleasePageSet(transaction, false);
+    return false;
+  }
+  KeyType separator;
+  BasicPageGuard new_guard = InsertOrSplit(leaf, key, value, &separator);
+  if (!new_guard.IsEmpty()) {
+    InsertIntoParent(leaf, separator, new_guard.template AsMut<LeafPage>(), transaction);
+  }
+  ReleasePageSet(transaction, true);
+  return true;
 }
 
 /*
- * Split input page and return newly created page.
+ * Split input page and return a guard on the newly created page.
  * Using template N to represent either internal page or leaf page.
- * User needs to first ask for new page from buffer pool manager(NOTICE: throw
- * an "out of memory" exception if returned value is nullptr), then move half
- * of key & value pairs from input page to newly created page
+ * The new page is reachable only through pages the caller holds latched, so
+ * it is not latched itself.
+ * The separator of a leaf split is the shortest key between the two leaves,
+ * which also becomes the high key of the old leaf; that of an internal split
+ * is the first key of the new page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+BasicPageGuard BPLUSTREE_TYPE::Split(N *node, KeyType *separator) {
+  page_id_t page_id;
+  BasicPageGuard guard = NewTreePage(&page_id);
+  auto *new_node = guard.template AsMut<N>();
+  new_node->Init(page_id, INVALID_PAGE_ID, node->GetMaxSize());
+  node->MoveHalfTo(new_node);
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    *separator = comparator_.Separator(node->KeyAt(node->GetSize() - 1), new_node->KeyAt(0));
+    node->SetHighKey(*separator);
+  } else {
+    *separator = new_node->KeyAt(0);
+  }
+  return guard;
+}
+
+/*
+ * Insert key & value pair into a leaf, or a separator and the page split off
+ * to its left into an internal page, which must not hold the key yet. A page
+ * splits once it is over what it may hold, a leaf when it fills up to its max
+ * size and an internal page when it goes past it. A key that has less in
+ * common with the others than they have among themselves widens every slot,
+ * and if the page cannot take it for that, it splits first and the key goes
+ * into the half it belongs in, which has room for it however wide its slots
+ * are (see LEAF_PAGE_SIZE and INTERNAL_PAGE_SIZE).
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N, typename V>
+BasicPageGuard BPLUSTREE_TYPE::InsertOrSplit(N *node, const KeyType &key, const V &value, KeyType *separator) {
+  if (node->CanInsert(key)) {
+    node->Insert(key, value, comparator_);
+    bool is_full = node->IsLeafPage() ? node->GetSize() >= node->GetMaxSize() : node->GetSize() > node->GetMaxSize();
+    return is_full ? Split(node, separator) : BasicPageGuard();
+  }
+  BasicPageGuard new_guard = Split(node, separator);
+  N *half = comparator_(key, *separator) < 0 ? node : new_guard.template AsMut<N>();
+  half->Insert(key, value, comparator_);
+  return new_guard;
 }
 
 /*
@@ -97,13 +219,316 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  * @param   old_node      input page from split() method
  * @param   key
  * @param   new_node      returned page from split() method
- * User needs to first find the parent page of old_node, parent node must be
- * adjusted to take info of new_node into account. Remember to deal with split
- * recursively if necessary.
+ * The parent of old_node is the page before it in the page set, which still
+ * holds it since old_node was not safe. Splits recursively if necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  Page *parent_page;
+  if (!FindParentPage(old_node->GetPageId(), transaction, &parent_page)) {
+    UNREACHABLE("the parent of a page that splits is still latched");
+  }
+  if (parent_page == nullptr) {
+    page_id_t root_page_id;
+    BasicPageGuard guard = NewTreePage(&root_page_id);
+    auto *root = guard.template AsMut<InternalPage>();
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
+    root_page_id_ = root_page_id;
+    height_++;
+    UpdateRootPageId();
+    return;
+  }
+
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  KeyType separator;
+  BasicPageGuard new_guard = InsertOrSplit(parent, key, new_node->GetPageId(), &separator);
+  if (!new_guard.IsEmpty()) {
+    InsertIntoParent(parent, separator, new_guard.template AsMut<InternalPage>(), transaction);
+  }
+}
+
+/*
+ * Insert constant key & value pair in B-link mode. The leaf is found with
+ * read latches, then latched for writing on its own, moving right if it was
+ * split in between; a split is posted to the parent after the leaf is
+ * released.
+ * @return: false for a duplicate key, otherwise true.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertBLink(const KeyType &key, const ValueType &value) {
+  std::vector<page_id_t> path;
+  ReadPageGuard read_guard = FindLeafRead(key, false, &path);
+  while (read_guard.IsEmpty()) {
+    root_latch_.WLock();
+    bool is_empty = root_page_id_ == INVALID_PAGE_ID;
+    if (is_empty) {
+      StartNewTree(key, value);
+    }
+    root_latch_.WUnlock();
+    if (is_empty) {
+      return true;
+    }
+    path.clear();
+    read_guard = FindLeafRead(key, false, &path);
+  }
+  page_id_t leaf_id = read_guard.PageId();
+  read_guard.Drop();
+
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(leaf_id);
+  MoveRight(&guard, key);
+  ValueType old_value;
+  if (guard.template As<LeafPage>()->Lookup(key, old_value, comparator_)) {
+    return false;
+  }
+  KeyType separator;
+  BasicPageGuard new_guard = InsertOrSplit(guard.template AsMut<LeafPage>(), key, value, &separator);
+  if (new_guard.IsEmpty()) {
+    return true;
+  }
+  page_id_t new_leaf_id = new_guard.PageId();
+  // The new leaf is reachable through the right link from here on, so the split is complete at this level.
+  new_guard.Drop();
+  guard.Drop();
+  InsertIntoParentBLink(leaf_id, separator, new_leaf_id, 0, &path);
+  return true;
+}
+
+/*
+ * The page above a split is the one the descent went through, unless that
+ * was split too in the meantime, in which case the separator belongs further
+ * right; or the split page was the root when the descent began, in which case
+ * it either still is and gets a new root, or the tree has grown since and
+ * the page above is found from the new root. A page split off the root has
+ * no page above it until the new root is installed, which is waited for.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::InsertIntoParentBLink(page_id_t left_id, KeyType key, page_id_t right_id, int level,
+                                           std::vector<page_id_t> *path) {
+  while (true) {
+    page_id_t parent_id;
+    if (!path->empty()) {
+      parent_id = path->back();
+      path->pop_back();
+    } else {
+      root_latch_.WLock();
+      if (root_page_id_ == left_id) {
+        page_id_t root_page_id;
+        BasicPageGuard guard = NewTreePage(&root_page_id);
+        auto *root = guard.template AsMut<InternalPage>();
+        root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+        root->PopulateNewRoot(left_id, key, right_id);
+        root_page_id_ = root_page_id;
+        height_++;
+        UpdateRootPageId();
+        root_latch_.WUnlock();
+        return;
+      }
+      page_id_t root_page_id = root_page_id_;
+      int root_level = height_ - 1;
+      root_latch_.WUnlock();
+      if (root_level < level + 1) {
+        // The root split, but the thread that split it has not installed the new root yet; the split page is to
+        // the right of the old root, at the root's level, and has no parent until then.
+        std::this_thread::yield();
+        continue;
+      }
+      parent_id = FindPageAtLevel(root_page_id, root_level, level + 1, key);
+    }
+
+    WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(parent_id);
+    MoveRight(&guard, key);
+    BUSTUB_ASSERT(!guard.template As<BPlusTreePage>()->IsLeafPage(), "A split is posted to an internal page.");
+    KeyType separator;
+    BasicPageGuard new_guard = InsertOrSplit(guard.template AsMut<InternalPage>(), key, right_id, &separator);
+    if (new_guard.IsEmpty()) {
+      return;
+    }
+    key = separator;
+    left_id = guard.PageId();
+    right_id = new_guard.PageId();
+    new_guard.Drop();
+    guard.Drop();
+    level++;
+  }
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+/*
+ * The tree is built while the root latch is held for writing, so that inserts
+ * wait for the load rather than start a tree of their own. The pages are not
+ * reachable before the root is set, and need no latches.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::BulkLoad(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor) {
+  root_latch_.WLock();
+  if (root_page_id_ != INVALID_PAGE_ID) {
+    root_latch_.WUnlock();
+    throw Exception(ExceptionType::INVALID, "bulk load into a tree that is not empty");
+  }
+
+  std::vector<page_id_t> pages;
+  size_t num_pairs;
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  int height = 1;
+  try {
+    num_pairs = BulkLoadLeaves(next, fill_factor, &level, &pages);
+    while (level.size() > 1) {
+      level = BulkLoadLevel(level, fill_factor, &pages);
+      height++;
+    }
+  } catch (...) {
+    for (page_id_t page_id : pages) {
+      buffer_pool_manager_->DeletePage(page_id);
+    }
+    root_latch_.WUnlock();
+    throw;
+  }
+
+  if (!level.empty()) {
+    root_page_id_ = level[0].second;
+    height_ = height;
+    UpdateRootPageId(1);
+  }
+  root_latch_.WUnlock();
+  return num_pairs;
+}
+
+/*
+ * Every leaf but the last is filled up to the fill factor, or as far as its
+ * keys fit. The last one may come out below its min size, in which case it
+ * either goes into the leaf before it or takes pairs from it, as a removal
+ * would do.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::BulkLoadLeaves(const std::function<bool(KeyType *, ValueType *)> &next, double fill_factor,
+                                      std::vector<std::pair<KeyType, page_id_t>> *leaves,
+                                      std::vector<page_id_t> *pages) {
+  // A leaf splits when it fills up, so it holds at most one pair less than its max size.
+  int max_size = leaf_max_size_ - 1;
+  int min_size = std::max(std::min<int>(leaf_max_size_ / 2, LEAF_PAGE_SLOTS / 2), 1);
+  int fill_size = std::clamp(static_cast<int>(fill_factor * max_size), min_size, max_size);
+
+  size_t num_pairs = 0;
+  BasicPageGuard guard;
+  LeafPage *leaf = nullptr;
+  KeyType key;
+  ValueType value;
+  while (next(&key, &value)) {
+    if (leaf != nullptr) {
+      int order = comparator_(key, leaf->KeyAt(leaf->GetSize() - 1));
+      if (order == 0) {
+        continue;
+      }
+      if (order < 0) {
+        throw Exception(ExceptionType::INVALID, "bulk load input is not in key order");
+      }
+    }
+    if (leaf == nullptr || leaf->GetSize() == fill_size || !leaf->CanInsert(key)) {
+      page_id_t page_id;
+      BasicPageGuard new_guard = NewTreePage(&page_id);
+      pages->push_back(page_id);
+      auto *new_leaf = new_guard.template AsMut<LeafPage>();
+      new_leaf->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+      KeyType separator = key;
+      if (leaf != nullptr) {
+        separator = comparator_.Separator(leaf->KeyAt(leaf->GetSize() - 1), key);
+        leaf->SetNextPageId(page_id);
+        leaf->SetHighKey(separator);
+      }
+      leaves->emplace_back(separator, page_id);
+      guard = std::move(new_guard);
+      leaf = new_leaf;
+    }
+    leaf->Insert(key, value, comparator_);
+    num_pairs++;
+  }
+
+  if (leaves->size() < 2 || leaf->GetSize() >= min_size) {
+    return num_pairs;
+  }
+  BasicPageGuard prev_guard = buffer_pool_manager_->FetchPageBasic((*leaves)[leaves->size() - 2].second);
+  if (prev_guard.IsEmpty()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+  }
+  auto *prev = prev_guard.template AsMut<LeafPage>();
+  if (prev->GetSize() + leaf->GetSize() <= max_size && leaf->CanMoveAllTo(prev)) {
+    leaf->MoveAllTo(prev);
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(leaves->back().second);
+    pages->pop_back();
+    leaves->pop_back();
+  } else {
+    while (prev->GetSize() > leaf->GetSize() + 1 && leaf->CanInsert(prev->KeyAt(prev->GetSize() - 1))) {
+      prev->MoveLastToFrontOf(leaf);
+    }
+    KeyType separator = comparator_.Separator(prev->KeyAt(prev->GetSize() - 1), leaf->KeyAt(0));
+    prev->SetHighKey(separator);
+    leaves->back().first = separator;
+  }
+  return num_pairs;
+}
+
+/*
+ * The last page is evened out with the one before it as for the leaves.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<std::pair<KeyType, page_id_t>> BPLUSTREE_TYPE::BulkLoadLevel(
+    const std::vector<std::pair<KeyType, page_id_t>> &children, double fill_factor, std::vector<page_id_t> *pages) {
+  int min_size = (internal_max_size_ + 1) / 2;
+  int fill_size = std::clamp(static_cast<int>(fill_factor * internal_max_size_), min_size, internal_max_size_);
+
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  BasicPageGuard prev_guard;
+  InternalPage *prev = nullptr;
+  BasicPageGuard guard;
+  InternalPage *node = nullptr;
+  for (const auto &[key, child_id] : children) {
+    if (node != nullptr && node->GetSize() < fill_size && node->CanInsert(key)) {
+      node->Insert(key, child_id, comparator_);
+      continue;
+    }
+    page_id_t page_id;
+    BasicPageGuard new_guard = NewTreePage(&page_id);
+    pages->push_back(page_id);
+    auto *new_node = new_guard.template AsMut<InternalPage>();
+    new_node->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+    new_node->SetKeyAt(0, key);
+    new_node->SetValueAt(0, child_id);
+    if (node != nullptr) {
+      node->SetNextPageId(page_id);
+      node->SetHighKey(key);
+    }
+    level.emplace_back(key, page_id);
+    prev_guard = std::move(guard);
+    prev = node;
+    guard = std::move(new_guard);
+    node = new_node;
+  }
+
+  if (prev == nullptr || node->GetSize() >= node->GetMinSize()) {
+    return level;
+  }
+  // The separator before the last page is its first key, which comes down in front of its first child.
+  KeyType middle_key = node->KeyAt(0);
+  if (prev->GetSize() + node->GetSize() <= internal_max_size_ && node->CanMoveAllTo(prev, middle_key)) {
+    node->MoveAllTo(prev, middle_key);
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(level.back().second);
+    pages->pop_back();
+    level.pop_back();
+  } else {
+    while (prev->GetSize() > node->GetSize() + 1 && prev->CanMoveLastToFrontOf(node, node->KeyAt(0))) {
+      prev->MoveLastToFrontOf(node, node->KeyAt(0));
+    }
+    prev->SetHighKey(node->KeyAt(0));
+    level.back().first = node->KeyAt(0);
+  }
+  return level;
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,53 +541,247 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (latching_ == BPlusTreeLatching::B_LINK) {
+    RemoveBLink(key);
+    return;
+  }
+
+  // As for Insert, first try with nothing but the leaf latched for writing.
+  bool is_root;
+  Page *page = FindLeafOptimistic(key, &is_root);
+  if (page == nullptr) {
+    return;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType value;
+  bool exists = leaf->Lookup(key, value, comparator_);
+  bool is_safe = exists && IsSafe(leaf, Operation::REMOVE, is_root, key);
+  if (is_safe) {
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), is_safe);
+  if (!exists || is_safe) {
+    return;
+  }
+
+  std::unique_ptr<Transaction> local_transaction;
+  if (transaction == nullptr) {
+    local_transaction = std::make_unique<Transaction>(INVALID_TXN_ID);
+    transaction = local_transaction.get();
+  }
+  RemoveFromLeaf(key, transaction);
+}
+
+/*
+ * Delete key & value pair from its leaf page, holding the write latches of
+ * every page the removal may merge or redistribute. This is the pessimistic
+ * pass of Remove, for when the leaf would underflow.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveFromLeaf(const KeyType &key, Transaction *transaction) {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    ReleasePageSet(transaction, false);
+    return;
+  }
+
+  Page *page = FindLeafPessimistic(key, Operation::REMOVE, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int old_size = leaf->GetSize();
+  if (leaf->RemoveAndDeleteRecord(key, comparator_) == old_size) {
+    ReleasePageSet(transaction, false);
+    return;
+  }
+  CoalesceOrRedistribute(leaf, transaction);
+  ReleasePageSet(transaction, true);
+  DeletePages(transaction);
+}
+
+/*
+ * Delete key & value pair in B-link mode. Only the leaf is latched for
+ * writing, and it stays in place however few entries it has left.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBLink(const KeyType &key) {
+  ReadPageGuard read_guard = FindLeafRead(key, false);
+  if (read_guard.IsEmpty()) {
+    return;
+  }
+  page_id_t leaf_id = read_guard.PageId();
+  read_guard.Drop();
+
+  WritePageGuard guard = buffer_pool_manager_->FetchPageWrite(leaf_id);
+  MoveRight(&guard, key);
+  ValueType value;
+  if (guard.template As<LeafPage>()->Lookup(key, value, comparator_)) {
+    guard.template AsMut<LeafPage>()->RemoveAndDeleteRecord(key, comparator_);
+  }
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
- * page's size > page's max size, then redistribute. Otherwise, merge.
+ * page's size > page's max size, or the keys of the two do not fit into one,
+ * then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
  * @return: true means target leaf page should be deleted, false means no
- * deletion happens
+ * deletion happens. Deleted pages go into the deleted page set.
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+  Page *parent_page;
+  if (!FindParentPage(node->GetPageId(), transaction, &parent_page)) {
+    // Only the root may be safe and below its min size.
+    return false;
+  }
+  if (parent_page == nullptr) {
+    if (AdjustRoot(node)) {
+      transaction->AddIntoDeletedPageSet(node->GetPageId());
+      return true;
+    }
+    return false;
+  }
+
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  if (parent->GetSize() == 1) {
+    // A page left underfull when its keys fit neither into a neighbour nor into its parent may be down to one child.
+    return false;
+  }
+  int index = parent->ValueIndex(node->GetPageId());
+  Page *neighbor_page = FetchTreePage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  if (index > 0) {
+    // Latch the left neighbour before the node, in the order in which scans latch leaves. Nothing else can get to
+    // the node meanwhile, since its parent is write-latched.
+    auto page_set = transaction->GetPageSet();
+    Page *node_page = *std::find_if(page_set->begin(), page_set->end(), [node](Page *page) {
+      return page != nullptr && page->GetPageId() == node->GetPageId();
+    });
+    node_page->WUnlatch();
+    neighbor_page->WLatch();
+    node_page->WLatch();
+  } else {
+    neighbor_page->WLatch();
+  }
+  transaction->AddIntoPageSet(neighbor_page);
+
+  auto *neighbor = reinterpret_cast<N *>(neighbor_page->GetData());
+  // A leaf must stay below its max size, an internal page may fill up to it, and the keys must fit either way.
+  int max_merged_size = node->IsLeafPage() ? node->GetMaxSize() - 1 : node->GetMaxSize();
+  N *left = index == 0 ? node : neighbor;
+  N *right = index == 0 ? neighbor : node;
+  bool fits;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    fits = right->CanMoveAllTo(left);
+  } else {
+    fits = right->CanMoveAllTo(left, parent->KeyAt(index == 0 ? 1 : index));
+  }
+  if (node->GetSize() + neighbor->GetSize() <= max_merged_size && fits) {
+    Coalesce(&neighbor, &node, &parent, index, transaction);
+    return index > 0;
+  }
+  Redistribute(neighbor, node, parent, index);
   return false;
 }
 
 /*
- * Move all the key & value pairs from one page to its sibling page, and notify
- * buffer pool manager to delete this page. Parent page must be adjusted to
+ * Move all the key & value pairs from the right one of the two pages into the
+ * left one, and mark the right one deleted. Parent page must be adjusted to
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
+ * @param   index              index of "node" in "parent"; the neighbor is on
+ *                             its right if it is 0, on its left otherwise
  * @return  true means parent node should be deleted, false means no deletion
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
-                              BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
+bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node, InternalPage **parent, int index,
                               Transaction *transaction) {
-  return false;
+  // Merging to the left means that the leaf chain only ever loses the page that a still latched leaf points to.
+  N *left = index == 0 ? *node : *neighbor_node;
+  N *right = index == 0 ? *neighbor_node : *node;
+  int right_index = index == 0 ? 1 : index;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    right->MoveAllTo(left);
+  } else {
+    right->MoveAllTo(left, (*parent)->KeyAt(right_index));
+  }
+  transaction->AddIntoDeletedPageSet(right->GetPageId());
+  (*parent)->Remove(right_index);
+  // The parent may have to latch a neighbour of its own. Still holding our leaf then could close a cycle: an optimistic
+  // writer that has that neighbour read-latched waits for a leaf below it, which a scan holds while it waits for ours.
+  ReleasePagesBelow((*parent)->GetPageId(), transaction);
+  return CoalesceOrRedistribute(*parent, transaction);
 }
 
 /*
  * Redistribute key & value pairs from one page to its sibling page. If index ==
  * 0, move sibling page's first key & value pair into end of input "node",
  * otherwise move sibling page's last key & value pair into head of input
- * "node".
+ * "node". Either way the key that moves up into the parent ends up first in the
+ * page on the right, or for leaves, is the shortest key between the two.
+ * Nothing moves if the neighbour has nothing to spare, or if a key that would
+ * move does not fit where it would go; "node" stays below its min size then.
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of input "node"
+ * @param   index              index of "node" in "parent"
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, InternalPage *parent, int index) {
+  if (neighbor_node->GetSize() <= neighbor_node->GetMinSize()) {
+    return;
+  }
+  int last = neighbor_node->GetSize() - 1;
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      KeyType separator = comparator_.Separator(neighbor_node->KeyAt(0), neighbor_node->KeyAt(1));
+      if (!node->CanInsert(neighbor_node->KeyAt(0)) || !parent->CanSetKey(separator)) {
+        return;
+      }
+      neighbor_node->MoveFirstToEndOf(node);
+      parent->SetKeyAt(1, separator);
+      node->SetHighKey(separator);
+    } else {
+      if (!node->CanInsert(parent->KeyAt(1)) || !parent->CanSetKey(neighbor_node->KeyAt(1))) {
+        return;
+      }
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1));
+      parent->SetKeyAt(1, neighbor_node->KeyAt(0));
+      node->SetHighKey(neighbor_node->KeyAt(0));
+    }
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      KeyType separator = comparator_.Separator(neighbor_node->KeyAt(last - 1), neighbor_node->KeyAt(last));
+      if (!node->CanInsert(neighbor_node->KeyAt(last)) || !parent->CanSetKey(separator)) {
+        return;
+      }
+      neighbor_node->MoveLastToFrontOf(node);
+      parent->SetKeyAt(index, separator);
+      neighbor_node->SetHighKey(separator);
+    } else {
+      if (!neighbor_node->CanMoveLastToFrontOf(node, parent->KeyAt(index)) ||
+          !parent->CanSetKey(neighbor_node->KeyAt(last))) {
+        return;
+      }
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index));
+      parent->SetKeyAt(index, node->KeyAt(0));
+      neighbor_node->SetHighKey(node->KeyAt(0));
+    }
+  }
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +793,21 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (!old_root_node->IsLeafPage() && old_root_node->GetSize() == 1) {
+    root_page_id_ = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+    height_--;
+    UpdateRootPageId();
+    return true;
+  }
+  if (old_root_node->IsLeafPage() && old_root_node->GetSize() == 0) {
+    root_page_id_ = INVALID_PAGE_ID;
+    height_ = 0;
+    UpdateRootPageId();
+    return true;
+  }
+  return false;
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +818,13 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
+  ReadPageGuard guard = FindLeafRead(KeyType(), true);
+  if (guard.IsEmpty()) {
+    return INDEXITERATOR_TYPE();
+  }
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, std::move(guard), 0);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +832,14 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  ReadPageGuard guard = FindLeafRead(key, false);
+  if (guard.IsEmpty()) {
+    return INDEXITERATOR_TYPE();
+  }
+  int index = guard.template As<LeafPage>()->KeyIndex(key, comparator_);
+  return INDEXITERATOR_TYPE(buffer_pool_manager_, std::move(guard), index);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -209,10 +855,255 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(); }
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
+ * @return : the leaf, pinned but not latched, or nullptr if the tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  ReadPageGuard guard = FindLeafRead(key, leftMost);
+  if (guard.IsEmpty()) {
+    return nullptr;
+  }
+  // A pin of its own for the caller, who outlives the guard.
+  return FetchTreePage(guard.PageId());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchTreePage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BasicPageGuard BPLUSTREE_TYPE::NewTreePage(page_id_t *page_id) {
+  BasicPageGuard guard = buffer_pool_manager_->NewPageInExtent(page_id, &extent_allocator_);
+  if (guard.IsEmpty()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a new page of the index");
+  }
+  return guard;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+ReadPageGuard BPLUSTREE_TYPE::FindLeafRead(const KeyType &key, bool left_most, std::vector<page_id_t> *path) {
+  bool b_link = latching_ == BPlusTreeLatching::B_LINK;
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return {};
+  }
+  page_id_t root_page_id = root_page_id_;
+  ReadPageGuard guard;
+  if (!b_link) {
+    guard = buffer_pool_manager_->FetchPageRead(root_page_id);
+  }
+  root_latch_.RUnlock();
+  if (b_link) {
+    // Pages are never freed in B-link mode, and a root that is no longer the root still leads to every key of its
+    // level through the right links.
+    guard = buffer_pool_manager_->FetchPageRead(root_page_id);
+  }
+
+  while (!guard.IsEmpty()) {
+    if (b_link && !left_most) {
+      MoveRight(&guard, key);
+    }
+    auto *node = guard.template As<BPlusTreePage>();
+    if (node->IsLeafPage()) {
+      return guard;
+    }
+    auto *inner = reinterpret_cast<const InternalPage *>(node);
+    page_id_t child_id = left_most ? inner->ValueAt(0) : inner->Lookup(key, comparator_);
+    if (path != nullptr) {
+      path->push_back(guard.PageId());
+    }
+    if (b_link) {
+      guard.Drop();
+    }
+    // Without B-link, the child is latched before the assignment lets go of its parent.
+    ReadPageGuard child = buffer_pool_manager_->FetchPageRead(child_id);
+    guard = std::move(child);
+  }
+  throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::RightOf(const BPlusTreePage *node, const KeyType &key) const {
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<const LeafPage *>(node);
+    return leaf->IsPastHighKey(key, comparator_) ? leaf->GetNextPageId() : INVALID_PAGE_ID;
+  }
+  auto *inner = reinterpret_cast<const InternalPage *>(node);
+  return inner->IsPastHighKey(key, comparator_) ? inner->GetNextPageId() : INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename Guard>
+void BPLUSTREE_TYPE::MoveRight(Guard *guard, const KeyType &key) {
+  while (true) {
+    if (guard->IsEmpty()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+    }
+    page_id_t next_page_id = RightOf(guard->template As<BPlusTreePage>(), key);
+    if (next_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    // Only one latch at a time: the page to the right cannot go away, since pages are never freed in B-link mode.
+    guard->Drop();
+    if constexpr (std::is_same_v<Guard, ReadPageGuard>) {
+      *guard = buffer_pool_manager_->FetchPageRead(next_page_id);
+    } else {
+      *guard = buffer_pool_manager_->FetchPageWrite(next_page_id);
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::FindPageAtLevel(page_id_t page_id, int level, int target_level, const KeyType &key) {
+  BUSTUB_ASSERT(target_level > 0 && level >= target_level, "The page looked for is an internal page below the root.");
+  while (level > target_level) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id);
+    MoveRight(&guard, key);
+    page_id = guard.template As<InternalPage>()->Lookup(key, comparator_);
+    level--;
+  }
+  return page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, bool *is_root) {
+  root_latch_.RLock();
+  if (root_page_id_ == INVALID_PAGE_ID) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+  if (page == nullptr) {
+    root_latch_.RUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+  }
+
+  // Every page is read-latched first, and a leaf is then latched again for writing while its parent, or the root
+  // latch for the root, keeps it from being split or merged meanwhile.
+  *is_root = true;
+  page->RLatch();
+  if (reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+    page->RUnlatch();
+    page->WLatch();
+    root_latch_.RUnlock();
+    return page;
+  }
+  root_latch_.RUnlock();
+
+  *is_root = false;
+  while (true) {
+    auto *inner = reinterpret_cast<InternalPage *>(page->GetData());
+    Page *child = buffer_pool_manager_->FetchPage(inner->Lookup(key, comparator_));
+    if (child == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of the index");
+    }
+    child->RLatch();
+    bool is_leaf = reinterpret_cast<BPlusTreePage *>(child->GetData())->IsLeafPage();
+    if (is_leaf) {
+      child->RUnlatch();
+      child->WLatch();
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (is_leaf) {
+      return child;
+    }
+    page = child;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPessimistic(const KeyType &key, Operation op, Transaction *transaction) {
+  page_id_t page_id = root_page_id_;
+  bool is_root = true;
+  while (true) {
+    Page *page = FetchTreePage(page_id);
+    page->WLatch();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, op, is_root, key)) {
+      ReleasePageSet(transaction, false);
+    }
+    transaction->AddIntoPageSet(page);
+    if (node->IsLeafPage()) {
+      return page;
+    }
+    page_id = reinterpret_cast<InternalPage *>(node)->Lookup(key, comparator_);
+    is_root = false;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(const BPlusTreePage *node, Operation op, bool is_root, const KeyType &key) const {
+  auto *leaf = reinterpret_cast<const LeafPage *>(node);
+  auto *inner = reinterpret_cast<const InternalPage *>(node);
+  if (op == Operation::INSERT) {
+    // A leaf splits when it fills up, an internal page when it takes one child more than its max size, and either when
+    // the key that comes in does not fit. Only the leaf knows which key that is.
+    return node->IsLeafPage() ? node->GetSize() + 1 < node->GetMaxSize() && leaf->CanInsert(key)
+                              : node->GetSize() < node->GetMaxSize() && inner->CanInsertAnyKey();
+  }
+  if (is_root) {
+    // The root goes away when it loses its last entry, or its second last child.
+    return node->IsLeafPage() ? node->GetSize() > 1 : node->GetSize() > 2;
+  }
+  return node->GetSize() > (node->IsLeafPage() ? leaf->GetMinSize() : inner->GetMinSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindParentPage(page_id_t page_id, Transaction *transaction, Page **parent) const {
+  auto page_set = transaction->GetPageSet();
+  auto it = std::find_if(page_set->begin(), page_set->end(),
+                         [page_id](Page *page) { return page != nullptr && page->GetPageId() == page_id; });
+  BUSTUB_ASSERT(it != page_set->end(), "the page must be in the page set");
+  if (it == page_set->begin()) {
+    return false;
+  }
+  *parent = *std::prev(it);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePageSet(Transaction *transaction, bool is_dirty) {
+  auto page_set = transaction->GetPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  page_set->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePagesBelow(page_id_t page_id, Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  auto it = std::find_if(page_set->begin(), page_set->end(),
+                         [page_id](Page *page) { return page != nullptr && page->GetPageId() == page_id; });
+  BUSTUB_ASSERT(it != page_set->end(), "the page must be in the page set");
+  for (auto below = std::next(it); below != page_set->end(); ++below) {
+    (*below)->WUnlatch();
+    buffer_pool_manager_->UnpinPage((*below)->GetPageId(), true);
+  }
+  page_set->erase(std::next(it), page_set->end());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(Transaction *transaction) {
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (page_id_t page_id : *deleted_page_set) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  deleted_page_set->clear();
 }
 
 /*
@@ -225,15 +1116,14 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
-    // update root_page_id in header_page
+  auto guard = buffer_pool_manager_->FetchPageWrite(HEADER_PAGE_ID);
+  auto header_page = static_cast<HeaderPage *>(guard.GetPage());
+  guard.SetDirty();
+  // create a new record<index_name + root_page_id> in header_page, or update
+  // the one that is left from before the tree was emptied
+  if (insert_record == 0 || !header_page->InsertRecord(index_name_, root_page_id_)) {
     header_page->UpdateRecord(index_name_, root_page_id_);
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
 }
 
 /*
@@ -306,12 +1196,6 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
       out << leaf_prefix << leaf->GetPageId() << " -> " << leaf_prefix << leaf->GetNextPageId() << ";\n";
       out << "{rank=same " << leaf_prefix << leaf->GetPageId() << " " << leaf_prefix << leaf->GetNextPageId() << "};\n";
     }
-
-    // Print parent links if there is a parent
-    if (leaf->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << leaf->GetParentPageId() << ":p" << leaf->GetPageId() << " -> " << leaf_prefix
-          << leaf->GetPageId() << ";\n";
-    }
   } else {
     InternalPage *inner = reinterpret_cast<InternalPage *>(page);
     // Print node name
@@ -337,14 +1221,12 @@ void BPLUSTREE_TYPE::ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::o
     out << "</TR>";
     // Print table end
     out << "</TABLE>>];\n";
-    // Print Parent link
-    if (inner->GetParentPageId() != INVALID_PAGE_ID) {
-      out << internal_prefix << inner->GetParentPageId() << ":p" << inner->GetPageId() << " -> " << internal_prefix
-          << inner->GetPageId() << ";\n";
-    }
     // Print leaves
     for (int i = 0; i < inner->GetSize(); i++) {
       auto child_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i))->GetData());
+      // Print the link to the child, from here since pages do not keep their parent page id up to date
+      out << internal_prefix << inner->GetPageId() << ":p" << child_page->GetPageId() << " -> "
+          << (child_page->IsLeafPage() ? leaf_prefix : internal_prefix) << child_page->GetPageId() << ";\n";
       ToGraph(child_page, bpm, out);
       if (i > 0) {
         auto sibling_page = reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(inner->ValueAt(i - 1))->GetData());
@@ -371,8 +1253,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const {
   if (page->IsLeafPage()) {
     LeafPage *leaf = reinterpret_cast<LeafPage *>(page);
-    std::cout << "Leaf Page: " << leaf->GetPageId() << " parent: " << leaf->GetParentPageId()
-              << " next: " << leaf->GetNextPageId() << std::endl;
+    std::cout << "Leaf Page: " << leaf->GetPageId() << " next: " << leaf->GetNextPageId() << std::endl;
     for (int i = 0; i < leaf->GetSize(); i++) {
       std::cout << leaf->KeyAt(i) << ",";
     }
@@ -380,7 +1261,7 @@ void BPLUSTREE_TYPE::ToString(BPlusTreePage *page, BufferPoolManager *bpm) const
     std::cout << std::endl;
   } else {
     InternalPage *internal = reinterpret_cast<InternalPage *>(page);
-    std::cout << "Internal Page: " << internal->GetPageId() << " parent: " << internal->GetParentPageId() << std::endl;
+    std::cout << "Internal Page: " << internal->GetPageId() << std::endl;
     for (int i = 0; i < internal->GetSize(); i++) {
       std::cout << internal->KeyAt(i) << ": " << internal->ValueAt(i) << ",";
     }
@@ -398,5 +1279,12 @@ template class BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTree<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTree<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTree<GenericKey<4>, RID, IntegerComparator<4>>;
+template class BPlusTree<GenericKey<8>, RID, IntegerComparator<8>>;
+template class BPlusTree<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTree<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTree<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTree<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTree<GenericKey<64>, RID, MemcmpComparator<64>>;
 
 }  // namespace bustub
@@ -11,6 +11,11 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <algorithm>
+
+#include "buffer/buffer_access_strategy.h"
+#include "storage/index/external_merge_sort.h"
+
 namespace bustub {
 /*
  * Constructor
@@ -18,6 +23,7 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
+      buffer_pool_manager_(buffer_pool_manager),
       comparator_(metadata->GetKeySchema()),
       container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
 
@@ -25,7 +31,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +40,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +49,31 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_INDEX_TYPE::BuildFromTable(TableHeap *table, const Schema &schema, Transaction *transaction,
+                                            double fill_factor) {
+  // The sort may pin as many pages as it holds in memory, which must leave room for everybody else.
+  size_t memory_pages = std::min<size_t>(EXTERNAL_SORT_MEMORY_PAGES, buffer_pool_manager_->GetPoolSize() / 4);
+  ExternalMergeSort<KeyType, ValueType, KeyComparator> sort(buffer_pool_manager_, comparator_, memory_pages);
+  {
+    // The scan reads every page of the table once, so it is kept to a ring of frames like a sequential scan.
+    BufferAccessStrategy strategy(SEQ_SCAN_RING_SIZE);
+    for (auto it = table->Begin(transaction, TABLE_SCAN_PREFETCH_WINDOW, &strategy); it != table->End(); ++it) {
+      KeyType index_key;
+      SetIndexKey<KeyComparator>(&index_key, it->KeyFromTuple(schema, *GetKeySchema(), GetKeyAttrs()), GetKeySchema());
+      sort.Add(index_key, it->GetRid());
+    }
+  }
+  sort.Finish();
+  return container_.BulkLoad([&sort](KeyType *key, ValueType *value) { return sort.Next(key, value); },
+                             fill_factor);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.begin(); }
 
@@ -62,5 +88,12 @@ template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeIndex<GenericKey<4>, RID, IntegerComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, IntegerComparator<8>>;
+template class BPlusTreeIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTreeIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTreeIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTreeIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTreeIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
 
 }  // namespace bustub
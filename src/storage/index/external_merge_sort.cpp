@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_merge_sort.cpp
+//
+// Identification: src/storage/index/external_merge_sort.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/external_merge_sort.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_MERGE_SORT_TYPE::ExternalMergeSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+                                            size_t memory_pages)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      // A merge needs at least two runs to read and one to write.
+      memory_pages_(std::max<size_t>(memory_pages, 3)),
+      strategy_(memory_pages_) {
+  buffer_.reserve(memory_pages_ * RUN_PAGE_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+EXTERNAL_MERGE_SORT_TYPE::~ExternalMergeSort() {
+  for (auto &reader : merge_.readers_) {
+    if (!reader.guard_.IsEmpty()) {
+      page_id_t page_id = reader.guard_.PageId();
+      reader.guard_.Drop();
+      DeleteRun(page_id);
+    }
+  }
+  for (page_id_t page_id : runs_) {
+    DeleteRun(page_id);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!finished_, "the input has ended");
+  buffer_.emplace_back(key, value);
+  if (buffer_.size() == memory_pages_ * RUN_PAGE_SIZE) {
+    WriteRun();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::Finish() {
+  finished_ = true;
+  if (runs_.empty()) {
+    std::sort(buffer_.begin(), buffer_.end(),
+              [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+    return;
+  }
+  if (!buffer_.empty()) {
+    WriteRun();
+  }
+  // The final merge has no run to write, so it can read one more run than the others.
+  while (runs_.size() > memory_pages_) {
+    MergeRuns(memory_pages_ - 1);
+  }
+  OpenMerge(runs_.size());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_MERGE_SORT_TYPE::Next(KeyType *key, ValueType *value) {
+  BUSTUB_ASSERT(finished_, "the input has not ended");
+  MappingType pair;
+  if (num_runs_written_ > 0) {
+    if (!NextFromMerge(&pair)) {
+      return false;
+    }
+  } else {
+    if (buffer_index_ == buffer_.size()) {
+      return false;
+    }
+    pair = buffer_[buffer_index_++];
+  }
+  *key = pair.first;
+  *value = pair.second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::WriteRun() {
+  std::sort(buffer_.begin(), buffer_.end(),
+            [this](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+  RunWriter writer;
+  for (const auto &pair : buffer_) {
+    Append(&writer, pair);
+  }
+  writer.guard_.Drop();
+  runs_.push_back(writer.first_page_id_);
+  num_runs_written_++;
+  buffer_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::MergeRuns(size_t num_runs) {
+  OpenMerge(num_runs);
+  RunWriter writer;
+  MappingType pair;
+  while (NextFromMerge(&pair)) {
+    Append(&writer, pair);
+  }
+  writer.guard_.Drop();
+  runs_.push_back(writer.first_page_id_);
+  num_runs_written_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::OpenMerge(size_t num_runs) {
+  merge_.readers_.clear();
+  merge_.heap_.clear();
+  for (size_t i = 0; i < num_runs; i++) {
+    page_id_t page_id = runs_.front();
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id, &strategy_);
+    if (guard.IsEmpty()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of a sort run");
+    }
+    runs_.pop_front();
+    merge_.readers_.push_back({std::move(guard), 0});
+    merge_.heap_.push_back(i);
+  }
+  std::make_heap(merge_.heap_.begin(), merge_.heap_.end(), [this](size_t a, size_t b) { return IsAfter(a, b); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_MERGE_SORT_TYPE::IsAfter(size_t a, size_t b) const {
+  const RunReader &reader_a = merge_.readers_[a];
+  const RunReader &reader_b = merge_.readers_[b];
+  return comparator_(reader_a.guard_.template As<RunPage>()->array_[reader_a.index_].first,
+                     reader_b.guard_.template As<RunPage>()->array_[reader_b.index_].first) > 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_MERGE_SORT_TYPE::NextFromMerge(MappingType *pair) {
+  auto &heap = merge_.heap_;
+  if (heap.empty()) {
+    return false;
+  }
+  auto greater = [this](size_t a, size_t b) { return IsAfter(a, b); };
+  std::pop_heap(heap.begin(), heap.end(), greater);
+  RunReader &reader = merge_.readers_[heap.back()];
+  *pair = reader.guard_.template As<RunPage>()->array_[reader.index_];
+  if (Advance(&reader)) {
+    std::push_heap(heap.begin(), heap.end(), greater);
+  } else {
+    heap.pop_back();
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool EXTERNAL_MERGE_SORT_TYPE::Advance(RunReader *reader) {
+  reader->index_++;
+  auto *page = reader->guard_.template As<RunPage>();
+  if (reader->index_ < page->size_) {
+    return true;
+  }
+  page_id_t page_id = reader->guard_.PageId();
+  page_id_t next_page_id = page->next_page_id_;
+  reader->guard_.Drop();
+  buffer_pool_manager_->DeletePage(page_id);
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  reader->guard_ = buffer_pool_manager_->FetchPageRead(next_page_id, &strategy_);
+  if (reader->guard_.IsEmpty()) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of a sort run");
+  }
+  reader->index_ = 0;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::Append(RunWriter *writer, const MappingType &pair) {
+  RunPage *page = writer->guard_.IsEmpty() ? nullptr : writer->guard_.template AsMut<RunPage>();
+  if (page == nullptr || static_cast<size_t>(page->size_) == RUN_PAGE_SIZE) {
+    page_id_t page_id;
+    BasicPageGuard guard = buffer_pool_manager_->NewPageGuarded(&page_id, &strategy_);
+    if (guard.IsEmpty()) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for a page of a sort run");
+    }
+    auto *new_page = guard.template AsMut<RunPage>();
+    new_page->next_page_id_ = INVALID_PAGE_ID;
+    new_page->size_ = 0;
+    if (page == nullptr) {
+      writer->first_page_id_ = page_id;
+    } else {
+      page->next_page_id_ = page_id;
+    }
+    writer->guard_ = std::move(guard);
+    page = new_page;
+  }
+  page->array_[page->size_++] = pair;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void EXTERNAL_MERGE_SORT_TYPE::DeleteRun(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    ReadPageGuard guard = buffer_pool_manager_->FetchPageRead(page_id, &strategy_);
+    if (guard.IsEmpty()) {
+      // The rest of the run stays allocated.
+      return;
+    }
+    page_id_t next_page_id = guard.template As<RunPage>()->next_page_id_;
+    guard.Drop();
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+template class ExternalMergeSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalMergeSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalMergeSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalMergeSort<GenericKey<64>, RID, GenericComparator<64>>;
+template class ExternalMergeSort<GenericKey<4>, RID, IntegerComparator<4>>;
+template class ExternalMergeSort<GenericKey<8>, RID, IntegerComparator<8>>;
+template class ExternalMergeSort<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class ExternalMergeSort<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class ExternalMergeSort<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class ExternalMergeSort<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class ExternalMergeSort<GenericKey<64>, RID, MemcmpComparator<64>>;
+
+}  // namespace bustub
@@ -2,29 +2,69 @@
  * index_iterator.cpp
  */
 #include <cassert>
+#include <utility>
 
+#include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
 
-/*
- * NOTE: you can change the destructor/constructor method here
- * set your own input parameters
- */
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, ReadPageGuard leaf, int index)
+    : bpm_(bpm), leaf_guard_(std::move(leaf)), index_(index) {
+  SkipToValidEntry();
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-bool INDEXITERATOR_TYPE::isEnd() { throw std::runtime_error("unimplemented"); }
+bool INDEXITERATOR_TYPE::isEnd() { return leaf_guard_.IsEmpty(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+const MappingType &INDEXITERATOR_TYPE::operator*() {
+  assert(!isEnd());
+  item_ = leaf_guard_.template As<LeafPage>()->GetItem(index_);
+  return item_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
+  assert(!isEnd());
+  index_++;
+  SkipToValidEntry();
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &INDEXITERATOR_TYPE::operator*() { throw std::runtime_error("unimplemented"); }
+bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
+  if (leaf_guard_.IsEmpty() || itr.leaf_guard_.IsEmpty()) {
+    return leaf_guard_.IsEmpty() && itr.leaf_guard_.IsEmpty();
+  }
+  return leaf_guard_.PageId() == itr.leaf_guard_.PageId() && index_ == itr.index_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() { throw std::runtime_error("unimplemented"); }
+void INDEXITERATOR_TYPE::SkipToValidEntry() {
+  while (!leaf_guard_.IsEmpty() && index_ >= leaf_guard_.template As<LeafPage>()->GetSize()) {
+    page_id_t next_page_id = leaf_guard_.template As<LeafPage>()->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      leaf_guard_.Drop();
+    } else {
+      // The next leaf is latched before the assignment lets go of this one.
+      ReadPageGuard next = bpm_->FetchPageRead(next_page_id);
+      if (next.IsEmpty()) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "no frame for the next leaf of the index");
+      }
+      leaf_guard_ = std::move(next);
+    }
+    index_ = 0;
+  }
+}
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
@@ -35,5 +75,12 @@ template class IndexIterator<GenericKey<16>, RID, GenericComparator<16>>;
 template class IndexIterator<GenericKey<32>, RID, GenericComparator<32>>;
 
 template class IndexIterator<GenericKey<64>, RID, GenericComparator<64>>;
+template class IndexIterator<GenericKey<4>, RID, IntegerComparator<4>>;
+template class IndexIterator<GenericKey<8>, RID, IntegerComparator<8>>;
+template class IndexIterator<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class IndexIterator<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class IndexIterator<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class IndexIterator<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class IndexIterator<GenericKey<64>, RID, MemcmpComparator<64>>;
 
 }  // namespace bustub
@@ -17,7 +17,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.Insert(transaction, index_key, rid);
 }
@@ -26,7 +26,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -35,7 +35,7 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey<KeyComparator>(&index_key, key, GetKeySchema());
 
   container_.GetValue(transaction, index_key, result);
 }
@@ -44,5 +44,10 @@ template class LinearProbeHashTableIndex<GenericKey<8>, RID, GenericComparator<8
 template class LinearProbeHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class LinearProbeHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class LinearProbeHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
+template class LinearProbeHashTableIndex<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class LinearProbeHashTableIndex<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class LinearProbeHashTableIndex<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class LinearProbeHashTableIndex<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class LinearProbeHashTableIndex<GenericKey<64>, RID, MemcmpComparator<64>>;
 
 }  // namespace bustub
@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -26,14 +28,50 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  static_assert(sizeof(BPlusTreeInternalPage) == INTERNAL_PAGE_HEADER_SIZE, "the entries take up the rest of the page");
 
   this->SetPageType(IndexPageType::INTERNAL_PAGE);
+  array_.Insert(0, KeyType{}, ValueType{}, 0);
   this->SetSize(1);// setting current size = 1 for the first invalid key..
   this->SetPageId(page_id);
   this->SetParentPageId(parent_id);
 
   //this has to be verified later.. 
   this->SetMaxSize(max_size);
+  this->SetNextPageId(INVALID_PAGE_ID);
+}
+
+/*
+ * Helper methods to get/set the next page on this level, and the key that
+ * separates this page from it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const {
+  return next_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
+  next_page_id_ = next_page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const {
+  assert(next_page_id_ != INVALID_PAGE_ID);
+  return high_key_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &high_key) {
+  high_key_ = high_key;
+}
+
+/*
+ * @return true if the key belongs to a page to the right of this one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsPastHighKey(const KeyType &key, const KeyComparator &comparator) const {
+  return next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0;
 }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
@@ -43,286 +81,291 @@ INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
   // replace with your own code
   assert(0<=index && index < GetSize());
-  return array[index].first;
+  return array_.KeyAt(index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
 
   assert(0<=index && index < GetSize());
-  array[index].first = key;
+  array_.SetKeyAt(index, key, GetSize());
 }
 
-
+/*
+ * An internal page of keys that have nothing in common holds
+ * INTERNAL_PAGE_SLOTS entries, so it counts as underfull below half of that,
+ * however large its max size.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetMinSize() const {
+  return std::min<int>(BPlusTreePage::GetMinSize(), INTERNAL_PAGE_SLOTS / 2);
+}
 
-  int n = GetSize();
-  for(int i=1;i<n;i++){
-    if(array[i].second==value){
-      return i;
-    }
-  }
-  return n;
+/*
+ * @return true if the entries still fit into the page once key is added
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsert(const KeyType &key) const {
+  return KeyArray::Fits(GetSize() + 1, array_.WidthWith(GetSize(), {key}));
 }
 
+/*
+ * @return true if the entries still fit into the page once a key is added,
+ * whatever it is
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanInsertAnyKey() const {
+  return KeyArray::Fits(GetSize() + 1, sizeof(KeyType));
+}
 
+/*
+ * @return true if the entries still fit into the page once one of its keys is
+ * set to key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanSetKey(const KeyType &key) const {
+  return KeyArray::Fits(GetSize(), array_.WidthWith(GetSize(), {key}));
+}
 
+/*
+ * @return true if the entries of both pages, and the middle key that comes
+ * down with them, fit into "recipient"
+ */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { 
-  assert(0<=index && index < GetSize());
-  return array[index].second;
- }
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveAllTo(const BPlusTreeInternalPage *recipient,
+                                                  const KeyType &middle_key) const {
+  int size = recipient->GetSize() + GetSize();
+  return KeyArray::Fits(size, recipient->array_.WidthWith(recipient->GetSize(), array_, GetSize(), {middle_key}));
+}
 
-template <typename KeyType, typename ValueType, typename KeyComparator>
-void BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>::
-SetValueAt(int index, const ValueType &value) {
-  assert(0 <= index && index < GetSize());
-  array[index].second = value;
+/*
+ * @return true if "recipient" can take the last entry of this page, and the
+ * middle key that comes down in front of its first child
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::CanMoveLastToFrontOf(const BPlusTreeInternalPage *recipient,
+                                                          const KeyType &middle_key) const {
+  int width = recipient->array_.WidthWith(recipient->GetSize(), {middle_key, KeyAt(GetSize() - 1)});
+  return KeyArray::Fits(recipient->GetSize() + 1, width);
 }
 
 
+/*
+ * Helper method to find and return array index(or offset), so that its value
+ * equals to input "value"
+ * @return : the index, or GetSize() if no child is "value"
+ */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  
-  assert(GetSize() > 1);
-  if (comparator(key, array[1].first) < 0) {
-    return array[0].second;
-  } else if (comparator(key, array[GetSize() - 1].first) >= 0) {
-    return array[GetSize() - 1].second;
-  }
-
-  int low = 1, high = GetSize() - 1, mid;
-  while (low < high && low + 1 != high) {
-    mid = low + (high - low)/2;
-    if (comparator(key, array[mid].first) < 0) {
-      high = mid;
-    } else if (comparator(key, array[mid].first) > 0) {
-      low = mid;
-    } else {
-      return array[mid].second;
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int i = 0; i < GetSize(); i++) {
+    if (array_.ValueAt(i) == value) {
+      return i;
     }
   }
-  return array[low].second;
+  return GetSize();
+}
+
+/*
+ * Helper method to get the value associated with input "index"(a.k.a array
+ * offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  assert(0 <= index && index < GetSize());
+  return array_.ValueAt(index);
+}
 
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) {
+  assert(0 <= index && index < GetSize());
+  array_.SetValueAt(index, value);
 }
 
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * Find and return the child pointer(page_id) which points to the child page
+ * that contains input "key"
+ * Start the search from the second key(the first key should always be invalid)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
+  // The last key that is less than or equal to "key" leads to it; the child before the first key takes the rest.
+  return array_.ValueAt(array_.UpperBound(1, GetSize(), key, comparator) - 1);
+}
 
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Populate new root page with old_value + new_key & new_value
+ * When the insertion cause overflow from leaf page all the way upto the root
+ * page, you should create a new root page and populate its elements.
+ * NOTE: This method is only called within InsertIntoParent()(b_plus_tree.cpp)
+ * The first key is a copy of the second, so that the two take up no room.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
+                                                     const ValueType &new_value) {
   assert(GetSize() == 1);
-  array[0].second = old_value;
-  array[1] = {new_key, new_value};
+  array_.SetKeyAt(0, new_key, 1);
+  array_.SetValueAt(0, old_value);
+  array_.Insert(1, new_key, new_value, 1);
   IncreaseSize(1);
 }
 
+/*
+ * Insert new_key & new_value pair right after the pair with its value ==
+ * old_value
+ * @return:  new size after insertion
+ */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
                                                     const ValueType &new_value) {
-   for (int i = GetSize(); i > 0; --i) {
-    if (array[i - 1].second == old_value) {
-      array[i] = {new_key, new_value};
-      IncreaseSize(1);
-      break;
-    }
-    array[i] = array[i - 1];
-  }
+  int index = ValueIndex(old_value) + 1;
+  assert(index <= GetSize());
+  array_.Insert(index, new_key, new_value, GetSize());
+  IncreaseSize(1);
   return GetSize();
 }
 
-
+/*
+ * Insert key & value pair ordered by key. Unlike InsertNodeAfter, this does
+ * not need the left neighbour of the new child to be in the page yet, so the
+ * separators of splits that reach the page out of order go in at the right
+ * place all the same.
+ * @return:  new size after insertion
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager){
-  auto half = (GetSize() + 1)/2;
-  recipient->CopyHalfFrom(array + GetSize() - half, half, buffer_pool_manager);
-
-   for (auto index = GetSize() - half; index < GetSize(); ++index) {
-    auto *page = buffer_pool_manager->FetchPage(ValueAt(index));
-    if (page == nullptr) {
-    }
-    auto child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    child->SetParentPageId(recipient->GetPageId());
-
-    assert(child->GetParentPageId() == recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(child->GetPageId(), true);
-  }
-  IncreaseSize(-1*half);
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value,
+                                           const KeyComparator &comparator) {
+  int index = array_.LowerBound(1, GetSize(), key, comparator);
+  array_.Insert(index, key, value, GetSize());
+  IncreaseSize(1);
+  return GetSize();
 }
 
-
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Remove half of key & value pairs from this page to "recipient" page, and
+ * link "recipient" in after this page. The first key moved is the one to
+ * insert into the parent, and stays as the (otherwise unused) first key of
+ * "recipient". Both halves are compacted, as for a leaf page.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyHalfFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager){
-  assert(!IsLeafPage() && GetSize() == 1 && size > 0);
-  for (int i = 0; i < size; ++i) {
-    array[i] = *items++;
-  }
-  IncreaseSize(size - 1);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient) {
+  assert(recipient->GetSize() == 1);
+  int half = (GetSize() + 1) / 2;
+  recipient->array_.Append(array_, GetSize(), GetSize() - half, GetSize(), 0);
+  recipient->SetSize(half);
+  recipient->array_.Compact(half);
+  IncreaseSize(-half);
+  array_.Compact(GetSize());
+  recipient->SetNextPageId(next_page_id_);
+  recipient->SetHighKey(high_key_);
+  SetNextPageId(recipient->GetPageId());
+  SetHighKey(recipient->KeyAt(0));
 }
 
-
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * Remove the key & value pair in internal page according to input index(a.k.a
+ * array offset)
+ * NOTE: store key&value pair continuously after deletion
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index){
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
   assert(0 <= index && index < GetSize());
-  for (int i = index; i < GetSize() - 1; ++i) {
-    array[i] = array[i + 1];
-  }
+  array_.Remove(index, GetSize());
   IncreaseSize(-1);
 }
 
-
+/*
+ * Remove the only key & value pair in internal page and return the value
+ * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
+ */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild(){
-  IncreaseSize(-1);
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
   assert(GetSize() == 1);
-  return ValueAt(0);
+  SetSize(0);
+  return array_.ValueAt(0);
 }
 
-
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+/*
+ * Remove all of key & value pairs from this page to "recipient" page.
+ * The middle_key is the separation key you should get from the parent. You need
+ * to make sure the middle key is added to the recipient to maintain the invariant.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyAllFrom(MappingType *items, int size,
-            BufferPoolManager *buffer_pool_manager) {
-  assert(GetSize() + size <= GetMaxSize());
-  int start = GetSize();
-  for (int i = 0; i < size; ++i) {
-    array[start + i] = *items++;
-  }
-  IncreaseSize(size);
-}
-
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, int index_in_parent, BufferPoolManager *buffer_pool_manager){
-
-  
-  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
-   auto *parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-
-  SetKeyAt(0, parent->KeyAt(index_in_parent));
-
-  assert(parent->ValueAt(index_in_parent) == GetPageId());
-
-  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
-
-  recipient->CopyAllFrom(array, GetSize(), buffer_pool_manager);
-
-   for (auto index = 0; index < GetSize(); ++index) {
-    auto *page = buffer_pool_manager->FetchPage(ValueAt(index));
-    if (page == nullptr) {
-      
-    }
-    auto child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    child->SetParentPageId(recipient->GetPageId());
-
-    assert(child->GetParentPageId() == recipient->GetPageId());
-    buffer_pool_manager->UnpinPage(child->GetPageId(), true);
-  }
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  SetKeyAt(0, middle_key);
+  recipient->array_.Append(array_, GetSize(), 0, GetSize(), recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
+  recipient->SetNextPageId(next_page_id_);
+  recipient->SetHighKey(high_key_);
+  SetSize(0);
 }
 
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Remove the first key & value pair from this page to tail of "recipient" page.
+ * The middle_key is the separation key from the parent, which goes down with the
+ * moved child. Afterwards the first key of this page is the new separation key.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, int parent_index,
-                                                      BufferPoolManager *buffer_pool_manager) {
-
-  assert(GetSize() > 1);
-  MappingType pair{KeyAt(1), ValueAt(0)};
-  page_id_t child_page_id = ValueAt(0);
-  SetValueAt(0, ValueAt(1));
-  Remove(1);
-
- 
-  recipient->CopyLastFrom(pair, buffer_pool_manager);
-
-  
-  auto *page = buffer_pool_manager->FetchPage(child_page_id);
-  if (page == nullptr) {
-  
-  }
-  auto child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  child->SetParentPageId(recipient->GetPageId());
-
-  assert(child->GetParentPageId() == recipient->GetPageId());
-  buffer_pool_manager->UnpinPage(child->GetPageId(), true);
-
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->CopyLastFrom({middle_key, array_.ValueAt(0)});
+  Remove(0);
 }
 
-
+/* Append an entry at the end. */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager){
-  assert(GetSize() + 1 <= GetMaxSize());
-
-  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page == nullptr) {
-    
-  }
-  auto parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-
-  auto index = parent->ValueIndex(GetPageId());
-  auto key = parent->KeyAt(index + 1);
-
-  array[GetSize()] = {key, pair.second};
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair) {
+  array_.Insert(GetSize(), pair.first, pair.second, GetSize());
   IncreaseSize(1);
-  parent->SetKeyAt(index + 1, pair.first);
-
-  
-  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
 }
 
-
+/*
+ * Remove the last key & value pair from this page to head of "recipient" page.
+ * The middle_key is the separation key from the parent, which goes down to sit
+ * in front of the old first child of "recipient". Afterwards the first key of
+ * "recipient" is the new separation key.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, int parent_index,
-                                                       BufferPoolManager *buffer_pool_manager){
-
-   assert(GetSize() > 1);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key) {
+  recipient->SetKeyAt(0, middle_key);
+  recipient->CopyFirstFrom({KeyAt(GetSize() - 1), ValueAt(GetSize() - 1)});
   IncreaseSize(-1);
-  MappingType pair = array[GetSize()];
-  page_id_t child_page_id = pair.second;
-
-  recipient->CopyFirstFrom(pair, parent_index, buffer_pool_manager);
-
-  auto *page = buffer_pool_manager->FetchPage(child_page_id);
-  if (page == nullptr) {
-  }
-  auto child = reinterpret_cast<BPlusTreePage *>(page->GetData());
-  child->SetParentPageId(recipient->GetPageId());
-
-  assert(child->GetParentPageId() == recipient->GetPageId());
-  buffer_pool_manager->UnpinPage(child->GetPageId(), true);
-
 }
 
-/* Append an entry at the beginning.
- * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
- * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
- */
+/* Append an entry at the beginning. */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair,int parent_index, BufferPoolManager *buffer_pool_manager){
-  assert(GetSize() + 1 < GetMaxSize());
-
-  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page == nullptr) {
-    //throw Exception(EXCEPTION_TYPE_INDEX, "all page are pinned while CopyFirstFrom");
-  }
-  auto parent = reinterpret_cast<BPlusTreeInternalPage *>(page->GetData());
-
-  auto key = parent->KeyAt(parent_index);
-
-
-
-  // set parent key to the last of current page
-  parent->SetKeyAt(parent_index, pair.first);
-
-  InsertNodeAfter(array[0].second, key, array[0].second);
-  array[0].second = pair.second;
-
-  buffer_pool_manager->UnpinPage(parent->GetPageId(), true);
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair) {
+  array_.Insert(0, pair.first, pair.second, GetSize());
+  IncreaseSize(1);
 }
 
-
-
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
 template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
 template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, IntegerComparator<4>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, IntegerComparator<8>>;
+template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, MemcmpComparator<4>>;
+template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, MemcmpComparator<8>>;
+template class BPlusTreeInternalPage<GenericKey<16>, page_id_t, MemcmpComparator<16>>;
+template class BPlusTreeInternalPage<GenericKey<32>, page_id_t, MemcmpComparator<32>>;
+template class BPlusTreeInternalPage<GenericKey<64>, page_id_t, MemcmpComparator<64>>;
 }  // namespace bustub
@@ -9,9 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
-#include <string.h>
-#include <bits/stdc++.h>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -23,6 +23,7 @@ namespace bustub {
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  static_assert(sizeof(BPlusTreeLeafPage) == LEAF_PAGE_HEADER_SIZE, "the pairs take up the rest of the page");
 
   this->SetPageType(IndexPageType:: LEAF_PAGE);
   this->SetSize(0);
@@ -44,208 +45,234 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
   this->next_page_id_ = next_page_id;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const {
+  assert(next_page_id_ != INVALID_PAGE_ID);
+  return high_key_;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  for (int i = 0; i < GetSize(); ++i) {
-    if (comparator(key, array[i].first) <= 0) {
-      return i;
-    }
-  }
-  return GetSize();
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) {
+  high_key_ = high_key;
+}
+
+/*
+ * @return true if the key belongs to a page to the right of this one
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsPastHighKey(const KeyType &key, const KeyComparator &comparator) const {
+  return next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0;
 }
 
 
+/**
+ * Helper method to find the first index i so that array[i].first >= key
+ * NOTE: This method is only used when generating index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  return array_.LowerBound(0, GetSize(), key, comparator);
+}
+
+/*
+ * Helper method to find and return the key associated with input "index"(a.k.a
+ * array offset)
+ */
 INDEX_TEMPLATE_ARGUMENTS
 KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
- 
   assert(0 <= index && index < GetSize());
-  return array[index].first;
+  return array_.KeyAt(index);
 }
 
+/*
+ * Helper method to find and return the key & value pair associated with input
+ * "index"(a.k.a array offset)
+ */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const {
   assert(0 <= index && index < GetSize());
-  return array[index];
+  return {array_.KeyAt(index), array_.ValueAt(index)};
+}
+
+/*
+ * A page of keys that have nothing in common holds LEAF_PAGE_SLOTS pairs, so
+ * it counts as underfull below half of that, however large its max size.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::GetMinSize() const {
+  return std::min<int>(BPlusTreePage::GetMinSize(), LEAF_PAGE_SLOTS / 2);
 }
 
+/*
+ * @return true if the pairs still fit into the page once key is added, which
+ * may have less in common with the other keys than they have among themselves
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanInsert(const KeyType &key) const {
+  return KeyArray::Fits(GetSize() + 1, array_.WidthWith(GetSize(), {key}));
+}
 
+/*
+ * @return true if the pairs of both pages fit into "recipient"
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::CanMoveAllTo(const BPlusTreeLeafPage *recipient) const {
+  int size = recipient->GetSize() + GetSize();
+  return KeyArray::Fits(size, recipient->array_.WidthWith(recipient->GetSize(), array_, GetSize(), {}));
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+/*
+ * Insert key & value pair into leaf page ordered by key
+ * @return  page size after insertion, unchanged if the key is already there
+ */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-   if (GetSize() == 0 || comparator(key, KeyAt(GetSize() - 1)) > 0) {
-    array[GetSize()] = {key, value};
-  } else if (comparator(key, array[0].first) < 0) {
-
-    memmove(static_cast<void*>(array + 1), static_cast<void*>(array), static_cast<size_t>(GetSize()*sizeof(MappingType)));
-    array[0] = {key, value};
-  } else {
-    int low = 0, high = GetSize() - 1, mid;
-    while (low < high && low + 1 != high) {
-      mid = low + (high - low)/2;
-      if (comparator(key, array[mid].first) < 0) {
-        high = mid;
-      } else if (comparator(key, array[mid].first) > 0) {
-        low = mid;
-      } else {
-      
-        assert(0);
-      }
-    }
-    memmove(static_cast<void*>(array + high + 1), static_cast<void*>(array + high), static_cast<size_t>((GetSize() - high)*sizeof(MappingType)));
-    array[high] = {key, value};
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(array_.KeyAt(index), key) == 0) {
+    return GetSize();
   }
-
+  array_.Insert(index, key, value, GetSize());
   IncreaseSize(1);
   assert(GetSize() <= GetMaxSize());
   return GetSize();
 }
 
-
+/*****************************************************************************
+ * SPLIT
+ *****************************************************************************/
+/*
+ * Remove half of key & value pairs from this page to "recipient" page, and
+ * link "recipient" in after this page, with the first key moved as the
+ * separator. Either half may have more in common than the whole, and is
+ * compacted to take up no more room than it has to.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
-
-  int size = GetSize()/2;
-  MappingType *src = array + GetSize() - size;
-  recipient->CopyNFrom(src, size);
-  IncreaseSize(-1*size);
-}
-
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {
-   assert(IsLeafPage() && GetSize() == 0);
-  for (int i = 0; i < size; ++i) {
-    array[i] = *items++;
-  }
-  IncreaseSize(size);
+  assert(recipient->GetSize() == 0);
+  int half = GetSize() / 2;
+  recipient->array_.Append(array_, GetSize(), GetSize() - half, GetSize(), 0);
+  recipient->SetSize(half);
+  recipient->array_.Compact(half);
+  IncreaseSize(-half);
+  array_.Compact(GetSize());
+  recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(high_key_);
+  SetNextPageId(recipient->GetPageId());
+  SetHighKey(recipient->KeyAt(0));
 }
 
-
+/*****************************************************************************
+ * LOOKUP
+ *****************************************************************************/
+/*
+ * For the given key, check to see whether it exists in the leaf page. If it
+ * does, then store its corresponding value in input "value" and return true.
+ * If the key does not exist, then return false
+ */
 INDEX_TEMPLATE_ARGUMENTS
-bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key,ValueType &value, const KeyComparator &comparator) const {
- 
-  if (GetSize() == 0 || comparator(key, KeyAt(0)) < 0 ||
-      comparator(key, KeyAt(GetSize() - 1)) > 0) {
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType &value, const KeyComparator &comparator) const {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_.KeyAt(index), key) != 0) {
     return false;
   }
-  // binary search
-  int low = 0, high = GetSize() - 1, mid;
-  while (low <= high) {
-    mid = low + (high - low)/2;
-    if (comparator(key, KeyAt(mid)) > 0) {
-      low = mid + 1;
-    } else if (comparator(key, KeyAt(mid)) < 0) {
-      high = mid - 1;
-    } else {
-      value = array[mid].second;
-      return true;
-    }
-  }
-  return false;
+  value = array_.ValueAt(index);
+  return true;
 }
 
-
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+/*
+ * First look through leaf page to see whether delete key exist or not. If
+ * exist, perform deletion, otherwise return immediately.
+ * NOTE: store key&value pair continuously after deletion
+ * @return   page size after deletion
+ */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
-   if (GetSize() == 0 || comparator(key, KeyAt(0)) < 0 ||
-      comparator(key, KeyAt(GetSize() - 1)) > 0) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_.KeyAt(index), key) != 0) {
     return GetSize();
   }
-
- 
-  int low = 0, high = GetSize() - 1, mid;
-  while (low <= high) {
-    mid = low + (high - low)/2;
-    if (comparator(key, KeyAt(mid)) > 0) {
-      low = mid + 1;
-    } else if (comparator(key, KeyAt(mid)) < 0) {
-      high = mid - 1;
-    } else {
-     
-      memmove(static_cast<void*>(array + mid), static_cast<void*>(array + mid + 1), static_cast<size_t>((GetSize() - mid - 1)*sizeof(MappingType)));
-      IncreaseSize(-1);
-      break;
-    }
-  }
+  array_.Remove(index, GetSize());
+  IncreaseSize(-1);
   return GetSize();
 }
 
-
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+/*
+ * Remove all of key & value pairs from this page to "recipient" page. Don't
+ * forget to update the next_page id in the sibling page
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
-   recipient->CopyAllFrom(array, GetSize());
+  assert(recipient->GetSize() + GetSize() < GetMaxSize());
+  recipient->array_.Append(array_, GetSize(), 0, GetSize(), recipient->GetSize());
+  recipient->IncreaseSize(GetSize());
   recipient->SetNextPageId(GetNextPageId());
+  recipient->SetHighKey(high_key_);
+  SetSize(0);
 }
 
-
-INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::
-CopyAllFrom(MappingType *items, int size) {
-  assert(GetSize() + size <= GetMaxSize());
-  auto start = GetSize();
-  for (int i = 0; i < size; ++i) {
-    array[start + i] = *items++;
-  }
-  IncreaseSize(size);
-}
-
-
+/*****************************************************************************
+ * REDISTRIBUTE
+ *****************************************************************************/
+/*
+ * Remove the first key & value pair from this page to "recipient" page. The
+ * caller updates the separation key in the parent.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient, BufferPoolManager *buffer_pool_manager){
-  MappingType pair = GetItem(0);
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyLastFrom(GetItem(0));
+  array_.Remove(0, GetSize());
   IncreaseSize(-1);
-  memmove(static_cast<void*>(array), static_cast<void*>(array + 1), static_cast<size_t>(GetSize()*sizeof(MappingType)));
-
-  recipient->CopyLastFrom(pair);
-
-  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page == nullptr) {
-   }
-  auto parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()),KeyComparator> *>(page->GetData());
-
-  parent->SetKeyAt(parent->ValueIndex(GetPageId()), pair.first);
-
-   buffer_pool_manager->UnpinPage(GetParentPageId(), true);
 }
 
-
+/*
+ * Copy the item into the end of my item list. (Append item to my array)
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item){
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
   assert(GetSize() + 1 <= GetMaxSize());
-  array[GetSize()] = item;
+  array_.Insert(GetSize(), item.first, item.second, GetSize());
   IncreaseSize(1);
 }
 
-
+/*
+ * Remove the last key & value pair from this page to "recipient" page. The
+ * caller updates the separation key in the parent.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient, int parentIndex, BufferPoolManager *buffer_pool_manager) {
-   MappingType pair = GetItem(GetSize() - 1);
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(GetItem(GetSize() - 1));
   IncreaseSize(-1);
-  recipient->CopyFirstFrom(pair, parentIndex, buffer_pool_manager);
 }
 
-
+/*
+ * Insert item at the front of my items. Move items accordingly.
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item, int parentIndex, BufferPoolManager *buffer_pool_manager){
-   assert(GetSize() + 1 < GetMaxSize());
-  memmove(static_cast<void*>(array + 1), static_cast<void*>(array), GetSize()*sizeof(MappingType));
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {
+  assert(GetSize() + 1 <= GetMaxSize());
+  array_.Insert(0, item.first, item.second, GetSize());
   IncreaseSize(1);
-  array[0] = item;
-
-  auto *page = buffer_pool_manager->FetchPage(GetParentPageId());
-  if (page == nullptr) {
-  }
- auto parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, decltype(GetPageId()), KeyComparator> *>(page->GetData());
-
-   parent->SetKeyAt(parentIndex, item.first);
-
-  buffer_pool_manager->UnpinPage(GetParentPageId(), true);
 }
 
-
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class BPlusTreeLeafPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class BPlusTreeLeafPage<GenericKey<4>, RID, IntegerComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, IntegerComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class BPlusTreeLeafPage<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class BPlusTreeLeafPage<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class BPlusTreeLeafPage<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class BPlusTreeLeafPage<GenericKey<64>, RID, MemcmpComparator<64>>;
 }  // namespace bustub
@@ -19,9 +19,6 @@ bool BPlusTreePage::IsLeafPage() const{
 }
 
 
-bool BPlusTreePage::IsRootPage() const {
-    return parent_page_id_ == INVALID_PAGE_ID;
-}
 void BPlusTreePage::SetPageType(IndexPageType page_type) {
     page_type_ = page_type;
 }
@@ -46,8 +43,13 @@ void BPlusTreePage::SetMaxSize(int size){
 }
 
 
+/*
+ * A leaf splits when it fills up to its max size, an internal page only when it has more children than that, and
+ * either split leaves both halves with at least this many entries. For an internal page of max size 3 or more this
+ * is at least two children, so that every child has a neighbour to borrow from or merge with.
+ */
 int BPlusTreePage::GetMinSize() const {
-    return ((max_size_)>>1);
+    return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2;
 }
 
 
@@ -50,5 +50,10 @@ template class HashTableBlockPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class HashTableBlockPage<GenericKey<16>, RID, GenericComparator<16>>;
 template class HashTableBlockPage<GenericKey<32>, RID, GenericComparator<32>>;
 template class HashTableBlockPage<GenericKey<64>, RID, GenericComparator<64>>;
+template class HashTableBlockPage<GenericKey<4>, RID, MemcmpComparator<4>>;
+template class HashTableBlockPage<GenericKey<8>, RID, MemcmpComparator<8>>;
+template class HashTableBlockPage<GenericKey<16>, RID, MemcmpComparator<16>>;
+template class HashTableBlockPage<GenericKey<32>, RID, MemcmpComparator<32>>;
+template class HashTableBlockPage<GenericKey<64>, RID, MemcmpComparator<64>>;
 
 }  // namespace bustub
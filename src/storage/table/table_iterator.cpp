@@ -10,14 +10,23 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
+#include <vector>
 
+#include "common/macros.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, size_t prefetch_window,
+                             BufferAccessStrategy *strategy)
+    : table_heap_(table_heap),
+      tuple_(new Tuple(rid)),
+      txn_(txn),
+      prefetch_window_(prefetch_window),
+      strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
@@ -35,19 +44,21 @@ Tuple *TableIterator::operator->() {
 
 TableIterator &TableIterator::operator++() {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  cur_page->RLatch();
-  assert(cur_page != nullptr);  // all pages are pinned
+  auto cur_guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_);
+  BUSTUB_ASSERT(!cur_guard.IsEmpty(), "Every frame of the buffer pool is pinned.");
+  auto cur_page = static_cast<TablePage *>(cur_guard.GetPage());
+  PrefetchAhead(cur_page->GetTablePageId(), cur_page->GetNextPageId());
 
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      // Latch the next page before releasing the current one.
+      auto next_guard = buffer_pool_manager->FetchPageRead(cur_page->GetNextPageId(), strategy_);
+      BUSTUB_ASSERT(!next_guard.IsEmpty(), "Every frame of the buffer pool is pinned.");
+      cur_guard = std::move(next_guard);
+      cur_page = static_cast<TablePage *>(cur_guard.GetPage());
+      PrefetchAhead(cur_page->GetTablePageId(), cur_page->GetNextPageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -58,9 +69,7 @@ TableIterator &TableIterator::operator++() {
   if (*this != table_heap_->End()) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
-  // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  // cur_guard releases the page only after the tuple has been copied
   return *this;
 }
 
@@ -70,4 +79,24 @@ TableIterator TableIterator::operator++(int) {
   return clone;
 }
 
+void TableIterator::PrefetchAhead(page_id_t page_id, page_id_t next_page_id) {
+  if (prefetch_window_ == 0 || next_page_id != page_id + 1) {
+    return;
+  }
+  // Ask again only once half of the window has been consumed, so that the pages go out in batches. The buffer pool
+  // reads ahead into at most half of its frames, so a larger window would only push out pages read ahead earlier.
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  size_t max_window = std::max<size_t>(buffer_pool_manager->GetPoolSize() / 2, 1);
+  auto window = static_cast<page_id_t>(std::min(prefetch_window_, max_window));
+  if (prefetched_until_ >= page_id + window / 2) {
+    return;
+  }
+  std::vector<page_id_t> page_ids;
+  for (page_id_t id = std::max(prefetched_until_ + 1, next_page_id); id <= page_id + window; id++) {
+    page_ids.push_back(id);
+  }
+  buffer_pool_manager->PrefetchPages(page_ids);
+  prefetched_until_ = page_id + window;
+}
+
 }  // namespace bustub
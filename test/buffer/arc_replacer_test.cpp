@@ -0,0 +1,115 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+#include "replacer_test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: pages 10-13 are brought into frames 0-3 and released. They were all seen once, so they are in T1.
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.RecordAccess(frame_id, 10 + frame_id);
+    arc_replacer.Pin(frame_id);
+  }
+  for (frame_id_t frame_id = 0; frame_id < 4; frame_id++) {
+    arc_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // Scenario: the least recently used page of T1 goes first and is remembered in B1.
+  int value;
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 10 comes back. The ghost hit in B1 grows the target of T1, and the page goes to T2.
+  arc_replacer.RecordAccess(0, 10);
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+  arc_replacer.Unpin(0);
+
+  // Scenario: T1 holds 3 frames, more than its target, so it gives up its LRU frame.
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a hit moves page 12 to T2. T1 is now at its target, so the victim comes from the LRU end of T2.
+  arc_replacer.RecordAccess(2, 12);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 10 comes back again. The ghost hit in B2 shrinks the target of T1.
+  arc_replacer.RecordAccess(0, 10);
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // Scenario: pinned frames are never victims, and removed frames are forgotten.
+  arc_replacer.Pin(3);
+  arc_replacer.Remove(2);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, arc_replacer.Size());
+  arc_replacer.Unpin(0);
+  ASSERT_TRUE(arc_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+}
+
+// NOLINTNEXTLINE
+TEST(ARCReplacerTest, DISABLED_WorkloadShiftBenchmark) {
+  // The trace alternates between an OLTP phase, where point lookups go to a hot set of index pages while a scan over a
+  // large table runs alongside, and an analytic phase that repeatedly scans a table slightly smaller than the pool.
+  const size_t pool_size = 64;
+  const int hot_pages = 40;
+  const int big_table_pages = 1024;
+  const int small_table_pages = 56;
+  const int num_phases = 6;
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> hot_dist(0, hot_pages - 1);
+  std::vector<page_id_t> trace;
+  for (int phase = 0; phase < num_phases; phase++) {
+    if (phase % 2 == 0) {
+      for (int i = 0; i < big_table_pages; i++) {
+        trace.push_back(hot_dist(rng));
+        trace.push_back(hot_dist(rng));
+        trace.push_back(hot_pages + i);
+      }
+    } else {
+      for (int scan = 0; scan < 20; scan++) {
+        for (int i = 0; i < small_table_pages; i++) {
+          trace.push_back(hot_pages + big_table_pages + i);
+        }
+      }
+    }
+  }
+
+  LRUReplacer lru_replacer(pool_size);
+  LRUKReplacer lru_k_replacer(pool_size, 2);
+  ARCReplacer arc_replacer(pool_size);
+  const page_id_t all_pages = std::numeric_limits<page_id_t>::max();
+  double lru_hit_rate = ReplayHitRate(&lru_replacer, pool_size, trace, all_pages);
+  double lru_k_hit_rate = ReplayHitRate(&lru_k_replacer, pool_size, trace, all_pages);
+  double arc_hit_rate = ReplayHitRate(&arc_replacer, pool_size, trace, all_pages);
+  std::cout << "references=" << trace.size() << " pool_size=" << pool_size << " hit_rate lru=" << lru_hit_rate
+            << " lru_k=" << lru_k_hit_rate << " arc=" << arc_hit_rate << std::endl;
+  EXPECT_GT(arc_hit_rate, lru_hit_rate);
+}
+
+}  // namespace bustub
@@ -0,0 +1,143 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy_test.cpp
+//
+// Identification: test/buffer/buffer_access_strategy_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the number of pages with an id below max_page_id that are resident in the given frames */
+int CountResident(Page *pages, size_t pool_size, page_id_t max_page_id) {
+  int count = 0;
+  for (size_t i = 0; i < pool_size; i++) {
+    page_id_t page_id = pages[i].GetPageId();
+    count += (page_id != INVALID_PAGE_ID && page_id < max_page_id) ? 1 : 0;
+  }
+  return count;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, SampleTest) {
+  const std::string db_name = "strategy_test.db";
+  const size_t buffer_pool_size = 64;
+  const page_id_t hot_pages = 32;
+  const page_id_t table_pages = 256;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < hot_pages + table_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 0; i < hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  ASSERT_EQ(hot_pages, CountResident(bpm->GetPages(), buffer_pool_size, hot_pages));
+
+  // Scenario: a bulk insert under a strategy creates its pages in a ring of its own and writes them back itself.
+  BufferAccessStrategy strategy(8);
+  for (page_id_t i = 0; i < table_pages; ++i) {
+    auto *page = bpm->NewPageWithStrategy(&page_id_temp, &strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(hot_pages, CountResident(bpm->GetPages(), buffer_pool_size, hot_pages));
+
+  // Scenario: a scan under a strategy cycles through the same frames and leaves the hot pages in the pool.
+  for (page_id_t page_id = hot_pages; page_id < hot_pages + 2 * table_pages; ++page_id) {
+    auto *page = bpm->FetchPageWithStrategy(page_id, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(hot_pages, CountResident(bpm->GetPages(), buffer_pool_size, hot_pages));
+
+  // Scenario: a page of the ring that someone else holds is not recycled; the scan takes another frame meanwhile.
+  auto *pinned = bpm->FetchPageWithStrategy(hot_pages, &strategy);
+  ASSERT_NE(nullptr, pinned);
+  for (page_id_t page_id = hot_pages + 1; page_id < hot_pages + table_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(page_id, &strategy));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(hot_pages, pinned->GetPageId());
+  EXPECT_EQ(true, bpm->UnpinPage(hot_pages, false));
+
+  // Scenario: without a strategy, the same scan flushes the hot pages out.
+  for (page_id_t page_id = hot_pages; page_id < hot_pages + table_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, CountResident(bpm->GetPages(), buffer_pool_size, hot_pages));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferAccessStrategyTest, ParallelTest) {
+  const std::string db_name = "strategy_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 32;
+  const page_id_t hot_pages = 64;
+  const page_id_t table_pages = 512;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < hot_pages + table_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 0; i < hot_pages; ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  // Scenario: the strategy keeps one ring in every instance, so a scan leaves the hot pages of all instances alone.
+  BufferAccessStrategy strategy(SEQ_SCAN_RING_SIZE);
+  for (page_id_t page_id = hot_pages; page_id < hot_pages + table_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(page_id, &strategy));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  int resident = 0;
+  for (size_t i = 0; i < num_instances; i++) {
+    resident += CountResident(bpm->GetBufferPoolManager(i)->GetPages(), pool_size, hot_pages);
+  }
+  EXPECT_EQ(hot_pages, resident);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -11,13 +11,49 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
 
 namespace bustub {
 
+/** A disk manager whose asynchronous reads and writes fail on demand. */
+class FailingDiskManager : public DiskManager {
+ public:
+  explicit FailingDiskManager(const std::string &db_file) : DiskManager(db_file) {}
+
+  std::atomic<bool> fail_reads_{false};
+  std::atomic<int> failed_reads_{0};
+  std::atomic<bool> fail_writes_{false};
+  std::atomic<bool> hold_reads_{false};
+  std::atomic<int> held_reads_{0};
+
+ protected:
+  bool ExecuteRequest(const DiskRequest &request) override {
+    if (!request.is_write_ && hold_reads_) {
+      held_reads_++;
+      while (hold_reads_) {
+        std::this_thread::yield();
+      }
+    }
+    if (!request.is_write_ && fail_reads_) {
+      failed_reads_++;
+      return false;
+    }
+    if (request.is_write_ && fail_writes_) {
+      return false;
+    }
+    return DiskManager::ExecuteRequest(request);
+  }
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -28,7 +64,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   std::default_random_engine rng(r());
   std::uniform_int_distribution<char> uniform_dist(0);
 
-  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_manager = NewTestDiskManager(db_name);
   auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
@@ -90,7 +126,7 @@ TEST(BufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
-  auto *disk_manager = new DiskManager(db_name);
+  auto *disk_manager = NewTestDiskManager(db_name);
   auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
@@ -141,4 +177,379 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Misses and dirty write-backs release the latch, so concurrent fetches of the same pages must still see one copy.
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 8;
+  const int rounds = 200;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  // The page cleaner writes frames back underneath the threads as well.
+  bpm->StartPageCleaner(buffer_pool_size / 2);
+
+  page_id_t page_id_temp;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    *reinterpret_cast<int *>(page->GetData()) = 0;
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Every thread increments a counter on each page under the page write latch. Lost updates would mean that two
+  // frames held the same page, or that a write-back raced with a reuse of its frame.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([bpm, tid]() {
+      for (int round = 0; round < rounds; ++round) {
+        page_id_t page_id = (tid + round) % num_pages;
+        Page *page = bpm->FetchPage(page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm->FetchPage(page_id);
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        page->WLatch();
+        *reinterpret_cast<int *>(page->GetData()) += 1;
+        page->WUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+        if (round % 16 == 0) {
+          bpm->FlushPage(page_id);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int total = 0;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    total += *reinterpret_cast<int *>(page->GetData());
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(num_threads * rounds, total);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t min_clean_frames = 8;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the buffer pool with dirty, unpinned pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: the cleaner writes back the next victims of the replacer, and only as many as it was asked to.
+  bpm->StartPageCleaner(min_clean_frames);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (bpm->GetCleanerWrites() < min_clean_frames && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(page_cleaner_interval * 3);
+  EXPECT_EQ(min_clean_frames, bpm->GetCleanerWrites());
+
+  // Scenario: new pages get the cleaned frames, so none of them has to write back a victim.
+  for (size_t i = 0; i < min_clean_frames; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWrites());
+  bpm->StopPageCleaner();
+
+  // Scenario: the evicted pages were written by the cleaner and read back intact.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(min_clean_frames); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  // Dirties every page of the pool and makes them durable, once page by page with a sync after each write, as a
+  // flush used to, and once with FlushAllPages. Prints the time each took.
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  auto dirty_all = [&](const char *tag) {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "%s %d", tag, page_id);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  };
+
+  dirty_all("single");
+  auto start = std::chrono::steady_clock::now();
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    EXPECT_EQ(true, bpm->FlushPage(page_id));
+    disk_manager->SyncPages();
+  }
+  auto single_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+  // Scenario: one sync for the whole pool, every page written once, and what is on disk is the latest version.
+  dirty_all("batch");
+  int syncs = disk_manager->GetNumSyncs();
+  int writes = disk_manager->GetNumWrites();
+  start = std::chrono::steady_clock::now();
+  bpm->FlushAllPages();
+  auto batch_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  EXPECT_EQ(syncs + 1, disk_manager->GetNumSyncs());
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("batch " + std::to_string(page_id), std::string(data));
+  }
+  std::cout << "pages=" << buffer_pool_size << " per_page_sync_us=" << single_us.count()
+            << " flush_all_us=" << batch_us.count() << std::endl;
+
+  // Scenario: nothing is dirty, so nothing is written.
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushFailureTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+
+  auto *disk_manager = new FailingDiskManager(db_name);
+  disk_manager->SetAsyncIOBackend(AsyncIOBackendType::THREAD_POOL);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The writes of FlushAllPages fail. The pages stay dirty, so the next flush writes them.
+  disk_manager->fail_writes_ = true;
+  bpm->FlushAllPages();
+  disk_manager->fail_writes_ = false;
+  int writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(data));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchFailureTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 3;
+
+  auto *disk_manager = new FailingDiskManager(db_name);
+  disk_manager->SetAsyncIOBackend(AsyncIOBackendType::THREAD_POOL);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 6; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The read-ahead of evicted pages fails. The frames it took still hold the pages they held before, which
+  // must not be served as the pages that were asked for.
+  disk_manager->fail_reads_ = true;
+  bpm->PrefetchPages({0, 1, 2});
+  while (disk_manager->failed_reads_ == 0) {
+    std::this_thread::yield();
+  }
+  for (page_id_t page_id = 0; page_id < 6; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, PrefetchPoolExhaustionTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new FailingDiskManager(db_name);
+  disk_manager->SetAsyncIOBackend(AsyncIOBackendType::THREAD_POOL);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 8; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Half of the pool is pinned, and the read-ahead takes the other half.
+  ASSERT_NE(nullptr, bpm->FetchPage(6));
+  ASSERT_NE(nullptr, bpm->FetchPage(7));
+  disk_manager->hold_reads_ = true;
+  bpm->PrefetchPages({0, 1, 2, 3});
+  while (disk_manager->held_reads_ == 0) {
+    std::this_thread::yield();
+  }
+
+  // Scenario: A fetch that needs one of the frames being read waits for the read instead of failing.
+  std::thread releaser([disk_manager]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    disk_manager->hold_reads_ = false;
+  });
+  auto *page = bpm->FetchPage(4);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 4", std::string(page->GetData()));
+  releaser.join();
+  EXPECT_TRUE(bpm->UnpinPage(4, false));
+  EXPECT_TRUE(bpm->UnpinPage(6, false));
+  EXPECT_TRUE(bpm->UnpinPage(7, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t max_pool_size = 64;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU, max_pool_size);
+  EXPECT_FALSE(bpm->ResizeBufferPool(0));
+  EXPECT_FALSE(bpm->ResizeBufferPool(max_pool_size + 1));
+
+  // Scenario: pin a page in every frame, then grow the pool. The pinned pages stay where they are.
+  std::vector<Page *> pinned;
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    pinned.push_back(page);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->ResizeBufferPool(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = 0; i < max_pool_size - buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ("page " + std::to_string(i), std::string(pinned[i]->GetData()));
+  }
+
+  // Scenario: shrink the pool while a page in a surplus frame is pinned. The shrink waits for the unpin, then writes
+  // the page back and evicts it.
+  auto *page = bpm->FetchPage(static_cast<page_id_t>(max_pool_size - 1));
+  ASSERT_NE(nullptr, page);
+  std::thread unpinner([bpm, page]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    snprintf(page->GetData(), PAGE_SIZE, "modified");
+    EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(max_pool_size - 1), true));
+  });
+  EXPECT_TRUE(bpm->ResizeBufferPool(buffer_pool_size * 2));
+  unpinner.join();
+  EXPECT_EQ(buffer_pool_size * 2, bpm->GetPoolSize());
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(static_cast<page_id_t>(i), true));
+  }
+
+  // Scenario: every page is still there, through a pool of the new size, while another thread resizes it back and
+  // forth.
+  std::atomic<bool> done{false};
+  std::thread resizer([bpm, &done]() {
+    size_t sizes[] = {4, 32, 16, 64, 8};
+    for (size_t round = 0; !done; round++) {
+      EXPECT_TRUE(bpm->ResizeBufferPool(sizes[round % 5]));
+    }
+  });
+  for (int round = 0; round < 20; ++round) {
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+      page = bpm->FetchPage(page_id);
+      while (page == nullptr) {
+        std::this_thread::yield();
+        page = bpm->FetchPage(page_id);
+      }
+      if (page_id == static_cast<page_id_t>(max_pool_size - 1)) {
+        EXPECT_EQ("modified", std::string(page->GetData()));
+      } else {
+        EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+      }
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  done = true;
+  resizer.join();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats_test.cpp
+//
+// Identification: test/buffer/buffer_pool_stats_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_stats.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, HistogramTest) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(0, histogram.Mean());
+  EXPECT_EQ(0, histogram.Percentile(0.99));
+  EXPECT_EQ(0, LatencyHistogram::BucketOf(0));
+  EXPECT_EQ(1, LatencyHistogram::BucketOf(1));
+  EXPECT_EQ(2, LatencyHistogram::BucketOf(3));
+  EXPECT_EQ(11, LatencyHistogram::BucketOf(1024));
+  EXPECT_EQ(LatencyHistogram::NUM_BUCKETS - 1, LatencyHistogram::BucketOf(~static_cast<uint64_t>(0)));
+
+  // Scenario: 98 latencies of 100ns and 2 of 1ms. The median is in the bucket of 100ns, the 99th percentile in the
+  // bucket of 1ms.
+  histogram.buckets_[LatencyHistogram::BucketOf(100)] = 98;
+  histogram.buckets_[LatencyHistogram::BucketOf(1000000)] = 2;
+  histogram.count_ = 100;
+  histogram.total_nanos_ = 98 * 100 + 2 * 1000000;
+  EXPECT_EQ(20098, histogram.Mean());
+  EXPECT_EQ(127, histogram.Percentile(0.5));
+  EXPECT_EQ((1 << 20) - 1, histogram.Percentile(0.99));
+
+  LatencyHistogram other;
+  other.Merge(histogram);
+  other.Merge(histogram);
+  EXPECT_EQ(200, other.count_);
+  EXPECT_EQ(196, other.buckets_[LatencyHistogram::BucketOf(100)]);
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, SampleTest) {
+  const std::string db_name = "buffer_pool_stats_test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: fill the buffer pool with dirty pages, then hit each of them once.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.Get(BufferPoolCounter::NEW_PAGE));
+  EXPECT_EQ(buffer_pool_size, stats.Get(BufferPoolCounter::HIT));
+  EXPECT_EQ(0, stats.Get(BufferPoolCounter::MISS));
+  EXPECT_EQ(0, stats.Get(BufferPoolCounter::EVICTION));
+  EXPECT_EQ(1.0, stats.HitRatio());
+
+  // Scenario: one more page evicts page 0, which has to be written back, and fetching page 0 again is a miss that
+  // evicts page 1 in turn.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size + 1, stats.Get(BufferPoolCounter::NEW_PAGE));
+  EXPECT_EQ(1, stats.Get(BufferPoolCounter::MISS));
+  EXPECT_EQ(2, stats.Get(BufferPoolCounter::EVICTION));
+  EXPECT_EQ(2, stats.Get(BufferPoolCounter::DIRTY_WRITEBACK));
+  EXPECT_EQ(1, stats.Get(BufferPoolLatency::DISK_READ).count_);
+  EXPECT_LT(0, stats.Get(BufferPoolLatency::LATCH_WAIT).count_);
+
+  // Scenario: FlushAllPages writes back the two pages that are still dirty, and the disk manager saw every write.
+  bpm->FlushAllPages();
+  stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.Get(BufferPoolCounter::FLUSH));
+  EXPECT_EQ(4, stats.disk_writes_);
+  EXPECT_EQ(disk_manager->GetNumWrites(), stats.disk_writes_);
+  EXPECT_EQ(disk_manager->GetNumFlushes(), stats.log_flushes_);
+  EXPECT_EQ(stats.Get(BufferPoolCounter::DIRTY_WRITEBACK), bpm->GetForegroundWrites());
+  EXPECT_NE(std::string::npos, stats.ToString().find("misses=1\n"));
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolStatsTest, ParallelTest) {
+  const std::string db_name = "buffer_pool_stats_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 8;
+  const int num_threads = 4;
+  const int rounds = 1000;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < num_instances; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: every fetch from every thread is counted exactly once, whichever shard and instance it lands in.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm]() {
+      for (int i = 0; i < rounds; i++) {
+        auto page_id = static_cast<page_id_t>(i % num_instances);
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(num_instances, stats.Get(BufferPoolCounter::NEW_PAGE));
+  EXPECT_EQ(num_threads * rounds, stats.Get(BufferPoolCounter::HIT));
+  EXPECT_EQ(0, stats.Get(BufferPoolCounter::MISS));
+  EXPECT_EQ(disk_manager->GetNumWrites(), stats.disk_writes_);
+  // Hits take no latch; each of them unpins under the latch of its instance.
+  EXPECT_LE(static_cast<uint64_t>(num_threads * rounds), stats.Get(BufferPoolLatency::LATCH_WAIT).count_);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,16 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <iostream>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/clock_replacer.h"
+#include "buffer/lru_replacer.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +63,75 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, ConcurrentVictimTest) {
+  const size_t num_pages = 64;
+  const int num_threads = 8;
+  ClockReplacer clock_replacer(num_pages);
+  for (size_t i = 0; i < num_pages; i++) {
+    clock_replacer.Unpin(static_cast<frame_id_t>(i));
+  }
+
+  // Scenario: concurrent victims never claim the same frame, and every frame is claimed exactly once.
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&clock_replacer, &victims, tid]() {
+      frame_id_t frame_id;
+      while (clock_replacer.Victim(&frame_id)) {
+        victims[tid].push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<int> claimed(num_pages, 0);
+  for (const auto &thread_victims : victims) {
+    for (auto frame_id : thread_victims) {
+      claimed[frame_id]++;
+    }
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    EXPECT_EQ(1, claimed[i]);
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(ClockReplacerTest, DISABLED_PinUnpinBenchmark) {
+  // Buffer pool hits only Pin and Unpin frames. Prints how many such pairs per second several threads get through
+  // with the latched LRUReplacer and with the ClockReplacer.
+  const size_t num_pages = 1024;
+  const int num_threads = std::max(4U, std::thread::hardware_concurrency());
+  const int pairs_per_thread = 200000;
+
+  auto run = [&](Replacer *replacer) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([replacer, tid]() {
+        for (int i = 0; i < pairs_per_thread; i++) {
+          auto frame_id = static_cast<frame_id_t>((tid * 131 + i) % num_pages);
+          replacer->Pin(frame_id);
+          replacer->Unpin(frame_id);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(num_threads * pairs_per_thread / elapsed.count());
+  };
+
+  LRUReplacer lru_replacer(num_pages);
+  ClockReplacer clock_replacer(num_pages);
+  uint64_t lru_pairs_per_sec = run(&lru_replacer);
+  uint64_t clock_pairs_per_sec = run(&clock_replacer);
+  std::cout << "threads=" << num_threads << " pin_unpin/s lru=" << lru_pairs_per_sec
+            << " clock=" << clock_pairs_per_sec << std::endl;
+  EXPECT_EQ(num_pages, clock_replacer.Size());
+}
+
 }  // namespace bustub
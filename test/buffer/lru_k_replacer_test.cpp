@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+#include "replacer_test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1-5 are referenced once, frame 1 and 2 a second time. Then everything is unpinned.
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.RecordAccess(frame_id, frame_id);
+    lru_k_replacer.Pin(frame_id);
+  }
+  lru_k_replacer.RecordAccess(2, 2);
+  lru_k_replacer.RecordAccess(1, 1);
+  for (frame_id_t frame_id = 1; frame_id <= 5; frame_id++) {
+    lru_k_replacer.Unpin(frame_id);
+  }
+  EXPECT_EQ(5, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference have an infinite backward distance and go first, in LRU order.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: a pinned frame is never a victim, and unpinning it twice does not add it twice.
+  lru_k_replacer.RecordAccess(5, 5);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Unpin(5);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+
+  // Scenario: 5 now has two references, like 1 and 2. Frames go by their second-to-last reference, which is oldest
+  // for 1 even though 1 was also referenced most recently.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: a victimized frame starts over with an empty history.
+  lru_k_replacer.RecordAccess(1, 7);
+  lru_k_replacer.RecordAccess(6, 6);
+  lru_k_replacer.RecordAccess(6, 6);
+  lru_k_replacer.Unpin(6);
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+
+  // Scenario: a removed frame is gone, history included.
+  lru_k_replacer.Remove(6);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, DISABLED_ScanResistanceBenchmark) {
+  // Point lookups go to a hot set of index pages that fits in the pool. Every so often a sequential scan reads a table
+  // that is several times larger than the pool. LRU lets each scan flush the hot set; LRU-K keeps it.
+  const size_t pool_size = 64;
+  const int hot_pages = 48;
+  const int table_pages = 512;
+  const int lookups_between_scans = 200;
+  const int num_scans = 40;
+
+  std::mt19937 rng(15445);
+  std::uniform_int_distribution<page_id_t> hot_dist(0, hot_pages - 1);
+  std::vector<page_id_t> trace;
+  for (int scan = 0; scan < num_scans; scan++) {
+    for (int i = 0; i < lookups_between_scans; i++) {
+      trace.push_back(hot_dist(rng));
+    }
+    for (int i = 0; i < table_pages; i++) {
+      trace.push_back(hot_pages + i);
+    }
+  }
+
+  LRUReplacer lru_replacer(pool_size);
+  LRUKReplacer lru_k_replacer(pool_size, 2);
+  // The table never fits in the pool, so only the lookups are counted.
+  double lru_hit_rate = ReplayHitRate(&lru_replacer, pool_size, trace, hot_pages);
+  double lru_k_hit_rate = ReplayHitRate(&lru_k_replacer, pool_size, trace, hot_pages);
+  std::cout << "references=" << trace.size() << " pool_size=" << pool_size << " lookup_hit_rate lru=" << lru_hit_rate
+            << " lru_k=" << lru_k_hit_rate << std::endl;
+  EXPECT_GT(lru_k_hit_rate, lru_hit_rate);
+}
+
+}  // namespace bustub
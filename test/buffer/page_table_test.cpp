@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <mutex>  // NOLINT
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+
+  // Scenario: random inserts and erases, with the table kept at most num_frames full, agree with std::unordered_map.
+  // Page ids spaced by powers of two collide a lot, which exercises the backward shift of Erase.
+  std::mt19937 rng(15445);
+  std::vector<page_id_t> candidates;
+  for (page_id_t page_id = 0; page_id < 256; page_id++) {
+    candidates.push_back(page_id);
+    candidates.push_back(page_id * 1024);
+  }
+  for (int i = 0; i < 100000; i++) {
+    page_id_t page_id = candidates[rng() % candidates.size()];
+    if (expected.count(page_id) != 0) {
+      EXPECT_TRUE(page_table.Erase(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < num_frames) {
+      auto frame_id = static_cast<frame_id_t>(rng() % num_frames);
+      page_table.Insert(page_id, frame_id);
+      expected.emplace(page_id, frame_id);
+    } else {
+      EXPECT_FALSE(page_table.Erase(page_id));
+    }
+    if (i % 1000 == 0) {
+      for (auto page_id : candidates) {
+        frame_id_t frame_id;
+        auto it = expected.find(page_id);
+        ASSERT_EQ(it != expected.end(), page_table.Find(page_id, &frame_id));
+        if (it != expected.end()) {
+          EXPECT_EQ(it->second, frame_id);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(expected.size(), page_table.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentFindTest) {
+  // One writer keeps inserting and erasing pages while readers look them up without a latch. A reader may miss a page,
+  // but must never get a wrong frame. Every page id maps to a single frame id here, so that is easy to check.
+  const size_t num_frames = 128;
+  const int num_readers = 3;
+  PageTable page_table(num_frames);
+  auto frame_of = [](page_id_t page_id) { return static_cast<frame_id_t>(page_id % 1000); };
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames / 2); page_id++) {
+    page_table.Insert(page_id, frame_of(page_id));
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> wrong{0};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&, tid]() {
+      std::mt19937 rng(tid);
+      while (!done) {
+        auto page_id = static_cast<page_id_t>(rng() % (num_frames * 4));
+        frame_id_t frame_id;
+        if (page_table.Find(page_id, &frame_id) && frame_id != frame_of(page_id)) {
+          wrong++;
+        }
+      }
+    });
+  }
+  std::mt19937 rng(0);
+  std::vector<page_id_t> resident;
+  for (int i = 0; i < 200000; i++) {
+    if (resident.size() == num_frames / 2 || (!resident.empty() && rng() % 2 == 0)) {
+      size_t index = rng() % resident.size();
+      EXPECT_TRUE(page_table.Erase(resident[index]));
+      resident[index] = resident.back();
+      resident.pop_back();
+    } else {
+      auto page_id = static_cast<page_id_t>(num_frames + rng() % (num_frames * 3));
+      if (!page_table.Contains(page_id)) {
+        page_table.Insert(page_id, frame_of(page_id));
+        resident.push_back(page_id);
+      }
+    }
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, wrong);
+
+  // The pages that were never touched by the writer are all still there.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames / 2); page_id++) {
+    frame_id_t frame_id;
+    ASSERT_TRUE(page_table.Find(page_id, &frame_id));
+    EXPECT_EQ(frame_of(page_id), frame_id);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, DISABLED_LookupBenchmark) {
+  // Buffer pool hits are page table lookups. Prints lookups per second over several threads, and the mean and 99th
+  // percentile latency of a batch of 64 lookups, for the latched std::unordered_map the buffer pool used to have and
+  // for the PageTable.
+  const size_t num_frames = 4096;
+  const int num_threads = std::max(4U, std::thread::hardware_concurrency());
+  const int batches_per_thread = 4000;
+  const int batch_size = 64;
+
+  std::unordered_map<page_id_t, frame_id_t> map;
+  std::mutex map_latch;
+  PageTable page_table(num_frames);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+    map.emplace(page_id * 3, page_id);
+    page_table.Insert(page_id * 3, page_id);
+  }
+
+  auto run = [&](const char *name, auto lookup) {
+    std::vector<std::vector<int64_t>> latencies(num_threads);
+    std::atomic<uint64_t> checksum{0};
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&, tid]() {
+        std::mt19937 rng(tid);
+        uint64_t sum = 0;
+        latencies[tid].reserve(batches_per_thread);
+        for (int batch = 0; batch < batches_per_thread; batch++) {
+          auto batch_start = std::chrono::steady_clock::now();
+          for (int i = 0; i < batch_size; i++) {
+            sum += lookup(static_cast<page_id_t>(rng() % (num_frames * 3)));
+          }
+          latencies[tid].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                       std::chrono::steady_clock::now() - batch_start)
+                                       .count());
+        }
+        checksum += sum;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::vector<int64_t> all;
+    for (auto &thread_latencies : latencies) {
+      all.insert(all.end(), thread_latencies.begin(), thread_latencies.end());
+    }
+    std::sort(all.begin(), all.end());
+    int64_t total = 0;
+    for (auto latency : all) {
+      total += latency;
+    }
+    std::cout << name << ": threads=" << num_threads << " lookups/s="
+              << static_cast<uint64_t>(num_threads * batches_per_thread * batch_size / elapsed.count())
+              << " batch_ns_mean=" << total / static_cast<int64_t>(all.size())
+              << " batch_ns_p99=" << all[all.size() * 99 / 100] << std::endl;
+    return checksum.load();
+  };
+
+  uint64_t map_sum = run("unordered_map", [&](page_id_t page_id) -> uint64_t {
+    std::lock_guard<std::mutex> guard(map_latch);
+    auto it = map.find(page_id);
+    return it == map.end() ? 0 : it->second;
+  });
+  uint64_t table_sum = run("page_table", [&](page_id_t page_id) -> uint64_t {
+    frame_id_t frame_id;
+    return page_table.Find(page_id, &frame_id) ? frame_id : 0;
+  });
+  EXPECT_EQ(map_sum, table_sum);
+}
+
+}  // namespace bustub
@@ -0,0 +1,222 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 5;
+  const size_t pool_size = 2;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  EXPECT_EQ(num_instances * pool_size, bpm->GetPoolSize());
+
+  // Scenario: Sequential page ids are spread over every instance, so the whole pool can be filled.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+  }
+
+  // Scenario: Once every frame is pinned, no new page can be created.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Unpinning the pages of a single instance is enough to create new pages, and the evicted pages must
+  // survive the round trip to disk.
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_TRUE(bpm->UnpinPage(5, true));
+  EXPECT_FALSE(bpm->UnpinPage(5, true));
+  for (int i = 0; i < 2; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, page_id_temp % static_cast<page_id_t>(num_instances));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+
+  // Scenario: A pinned page cannot be deleted, an unpinned one can.
+  EXPECT_FALSE(bpm->DeletePage(0));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->DeletePage(0));
+  EXPECT_FALSE(bpm->FlushPage(0));
+
+  bpm->FlushAllPages();
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ReusedPageIdTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 2;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (page_id_t i = 0; i < 16; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  for (page_id_t i = 16; i < 24; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: The free ids all belong to instance 0, which is full. The page goes to the only instance with room.
+  for (page_id_t page_id : {0, 4, 8, 12}) {
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+  }
+  EXPECT_TRUE(bpm->UnpinPage(17, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(25, page_id_temp);
+
+  // Scenario: The ids that were turned down are free again, and are reused once their instance has room.
+  EXPECT_FALSE(disk_manager->IsPageAllocated(0));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(24));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_TRUE(bpm->UnpinPage(16, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp);
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const int num_threads = 8;
+  const int pages_per_thread = 50;
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(4, 8, disk_manager);
+
+  std::vector<std::vector<page_id_t>> page_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, tid, &page_ids]() {
+      for (int i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        Page *page = bpm->NewPage(&page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm->NewPage(&page_id);
+        }
+        snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+        EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+        page_ids[tid].push_back(page_id);
+      }
+      for (auto page_id : page_ids[tid]) {
+        Page *page = bpm->FetchPage(page_id);
+        while (page == nullptr) {
+          std::this_thread::yield();
+          page = bpm->FetchPage(page_id);
+        }
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, DISABLED_ScalingBenchmark) {
+  // Every thread fetches and unpins random pages of a working set that fits in memory, so throughput is bounded by
+  // latch contention alone. Prints fetches per second for a growing number of instances with the same total size.
+  const std::string db_name = "parallel_bpm_bench.db";
+  const size_t total_frames = 256;
+  const int num_pages = 128;
+  const int num_threads = std::max(4U, std::thread::hardware_concurrency());
+  const auto duration = std::chrono::milliseconds(200);
+
+  for (size_t num_instances : {1, 2, 4, 8, 16}) {
+    auto *disk_manager = NewTestDiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, total_frames / num_instances, disk_manager);
+    for (int i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, true);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total_ops{0};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&, tid]() {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+        uint64_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          page_id_t page_id = dist(rng);
+          if (bpm->FetchPage(page_id) != nullptr) {
+            bpm->UnpinPage(page_id, false);
+            ops++;
+          }
+        }
+        total_ops += ops;
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::cout << "instances=" << num_instances << " threads=" << num_threads << " fetches/s="
+              << total_ops * 1000 / duration.count() << std::endl;
+
+    disk_manager->ShutDown();
+    remove(db_name.c_str());
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_test_util.h
+//
+// Identification: test/buffer/replacer_test_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/**
+ * Replays a page trace against a cache of pool_size frames that uses the given replacer, the same way the buffer pool
+ * manager drives it, and returns the fraction of references below max_page_id that were hits.
+ */
+inline double ReplayHitRate(Replacer *replacer, size_t pool_size, const std::vector<page_id_t> &trace,
+                            page_id_t max_page_id) {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_to_page(pool_size, INVALID_PAGE_ID);
+  std::list<frame_id_t> free_list;
+  for (size_t i = 0; i < pool_size; i++) {
+    free_list.push_back(static_cast<frame_id_t>(i));
+  }
+
+  size_t hits = 0;
+  size_t references = 0;
+  for (auto page_id : trace) {
+    frame_id_t frame_id;
+    references += page_id < max_page_id ? 1 : 0;
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      frame_id = it->second;
+      hits += page_id < max_page_id ? 1 : 0;
+    } else {
+      if (!free_list.empty()) {
+        frame_id = free_list.front();
+        free_list.pop_front();
+      } else {
+        EXPECT_TRUE(replacer->Victim(&frame_id));
+        page_table.erase(frame_to_page[frame_id]);
+      }
+      frame_to_page[frame_id] = page_id;
+      page_table[page_id] = frame_id;
+    }
+    replacer->RecordAccess(frame_id, page_id);
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return static_cast<double>(hits) / references;
+}
+
+}  // namespace bustub
@@ -0,0 +1,40 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_test_util.h
+//
+// Identification: test/include/storage/disk_manager_test_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdlib>
+#include <string>
+
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+
+namespace bustub {
+
+/** Environment variable that picks the disk manager of the tests; "memory" selects DiskManagerMemory. */
+static constexpr const char *TEST_DISK_MANAGER_ENV = "BUSTUB_TEST_DISK_MANAGER";
+
+/**
+ * Creates the disk manager a test runs against: a DiskManager on the given file, or a DiskManagerMemory without
+ * simulated latency if BUSTUB_TEST_DISK_MANAGER=memory, which takes the file system out of the tests and benchmarks.
+ * @param db_file the database file, unused in memory
+ * @return the disk manager, to be deleted by the caller
+ */
+inline DiskManager *NewTestDiskManager(const std::string &db_file) {
+  const char *type = std::getenv(TEST_DISK_MANAGER_ENV);
+  if (type != nullptr && std::string(type) == "memory") {
+    return new DiskManagerMemory();
+  }
+  return new DiskManager(db_file);
+}
+
+}  // namespace bustub
@@ -0,0 +1,201 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_disk_io_test.cpp
+//
+// Identification: test/storage/async_disk_io_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_disk_io.h"
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/** Writes num_pages pages as one batch of asynchronous requests, then reads them back as another. */
+static void ReadWriteBatch(DiskManager *dm, int num_pages) {
+  auto pages = std::make_unique<char[]>(static_cast<size_t>(num_pages) * PAGE_SIZE);
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(&pages[i * PAGE_SIZE], PAGE_SIZE, "page %d", i);
+  }
+
+  auto run = [&](bool is_write) {
+    auto remaining = std::make_shared<std::atomic<int>>(num_pages);
+    auto failed = std::make_shared<std::atomic<int>>(0);
+    auto done = std::make_shared<std::promise<void>>();
+    auto future = done->get_future();
+    std::vector<DiskRequest> requests;
+    for (int i = 0; i < num_pages; i++) {
+      requests.push_back({is_write, i, &pages[i * PAGE_SIZE], [remaining, failed, done](bool ok) {
+                            if (!ok) {
+                              (*failed)++;
+                            }
+                            if (--*remaining == 0) {
+                              done->set_value();
+                            }
+                          }});
+    }
+    dm->SubmitRequests(std::move(requests));
+    future.wait();
+    EXPECT_EQ(0, *failed);
+  };
+
+  run(true);
+  std::memset(pages.get(), 0, static_cast<size_t>(num_pages) * PAGE_SIZE);
+  run(false);
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ("page " + std::to_string(i), std::string(&pages[i * PAGE_SIZE]));
+  }
+}
+
+/** Writes num_pages contiguous pages from separate buffers as one request, then reads them back as another. */
+static void ReadWriteRun(DiskManager *dm, page_id_t first_page_id, int num_pages) {
+  auto pages = std::make_unique<Page[]>(num_pages);
+  for (int i = 0; i < num_pages; i++) {
+    snprintf(pages[i].GetData(), PAGE_SIZE, "run page %d", i);
+  }
+  for (bool is_write : {true, false}) {
+    DiskRequest request{is_write, first_page_id, pages[0].GetData(), nullptr};
+    for (int i = 1; i < num_pages; i++) {
+      request.more_data_.push_back(pages[i].GetData());
+    }
+    auto done = std::make_shared<std::promise<bool>>();
+    auto future = done->get_future();
+    request.callback_ = [done](bool ok) { done->set_value(ok); };
+    std::vector<DiskRequest> requests;
+    requests.push_back(std::move(request));
+    dm->SubmitRequests(std::move(requests));
+    EXPECT_TRUE(future.get());
+    if (is_write) {
+      for (int i = 0; i < num_pages; i++) {
+        std::memset(pages[i].GetData(), 0, PAGE_SIZE);
+      }
+    }
+  }
+  for (int i = 0; i < num_pages; i++) {
+    EXPECT_EQ("run page " + std::to_string(i), std::string(pages[i].GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncDiskIOTest, ThreadPoolTest) {
+  std::string db_file("async_disk_io_test.db");
+  DiskManager dm(db_file);
+  dm.SetAsyncIOBackend(AsyncIOBackendType::THREAD_POOL);
+  EXPECT_STREQ("thread_pool", dm.GetAsyncIOBackendName());
+
+  // Scenario: more requests than the queue depth in one batch.
+  ReadWriteBatch(&dm, ASYNC_IO_QUEUE_DEPTH * 4);
+  EXPECT_EQ(ASYNC_IO_QUEUE_DEPTH * 4, dm.GetNumWrites());
+
+  // Scenario: the future interface, including a page past the end of the file, which reads as zeros.
+  char buf[PAGE_SIZE];
+  EXPECT_TRUE(dm.ReadPageAsync(3, buf).get());
+  EXPECT_STREQ("page 3", buf);
+  EXPECT_TRUE(dm.ReadPageAsync(ASYNC_IO_QUEUE_DEPTH * 8, buf).get());
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: runs of pages in one request each, the second of which extends the file.
+  ReadWriteRun(&dm, 10, EXTENT_SIZE);
+  ReadWriteRun(&dm, ASYNC_IO_QUEUE_DEPTH * 4 - 2, 5);
+
+  dm.ShutDown();
+  remove(db_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncDiskIOTest, IoUringTest) {
+  std::string db_file("async_disk_io_test.db");
+  DiskManager dm(db_file, true);
+  auto io_uring = IoUringDiskIO::Open(&dm, -1);
+  if (io_uring == nullptr) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  io_uring.reset();
+  dm.SetAsyncIOBackend(AsyncIOBackendType::IO_URING);
+  EXPECT_STREQ("io_uring", dm.GetAsyncIOBackendName());
+
+  ReadWriteBatch(&dm, ASYNC_IO_QUEUE_DEPTH * 4);
+
+  // Scenario: writes and reads through futures, with an unaligned buffer, which direct I/O has to bounce.
+  alignas(DIRECT_IO_ALIGNMENT) char buf[PAGE_SIZE + 1];
+  std::memset(buf, 0, sizeof(buf));
+  snprintf(buf + 1, PAGE_SIZE, "unaligned");
+  EXPECT_TRUE(dm.WritePageAsync(7, buf + 1).get());
+  std::memset(buf, 0, sizeof(buf));
+  EXPECT_TRUE(dm.ReadPageAsync(7, buf).get());
+  EXPECT_STREQ("unaligned", buf);
+
+  ReadWriteRun(&dm, 10, EXTENT_SIZE);
+
+  dm.ShutDown();
+  remove(db_file.c_str());
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncDiskIOTest, DISABLED_ReadBenchmark) {
+  // Reads the same pages one blocking ReadPage at a time, and as batches of ASYNC_IO_QUEUE_DEPTH asynchronous reads
+  // with each backend. Prints pages read per second. The file is opened with O_DIRECT where possible, so that the
+  // reads reach the device rather than the page cache.
+  const int num_pages = 2048;
+  std::string db_file("async_disk_io_test.db");
+  for (auto type : {AsyncIOBackendType::THREAD_POOL, AsyncIOBackendType::IO_URING}) {
+    DiskManager dm(db_file, true);
+    auto buffers = std::make_unique<Page[]>(ASYNC_IO_QUEUE_DEPTH);
+    if (type == AsyncIOBackendType::THREAD_POOL) {
+      for (int i = 0; i < num_pages; i++) {
+        dm.WritePage(i, buffers[0].GetData());
+      }
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_pages; i++) {
+        dm.ReadPage(i, buffers[0].GetData());
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      std::cout << "sync: pages/s=" << static_cast<uint64_t>(num_pages / elapsed.count()) << std::endl;
+    }
+    if (type == AsyncIOBackendType::IO_URING && IoUringDiskIO::Open(&dm, -1) == nullptr) {
+      continue;
+    }
+    dm.SetAsyncIOBackend(type);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int first = 0; first < num_pages; first += ASYNC_IO_QUEUE_DEPTH) {
+      auto remaining = std::make_shared<std::atomic<int>>(ASYNC_IO_QUEUE_DEPTH);
+      auto done = std::make_shared<std::promise<void>>();
+      auto future = done->get_future();
+      std::vector<DiskRequest> requests;
+      for (int i = 0; i < ASYNC_IO_QUEUE_DEPTH; i++) {
+        requests.push_back({false, first + i, buffers[i].GetData(), [remaining, done](bool /* ok */) {
+                              if (--*remaining == 0) {
+                                done->set_value();
+                              }
+                            }});
+      }
+      dm.SubmitRequests(std::move(requests));
+      future.wait();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << dm.GetAsyncIOBackendName() << ": pages/s=" << static_cast<uint64_t>(num_pages / elapsed.count())
+              << std::endl;
+    dm.ShutDown();
+  }
+  remove(db_file.c_str());
+}
+
+}  // namespace bustub
@@ -0,0 +1,279 @@
+/**
+ * b_plus_tree_bulk_load_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/external_merge_sort.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+namespace {
+
+std::vector<std::pair<GenericKey<8>, RID>> MakePairs(const std::vector<int64_t> &keys) {
+  std::vector<std::pair<GenericKey<8>, RID>> pairs;
+  for (auto key : keys) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    pairs.emplace_back(index_key, RID(key));
+  }
+  return pairs;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 1000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+  auto pairs = MakePairs(keys);
+
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 3}, std::pair{5, 4}, std::pair{64, 64}}) {
+    for (double fill_factor : {1.0, 0.7, 0.1}) {
+      auto *disk_manager = NewTestDiskManager("test.db");
+      auto *bpm = new BufferPoolManager(50, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                               internal_max_size);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      EXPECT_EQ(num_keys, tree.BulkLoad(pairs.begin(), pairs.end(), fill_factor));
+
+      // Every leaf but the last two holds as many pairs as the fill factor asks for, or its min size.
+      int fill_size = std::clamp(static_cast<int>(fill_factor * (leaf_max_size - 1)), leaf_max_size / 2,
+                                 leaf_max_size - 1);
+      std::vector<int> leaf_sizes;
+      GenericKey<8> index_key;
+      Page *page = tree.FindLeafPage(index_key, true);
+      while (page != nullptr) {
+        auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+        leaf_sizes.push_back(leaf->GetSize());
+        page_id_t next_page_id = leaf->GetNextPageId();
+        bpm->UnpinPage(page->GetPageId(), false);
+        page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+      }
+      for (size_t i = 0; i + 2 < leaf_sizes.size(); i++) {
+        EXPECT_EQ(fill_size, leaf_sizes[i]);
+      }
+      for (int size : leaf_sizes) {
+        EXPECT_GE(size, leaf_max_size / 2);
+      }
+
+      std::vector<RID> rids;
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      }
+      int64_t current_key = 1;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+        current_key++;
+      }
+      EXPECT_EQ(num_keys + 1, current_key);
+
+      // The tree that was loaded takes inserts and removes like any other.
+      for (int64_t key = num_keys + 1; key <= 2 * num_keys; key++) {
+        index_key.SetFromInteger(key);
+        EXPECT_TRUE(tree.Insert(index_key, RID(key)));
+      }
+      for (int64_t key = 1; key <= 2 * num_keys; key += 2) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+      current_key = 2;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+        current_key += 2;
+      }
+      EXPECT_EQ(2 * num_keys + 2, current_key);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BadInputTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Input out of key order is rejected, and leaves the tree empty.
+  auto unsorted = MakePairs({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 9});
+  EXPECT_THROW(tree.BulkLoad(unsorted.begin(), unsorted.end()), Exception);
+  EXPECT_TRUE(tree.IsEmpty());
+
+  // A repeated key is loaded once.
+  auto repeated = MakePairs({1, 2, 2, 3, 3, 3, 4});
+  EXPECT_EQ(4, tree.BulkLoad(repeated.begin(), repeated.end()));
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(5, current_key);
+
+  // Only an empty tree can be loaded.
+  EXPECT_THROW(tree.BulkLoad(repeated.begin(), repeated.end()), Exception);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, ExternalMergeSortTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  // Scenario: with three pages of memory, the runs are merged two at a time until three are left.
+  {
+    ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, 3);
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      sort.Add(index_key, RID(key));
+    }
+    sort.Finish();
+    EXPECT_LT(static_cast<size_t>(num_keys / (3 * PAGE_SIZE / sizeof(std::pair<GenericKey<8>, RID>))),
+              sort.GetNumRunsWritten());
+    RID rid;
+    int64_t current_key = 0;
+    while (sort.Next(&index_key, &rid)) {
+      EXPECT_EQ(current_key, rid.GetSlotNum());
+      current_key++;
+    }
+    EXPECT_EQ(num_keys, current_key);
+  }
+
+  // Scenario: input that fits in memory is sorted there.
+  {
+    ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator);
+    GenericKey<8> index_key;
+    for (int64_t key = 100; key > 0; key--) {
+      index_key.SetFromInteger(key);
+      sort.Add(index_key, RID(key));
+    }
+    sort.Finish();
+    EXPECT_EQ(0, sort.GetNumRunsWritten());
+    RID rid;
+    int64_t current_key = 1;
+    while (sort.Next(&index_key, &rid)) {
+      EXPECT_EQ(current_key, rid.GetSlotNum());
+      current_key++;
+    }
+    EXPECT_EQ(101, current_key);
+  }
+
+  // Scenario: a sort that goes away before its output is read leaves no page pinned.
+  {
+    ExternalMergeSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, 3);
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      sort.Add(index_key, RID(key));
+    }
+    sort.Finish();
+  }
+  for (int i = 0; i < 50; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BuildFromTableTest) {
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::INTEGER)});
+  const int64_t num_tuples = 5000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_tuples; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  Transaction transaction(0);
+  TableHeap table(bpm, nullptr, nullptr, &transaction);
+  std::vector<RID> tuple_rids(num_tuples);
+  for (auto key : keys) {
+    Tuple tuple({Value(TypeId::BIGINT, key), Value(TypeId::INTEGER, static_cast<int32_t>(key % 7))}, &schema);
+    EXPECT_TRUE(table.InsertTuple(tuple, &tuple_rids[key], &transaction));
+  }
+
+  auto *metadata = new IndexMetadata("foo_pk", "foo", &schema, {0});
+  BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>> index(metadata, bpm);
+  EXPECT_EQ(num_tuples, index.BuildFromTable(&table, schema, &transaction));
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_tuples; key++) {
+    Tuple key_tuple({Value(TypeId::BIGINT, key)}, metadata->GetKeySchema());
+    rids.clear();
+    index.ScanKey(key_tuple, &rids, &transaction);
+    ASSERT_EQ(1, rids.size()) << key;
+    EXPECT_EQ(tuple_rids[key], rids[0]);
+  }
+  int64_t current_key = 0;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    EXPECT_EQ(tuple_rids[current_key], (*iterator).second);
+    current_key++;
+  }
+  EXPECT_EQ(num_tuples, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,331 @@
+/**
+ * b_plus_tree_compression_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+namespace {
+
+template <size_t KeySize>
+GenericKey<KeySize> MakeKey(const std::vector<int64_t> &columns, Schema *key_schema) {
+  std::vector<Value> values;
+  for (auto column : columns) {
+    values.emplace_back(TypeId::BIGINT, column);
+  }
+  GenericKey<KeySize> key;
+  key.SetFromKey(Tuple(values, key_schema));
+  return key;
+}
+
+/** @return the number of leaves and the number of levels of the tree */
+template <size_t KeySize>
+std::pair<int, int> CountPages(BPlusTree<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *tree,
+                               BufferPoolManager *bpm) {
+  GenericKey<KeySize> index_key{};
+  Page *page = tree->FindLeafPage(index_key, true);
+  int num_leaves = 0;
+  while (page != nullptr) {
+    auto *leaf =
+        reinterpret_cast<BPlusTreeLeafPage<GenericKey<KeySize>, RID, GenericComparator<KeySize>> *>(page->GetData());
+    num_leaves++;
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+  }
+
+  auto *header_page = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  page_id_t page_id;
+  EXPECT_TRUE(header_page->GetRootId("foo_pk", &page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  int height = 0;
+  while (true) {
+    height++;
+    page = bpm->FetchPage(page_id);
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool is_leaf = node->IsLeafPage();
+    if (!is_leaf) {
+      page_id = reinterpret_cast<BPlusTreeInternalPage<GenericKey<KeySize>, page_id_t, GenericComparator<KeySize>> *>(
+                    node)
+                    ->ValueAt(0);
+    }
+    bpm->UnpinPage(page->GetPageId(), false);
+    if (is_leaf) {
+      return {num_leaves, height};
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressionTest, FanOutTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema);
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: small integers in a 64 byte key share all but their low bytes, so a page holds twice as many of them as
+  // would fit whole, and sequential inserts, which leave every leaf half full, need about half as many leaves.
+  const int64_t num_keys = 20000;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    EXPECT_TRUE(tree.Insert(MakeKey<64>({key}, key_schema), RID(key)));
+  }
+  // What a leaf held before pages were compressed, with the high key and next page id in the header.
+  int64_t whole_leaf_size = (PAGE_SIZE - 28 - 64) / sizeof(std::pair<GenericKey<64>, RID>);
+  auto [num_leaves, height] = CountPages<64>(&tree, bpm);
+  EXPECT_LE(num_leaves, num_keys / (whole_leaf_size / 2) * 6 / 10);
+  EXPECT_GE(3, height);
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(MakeKey<64>({key}, key_schema), &rids)) << key;
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(num_keys + 1, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressionTest, SeparatorTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint,b bigint");
+  GenericComparator<16> comparator(key_schema);
+
+  // The columns after the first one that tells the keys apart are zeroed, unless that puts the separator past the
+  // key on the right.
+  auto separator = comparator.Separator(MakeKey<16>({1, 5}, key_schema), MakeKey<16>({2, 7}, key_schema));
+  EXPECT_EQ(0, comparator(MakeKey<16>({2, 0}, key_schema), separator));
+  separator = comparator.Separator(MakeKey<16>({1, 5}, key_schema), MakeKey<16>({1, 7}, key_schema));
+  EXPECT_EQ(0, comparator(MakeKey<16>({1, 7}, key_schema), separator));
+  separator = comparator.Separator(MakeKey<16>({1, 5}, key_schema), MakeKey<16>({2, -3}, key_schema));
+  EXPECT_EQ(0, comparator(MakeKey<16>({2, -3}, key_schema), separator));
+
+  // Scenario: every leaf split falls between two values of the first column, so every separator in the tree is
+  // truncated.
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", bpm, comparator, 4, 4);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 500;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    EXPECT_TRUE(tree.Insert(MakeKey<16>({key, key * 7 + 1}, key_schema), RID(key)));
+  }
+
+  using InternalPage = BPlusTreeInternalPage<GenericKey<16>, page_id_t, GenericComparator<16>>;
+  auto *header = static_cast<HeaderPage *>(bpm->FetchPage(HEADER_PAGE_ID));
+  EXPECT_TRUE(header->GetRootId("foo_pk", &page_id));
+  bpm->UnpinPage(HEADER_PAGE_ID, false);
+  std::vector<page_id_t> pages{page_id};
+  int num_separators = 0;
+  while (!pages.empty()) {
+    Page *page = bpm->FetchPage(pages.back());
+    pages.pop_back();
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (!node->IsLeafPage()) {
+      auto *inner = reinterpret_cast<InternalPage *>(node);
+      for (int i = 0; i < inner->GetSize(); i++) {
+        pages.push_back(inner->ValueAt(i));
+        if (i > 0) {
+          EXPECT_EQ(0, inner->KeyAt(i).ToValue(key_schema, 1).template GetAs<int64_t>());
+          num_separators++;
+        }
+      }
+    }
+    bpm->UnpinPage(page->GetPageId(), false);
+  }
+  EXPECT_LT(num_keys / 4, num_separators);
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(MakeKey<16>({key, key * 7 + 1}, key_schema), &rids)) << key;
+    EXPECT_FALSE(tree.GetValue(MakeKey<16>({key, 0}, key_schema), &rids)) << key;
+  }
+  for (int64_t key = 1; key <= num_keys; key += 2) {
+    tree.Remove(MakeKey<16>({key, key * 7 + 1}, key_schema));
+  }
+  int64_t current_key = 2;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+  }
+  EXPECT_EQ(num_keys + 2, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressionTest, MixedWidthTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint,b bigint,c bigint,d bigint");
+  GenericComparator<32> comparator(key_schema);
+
+  for (auto latching : {BPlusTreeLatching::CRABBING, BPlusTreeLatching::B_LINK}) {
+    auto *disk_manager = NewTestDiskManager("test.db");
+    auto *bpm = new BufferPoolManager(50, disk_manager);
+    // The max sizes are clamped to what the pages can hold.
+    BPlusTree<GenericKey<32>, RID, GenericComparator<32>> tree("foo_pk", bpm, comparator, PAGE_SIZE, PAGE_SIZE,
+                                                               latching);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Scenario: keys that differ only in their last column pack the pages past what would fit whole, then keys that
+    // have nothing in common with them widen the slots, and the pages split before they take them.
+    const int64_t num_keys = 6000;
+    std::mt19937_64 random(0);
+    std::vector<std::vector<int64_t>> keys;
+    for (int64_t i = 0; i < num_keys; i++) {
+      if (i < num_keys / 2) {
+        keys.push_back({0, 0, 0, i * 2});
+      } else {
+        keys.push_back({static_cast<int64_t>(random() % 3), static_cast<int64_t>(random()),
+                        static_cast<int64_t>(random()), static_cast<int64_t>(random())});
+      }
+    }
+    for (int64_t i = 0; i < num_keys; i++) {
+      EXPECT_TRUE(tree.Insert(MakeKey<32>(keys[i], key_schema), RID(i)));
+    }
+    EXPECT_FALSE(tree.Insert(MakeKey<32>(keys[num_keys - 1], key_schema), RID(0)));
+
+    std::vector<RID> rids;
+    for (int64_t i = 0; i < num_keys; i++) {
+      rids.clear();
+      ASSERT_TRUE(tree.GetValue(MakeKey<32>(keys[i], key_schema), &rids)) << i;
+      EXPECT_EQ(RID(i), rids[0]);
+    }
+
+    // Removing in a random order merges and redistributes pages of either kind of key.
+    std::vector<int64_t> order(num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+      order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+    order.resize(num_keys * 3 / 4);
+    for (auto i : order) {
+      tree.Remove(MakeKey<32>(keys[i], key_schema));
+    }
+    std::vector<bool> is_removed(num_keys, false);
+    for (auto i : order) {
+      is_removed[i] = true;
+    }
+
+    size_t num_left = 0;
+    GenericKey<32> prev_key;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      int64_t i = (*iterator).second.GetSlotNum();
+      EXPECT_FALSE(is_removed[i]) << i;
+      if (num_left > 0) {
+        EXPECT_LT(comparator(prev_key, (*iterator).first), 0);
+      }
+      prev_key = (*iterator).first;
+      num_left++;
+    }
+    EXPECT_EQ(num_keys - order.size(), num_left);
+    for (int64_t i = 0; i < num_keys; i++) {
+      rids.clear();
+      EXPECT_EQ(!is_removed[i], tree.GetValue(MakeKey<32>(keys[i], key_schema), &rids)) << i;
+    }
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeCompressionTest, ConcurrentMixedWidthTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint,b bigint,c bigint,d bigint");
+  GenericComparator<32> comparator(key_schema);
+
+  for (auto latching : {BPlusTreeLatching::CRABBING, BPlusTreeLatching::B_LINK}) {
+    auto *disk_manager = NewTestDiskManager("test.db");
+    auto *bpm = new BufferPoolManager(50, disk_manager);
+    // The max sizes are clamped to what the pages can hold.
+    BPlusTree<GenericKey<32>, RID, GenericComparator<32>> tree("foo_pk", bpm, comparator, PAGE_SIZE, PAGE_SIZE,
+                                                               latching);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    // Every thread inserts keys that share a prefix with the others' as well as keys that do not.
+    const int num_threads = 4;
+    const int64_t keys_per_thread = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937_64 random(t);
+        for (int64_t i = 0; i < keys_per_thread; i++) {
+          int64_t id = t * keys_per_thread + i;
+          auto wide = static_cast<int64_t>(random() % 2 == 0 ? 0 : random());
+          tree.Insert(MakeKey<32>({0, wide, wide, id}, key_schema), RID(id));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    int64_t num_pairs = 0;
+    GenericKey<32> prev_key;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      if (num_pairs > 0) {
+        EXPECT_LT(comparator(prev_key, (*iterator).first), 0);
+      }
+      prev_key = (*iterator).first;
+      num_pairs++;
+    }
+    EXPECT_EQ(num_threads * keys_per_thread, num_pairs);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -2,14 +2,19 @@
  * b_plus_tree_test.cpp
  */
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <iostream>
+#include <random>
 #include <thread>                   // NOLINT
 #include "b_plus_tree_test_util.h"  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
 #include "storage/index/b_plus_tree.h"
 
 namespace bustub {
@@ -92,12 +97,12 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
-  DiskManager *disk_manager = new DiskManager("test.db");
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
@@ -145,11 +150,11 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
-  DiskManager *disk_manager = new DiskManager("test.db");
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
@@ -197,12 +202,12 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
-  DiskManager *disk_manager = new DiskManager("test.db");
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
@@ -240,12 +245,12 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
-  DiskManager *disk_manager = new DiskManager("test.db");
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
@@ -284,12 +289,12 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   Schema *key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema);
 
-  DiskManager *disk_manager = new DiskManager("test.db");
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
   BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
   // create b+ tree
   BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
@@ -330,4 +335,359 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, SmallPagesMixTest) {
+  // With tiny pages nearly every insert and remove splits or merges, so the writers take the pessimistic path all
+  // the time, while readers look keys up and scan the leaves underneath them.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int num_threads = 4;
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  std::atomic<bool> stop{false};
+  std::thread reader([&]() {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    while (!stop) {
+      int64_t previous_key = 0;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(previous_key, key);
+        previous_key = key;
+      }
+      rids.clear();
+      index_key.SetFromInteger(num_keys / 2);
+      tree.GetValue(index_key, &rids);
+    }
+  });
+
+  LaunchParallelTest(num_threads, InsertHelperSplit, &tree, keys, num_threads);
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 1; key <= num_keys; key += 2) {
+    remove_keys.push_back(key);
+  }
+  LaunchParallelTest(num_threads, DeleteHelperSplit, &tree, remove_keys, num_threads);
+  stop = true;
+  reader.join();
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key % 2 == 0, tree.GetValue(index_key, &rids)) << key;
+  }
+  int64_t current_key = 2;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 2;
+  }
+  EXPECT_EQ(num_keys + 2, current_key);
+
+  // Removing the rest empties the tree, which can then grow again.
+  remove_keys.clear();
+  for (int64_t key = 2; key <= num_keys; key += 2) {
+    remove_keys.push_back(key);
+  }
+  LaunchParallelTest(num_threads, DeleteHelperSplit, &tree, remove_keys, num_threads);
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_TRUE(tree.begin() == tree.end());
+  InsertHelper(&tree, {42});
+  rids.clear();
+  index_key.SetFromInteger(42);
+  EXPECT_TRUE(tree.GetValue(index_key, &rids));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, BLinkMixTest) {
+  // In B-link mode readers hold one latch at a time, so they keep running into pages that were split after they left
+  // the parent. Keys that were in the tree all along must be found regardless.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = NewTestDiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3, BPlusTreeLatching::B_LINK);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int num_threads = 4;
+  const int64_t num_keys = 4000;
+  std::vector<int64_t> even_keys;
+  std::vector<int64_t> odd_keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    (key % 2 == 0 ? even_keys : odd_keys).push_back(key);
+  }
+  std::shuffle(even_keys.begin(), even_keys.end(), std::mt19937(0));
+  std::shuffle(odd_keys.begin(), odd_keys.end(), std::mt19937(1));
+  InsertHelper(&tree, even_keys);
+
+  std::atomic<bool> stop{false};
+  std::thread reader([&]() {
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<int64_t> key_dist(1, num_keys / 2);
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    while (!stop) {
+      int64_t key = key_dist(rng) * 2;
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+      int64_t previous_key = 0;
+      int64_t num_even = 0;
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        int64_t current_key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(previous_key, current_key);
+        previous_key = current_key;
+        num_even += current_key <= num_keys && current_key % 2 == 0 ? 1 : 0;
+      }
+      EXPECT_EQ(num_keys / 2, num_even);
+    }
+  });
+
+  // Half of the writers append to the right end, the other half insert at random.
+  std::vector<int64_t> appended_keys;
+  for (int64_t key = num_keys + 1; key <= 2 * num_keys; key++) {
+    appended_keys.push_back(key);
+  }
+  std::thread appender([&]() { InsertHelper(&tree, appended_keys); });
+  LaunchParallelTest(num_threads, InsertHelperSplit, &tree, odd_keys, num_threads);
+  appender.join();
+  LaunchParallelTest(num_threads, DeleteHelperSplit, &tree, appended_keys, num_threads);
+  stop = true;
+  reader.join();
+
+  std::vector<RID> rids;
+  GenericKey<8> index_key;
+  for (int64_t key = 1; key <= 2 * num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key <= num_keys, tree.GetValue(index_key, &rids)) << key;
+  }
+  int64_t current_key = 1;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(num_keys + 1, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, BLinkAppendTest) {
+  // Every thread appends increasing keys from a single leaf root on, so they all split the right most page at once,
+  // including pages split off the root before the new root is installed.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int num_threads = 8;
+  const int64_t num_keys = 100;
+
+  for (int round = 0; round < 500; round++) {
+    auto *disk_manager = NewTestDiskManager("test.db");
+    auto *bpm = new BufferPoolManager(256, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3,
+                                                             BPlusTreeLatching::B_LINK);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    std::vector<int64_t> first_key{0};
+    InsertHelper(&tree, first_key);
+
+    std::atomic<int64_t> next_key{1};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&, tid]() {
+        Transaction transaction(tid);
+        GenericKey<8> index_key;
+        for (int64_t key = next_key++; key < num_keys; key = next_key++) {
+          index_key.SetFromInteger(key);
+          EXPECT_TRUE(tree.Insert(index_key, RID(key), &transaction)) << key;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (int64_t key = 0; key < num_keys; key++) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids)) << key;
+    }
+    int64_t current_key = 0;
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+      EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+      current_key++;
+    }
+    EXPECT_EQ(num_keys, current_key);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, DISABLED_ScalingBenchmark) {
+  // Every thread runs a mix of 80% lookups, 10% inserts and 10% removes of random keys on a tree that fits in memory,
+  // so throughput is bounded by latching. Prints operations per second for a growing number of threads.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const int64_t num_keys = 20000;
+  const auto duration = std::chrono::milliseconds(200);
+
+  for (int num_threads : {1, 2, 4, 8}) {
+    auto *disk_manager = NewTestDiskManager("test.db");
+    auto *bpm = new BufferPoolManager(256, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 64, 64);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < num_keys; key += 2) {
+      keys.push_back(key);
+    }
+    InsertHelper(&tree, keys);
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> total_ops{0};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+      threads.emplace_back([&, tid]() {
+        std::mt19937 rng(tid);
+        std::uniform_int_distribution<int64_t> key_dist(0, num_keys - 1);
+        std::uniform_int_distribution<int> op_dist(0, 9);
+        Transaction transaction(tid);
+        GenericKey<8> index_key;
+        std::vector<RID> rids;
+        uint64_t ops = 0;
+        while (!stop.load(std::memory_order_relaxed)) {
+          int64_t key = key_dist(rng);
+          index_key.SetFromInteger(key);
+          int op = op_dist(rng);
+          if (op == 0) {
+            tree.Insert(index_key, RID(key), &transaction);
+          } else if (op == 1) {
+            tree.Remove(index_key, &transaction);
+          } else {
+            rids.clear();
+            tree.GetValue(index_key, &rids);
+          }
+          ops++;
+        }
+        total_ops += ops;
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    std::cout << "threads=" << num_threads << " ops/s=" << total_ops * 1000 / duration.count() << std::endl;
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, DISABLED_AppendBenchmark) {
+  // Every thread appends increasing keys, as a time series index does, while as many threads look up recent keys, so
+  // all writers split the right most leaf and its ancestors. Prints operations per second for both latching modes.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  const auto duration = std::chrono::milliseconds(200);
+
+  for (auto latching : {BPlusTreeLatching::CRABBING, BPlusTreeLatching::B_LINK}) {
+    for (int num_threads : {1, 2, 4}) {
+      auto *disk_manager = NewTestDiskManager("test.db");
+      auto *bpm = new BufferPoolManager(1024, disk_manager);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 64, 64, latching);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      std::atomic<int64_t> next_key{0};
+      std::atomic<bool> stop{false};
+      std::atomic<uint64_t> total_ops{0};
+      std::vector<std::thread> threads;
+      for (int tid = 0; tid < 2 * num_threads; tid++) {
+        threads.emplace_back([&, tid]() {
+          std::mt19937 rng(tid);
+          Transaction transaction(tid);
+          GenericKey<8> index_key;
+          std::vector<RID> rids;
+          uint64_t ops = 0;
+          while (!stop.load(std::memory_order_relaxed)) {
+            if (tid % 2 == 0) {
+              int64_t key = next_key++;
+              index_key.SetFromInteger(key);
+              tree.Insert(index_key, RID(key), &transaction);
+            } else {
+              int64_t last_key = next_key.load();
+              int64_t key = last_key - std::uniform_int_distribution<int64_t>(0, 1000)(rng) % (last_key + 1);
+              rids.clear();
+              index_key.SetFromInteger(key);
+              tree.GetValue(index_key, &rids);
+            }
+            ops++;
+          }
+          total_ops += ops;
+        });
+      }
+      std::this_thread::sleep_for(duration);
+      stop = true;
+      for (auto &thread : threads) {
+        thread.join();
+      }
+
+      std::cout << (latching == BPlusTreeLatching::B_LINK ? "b-link" : "crabbing") << " threads=" << 2 * num_threads
+                << " ops/s=" << total_ops * 1000 / duration.count() << std::endl;
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
 }  // namespace bustub
@@ -0,0 +1,259 @@
+/**
+ * b_plus_tree_key_search_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/page/b_plus_tree_key_search.h"
+
+namespace bustub {
+
+namespace {
+
+template <typename IntegerType>
+void CheckSearch(std::mt19937 *rng) {
+  std::uniform_int_distribution<IntegerType> dist(std::numeric_limits<IntegerType>::min(),
+                                                  std::numeric_limits<IntegerType>::max());
+  for (int size = 0; size <= 100; size++) {
+    std::vector<IntegerType> keys;
+    for (int i = 0; i < size; i++) {
+      // Few distinct keys, so that many of them are equal to the one searched for.
+      keys.push_back(i % 3 == 0 ? dist(*rng) : dist(*rng) % 8);
+    }
+    keys.push_back(std::numeric_limits<IntegerType>::min());
+    keys.push_back(std::numeric_limits<IntegerType>::max());
+    std::sort(keys.begin(), keys.end());
+
+    // The keys of a page follow its header, so they need not be aligned.
+    std::vector<char> buffer(1 + keys.size() * sizeof(IntegerType));
+    memcpy(buffer.data() + 1, keys.data(), keys.size() * sizeof(IntegerType));
+    const char *data = buffer.data() + 1;
+    int end = static_cast<int>(keys.size());
+
+    std::vector<IntegerType> targets = keys;
+    for (int i = 0; i < 8; i++) {
+      targets.push_back(dist(*rng) % 8);
+    }
+    for (IntegerType target : targets) {
+      for (int begin : {0, 1}) {
+        EXPECT_EQ(std::lower_bound(keys.begin() + begin, keys.end(), target) - keys.begin(),
+                  SearchIntegerKeys<false>(data, begin, end, target));
+        EXPECT_EQ(std::upper_bound(keys.begin() + begin, keys.end(), target) - keys.begin(),
+                  SearchIntegerKeys<true>(data, begin, end, target));
+      }
+    }
+  }
+}
+
+template <size_t KeySize>
+GenericKey<KeySize> MakeKey(int64_t key) {
+  GenericKey<KeySize> index_key;
+  auto value = static_cast<typename IntegerComparator<KeySize>::IntegerType>(key);
+  memcpy(index_key.data_, &value, KeySize);
+  return index_key;
+}
+
+/** Fills a leaf with even keys, and prints how many searches of it for random keys take a second. */
+template <typename KeyComparator>
+void SearchLeaf(const char *name, const KeyComparator &comparator, int num_searches) {
+  std::vector<char> data(PAGE_SIZE);
+  auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, KeyComparator> *>(data.data());
+  leaf->Init(INVALID_PAGE_ID);
+  for (int64_t key = 0; leaf->GetSize() + 1 < leaf->GetMaxSize() && leaf->CanInsert(MakeKey<8>(2 * key)); key++) {
+    leaf->Insert(MakeKey<8>(2 * key), RID(key), comparator);
+  }
+  std::mt19937 rng(1);
+  int64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_searches; i++) {
+    sum += leaf->KeyIndex(MakeKey<8>(rng() % (2 * leaf->GetSize())), comparator);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_LT(0, sum);
+  std::cout << name << ": pairs=" << leaf->GetSize()
+            << " leaf_searches/s=" << static_cast<uint64_t>(num_searches / elapsed.count()) << std::endl;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, SearchTest) {
+  std::mt19937 rng(0);
+  CheckSearch<int32_t>(&rng);
+  CheckSearch<int64_t>(&rng);
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, IntegerTreeTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  IntegerComparator<8> comparator(key_schema);
+  const int64_t num_keys = 10000;
+
+  // The max sizes of PAGE_SIZE are clamped to what the pages can hold.
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 3}, std::pair{PAGE_SIZE, PAGE_SIZE}}) {
+    for (auto latching : {BPlusTreeLatching::CRABBING, BPlusTreeLatching::B_LINK}) {
+      auto *disk_manager = NewTestDiskManager("test.db");
+      auto *bpm = new BufferPoolManager(50, disk_manager);
+      BPlusTree<GenericKey<8>, RID, IntegerComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                               internal_max_size, latching);
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // Negative keys sort before positive ones, which they would not as unsigned bytes.
+      std::vector<int64_t> keys;
+      for (int64_t key = -num_keys; key < num_keys; key += 2) {
+        keys.push_back(key * 1000003);
+      }
+      std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+      for (auto key : keys) {
+        EXPECT_TRUE(tree.Insert(MakeKey<8>(key), RID(key)));
+      }
+      EXPECT_FALSE(tree.Insert(MakeKey<8>(keys[0]), RID(0)));
+
+      std::vector<RID> rids;
+      for (auto key : keys) {
+        rids.clear();
+        EXPECT_TRUE(tree.GetValue(MakeKey<8>(key), &rids)) << key;
+        rids.clear();
+        EXPECT_FALSE(tree.GetValue(MakeKey<8>(key + 1), &rids)) << key;
+      }
+      std::sort(keys.begin(), keys.end());
+      auto expected = keys.begin();
+      for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+        ASSERT_NE(keys.end(), expected);
+        EXPECT_EQ(*expected, IntegerComparator<8>::ToInteger((*iterator).first));
+        expected++;
+      }
+      EXPECT_EQ(keys.end(), expected);
+      EXPECT_EQ(2 * 1000003, IntegerComparator<8>::ToInteger((*tree.Begin(MakeKey<8>(1))).first));
+
+      // Remove all keys but the multiples of 4.
+      for (auto key : keys) {
+        if (key % 4 != 0) {
+          tree.Remove(MakeKey<8>(key));
+        }
+      }
+      for (auto key : keys) {
+        rids.clear();
+        EXPECT_EQ(key % 4 == 0, tree.GetValue(MakeKey<8>(key), &rids)) << key;
+      }
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete bpm;
+      delete disk_manager;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+  delete key_schema;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, IntegerIndexTest) {
+  auto *disk_manager = NewTestDiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  Schema schema({Column("a", TypeId::INTEGER)});
+  auto *metadata = new IndexMetadata("foo_pk", "foo", &schema, {0});
+  BPlusTreeIndex<GenericKey<4>, RID, IntegerComparator<4>> index(metadata, bpm);
+  Transaction transaction(0);
+  const int32_t num_keys = 5000;
+  for (int32_t key = -num_keys; key < num_keys; key++) {
+    index.InsertEntry(Tuple({Value(TypeId::INTEGER, key)}, &schema), RID(key), &transaction);
+  }
+
+  std::vector<RID> rids;
+  for (int32_t key = -num_keys; key < num_keys; key++) {
+    rids.clear();
+    index.ScanKey(Tuple({Value(TypeId::INTEGER, key)}, &schema), &rids, &transaction);
+    ASSERT_EQ(1, rids.size()) << key;
+    EXPECT_EQ(RID(key), rids[0]);
+  }
+  int32_t current_key = -num_keys;
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    EXPECT_EQ(current_key, IntegerComparator<4>::ToInteger((*iterator).first));
+    current_key++;
+  }
+  EXPECT_EQ(num_keys, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeKeySearchTest, DISABLED_LookupBenchmark) {
+  // Random lookups of BIGINT keys in a tree that fits in memory, and searches of a single full leaf. Prints lookups
+  // and searches per second with GenericComparator, which compares keys one at a time through Value, and with
+  // IntegerComparator, whose pages are searched with SIMD compares.
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  const int64_t num_keys = 100000;
+  const int num_lookups = 200000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+
+  auto run = [&](const char *name, auto *tree) {
+    for (auto key : keys) {
+      tree->Insert(MakeKey<8>(key), RID(key));
+    }
+    std::mt19937 rng(1);
+    std::vector<RID> rids;
+    int found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; i++) {
+      rids.clear();
+      found += tree->GetValue(MakeKey<8>(rng() % num_keys), &rids);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(num_lookups, found);
+    std::cout << name << ": lookups/s=" << static_cast<uint64_t>(num_lookups / elapsed.count()) << std::endl;
+  };
+
+  for (int i = 0; i < 2; i++) {
+    auto *disk_manager = NewTestDiskManager("test.db");
+    auto *bpm = new BufferPoolManager(1024, disk_manager);
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+    if (i == 0) {
+      GenericComparator<8> comparator(key_schema);
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+      run("GenericComparator", &tree);
+      SearchLeaf("GenericComparator", comparator, num_lookups);
+    } else {
+      IntegerComparator<8> comparator(key_schema);
+      BPlusTree<GenericKey<8>, RID, IntegerComparator<8>> tree("foo_pk", bpm, comparator);
+      run("IntegerComparator", &tree);
+      SearchLeaf("IntegerComparator", comparator, num_lookups);
+    }
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete bpm;
+    delete disk_manager;
+    remove("test.db");
+    remove("test.log");
+  }
+  delete key_schema;
+}
+
+}  // namespace bustub
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory_test.cpp
+//
+// Identification: test/storage/disk_manager_memory_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, ReadWritePageTest) {
+  DiskManagerMemory dm;
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: a page that was never written reads as zeros; only written pages take memory.
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(1000, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+  dm.WritePage(0, data);
+  dm.WritePage(1000, data);
+  dm.ReadPage(1000, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(2 * PAGE_SIZE, dm.GetMemoryUsage());
+  EXPECT_EQ(2, dm.GetNumWrites());
+
+  // Scenario: pages are allocated and reused as with a file.
+  EXPECT_EQ(0, dm.AllocatePage());
+  EXPECT_EQ(1, dm.AllocatePage());
+  dm.DeallocatePage(0);
+  EXPECT_EQ(0, dm.AllocatePage());
+
+  // Scenario: asynchronous requests, including a run of pages.
+  Page pages[3];
+  DiskRequest request{true, 5, pages[0].GetData(), nullptr, {pages[1].GetData(), pages[2].GetData()}};
+  snprintf(pages[2].GetData(), PAGE_SIZE, "page 7");
+  auto done = std::make_shared<std::promise<bool>>();
+  auto future = done->get_future();
+  request.callback_ = [done](bool ok) { done->set_value(ok); };
+  std::vector<DiskRequest> requests;
+  requests.push_back(std::move(request));
+  dm.SubmitRequests(std::move(requests));
+  EXPECT_TRUE(future.get());
+  EXPECT_TRUE(dm.ReadPageAsync(7, buf).get());
+  EXPECT_STREQ("page 7", buf);
+  EXPECT_STREQ("thread_pool", dm.GetAsyncIOBackendName());
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, ReadWriteLogTest) {
+  DiskManagerMemory dm;
+  char buf[16] = {0};
+  char data[16] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  EXPECT_FALSE(dm.ReadLog(buf, sizeof(buf), 0));
+  dm.WriteLog(data, sizeof(data));
+  dm.WriteLog(data, 0);
+  EXPECT_EQ(1, dm.GetNumFlushes());
+  EXPECT_TRUE(dm.ReadLog(buf, sizeof(buf), 0));
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  // A read past the end of the log is padded with zeros.
+  EXPECT_TRUE(dm.ReadLog(buf, sizeof(buf), 2));
+  EXPECT_STREQ("test string.", buf);
+  EXPECT_FALSE(dm.ReadLog(buf, sizeof(buf), sizeof(data)));
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, BufferPoolTest) {
+  // Scenario: the buffer pool runs on top of it unchanged, with its page cleaner and read-ahead.
+  DiskManagerMemory dm(DiskLatencyProfile::Nvme());
+  BufferPoolManager bpm(10, &dm);
+  bpm.StartPageCleaner(3);
+  const int num_pages = 100;
+  for (int i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm.NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_TRUE(bpm.UnpinPage(page_id, true));
+  }
+  bpm.PrefetchPages({0, 1, 2, 3});
+  for (int i = 0; i < num_pages; i++) {
+    auto guard = bpm.FetchPageRead(i);
+    ASSERT_FALSE(guard.IsEmpty());
+    EXPECT_EQ("page " + std::to_string(i), std::string(guard.GetData()));
+  }
+  bpm.StopPageCleaner();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, LatencyProfileTest) {
+  // Scenario: random reads from a hard disk pay a seek each; sequential ones do not.
+  DiskManagerMemory dm(DiskLatencyProfile::Hdd());
+  char buf[PAGE_SIZE];
+  const int num_reads = 8;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= num_reads; i++) {
+    dm.ReadPage(i * 1000, buf);
+  }
+  auto random = std::chrono::steady_clock::now() - start;
+  EXPECT_LE(DiskLatencyProfile::Hdd().seek_latency_ * num_reads, random);
+
+  start = std::chrono::steady_clock::now();
+  for (int i = 1; i <= num_reads; i++) {
+    dm.ReadPage(num_reads * 1000 + i, buf);
+  }
+  auto sequential = std::chrono::steady_clock::now() - start;
+  EXPECT_LT(sequential, random / 2);
+
+  // Scenario: without a profile nothing waits.
+  dm.SetLatencyProfile(DiskLatencyProfile::None());
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_reads; i++) {
+    dm.ReadPage(i * 1000, buf);
+  }
+  EXPECT_LT(std::chrono::steady_clock::now() - start, random / 2);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, DISABLED_ProfileBenchmark) {
+  // Fetches random pages of a 1000-page database through a 64-frame pool, so that nearly every fetch misses, on each
+  // device profile. Prints fetches per second; unlike a file-backed run, the numbers do not depend on the machine's
+  // disk or page cache.
+  const int num_pages = 1000;
+  const std::pair<const char *, DiskLatencyProfile> profiles[] = {{"memory", DiskLatencyProfile::None()},
+                                                                  {"nvme", DiskLatencyProfile::Nvme()},
+                                                                  {"sata_ssd", DiskLatencyProfile::SataSsd()},
+                                                                  {"hdd", DiskLatencyProfile::Hdd()}};
+  for (const auto &[name, profile] : profiles) {
+    DiskManagerMemory dm;
+    {
+      BufferPoolManager bpm(64, &dm);
+      for (int i = 0; i < num_pages; i++) {
+        page_id_t page_id;
+        bpm.NewPage(&page_id);
+        bpm.UnpinPage(page_id, true);
+      }
+      bpm.FlushAllPages();
+    }
+    dm.SetLatencyProfile(profile);
+    BufferPoolManager bpm(64, &dm);
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    const int num_fetches = profile.seek_latency_.count() > 0 ? 100 : 2000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; i++) {
+      auto guard = bpm.FetchPageRead(dist(rng));
+      EXPECT_FALSE(guard.IsEmpty());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << name << ": fetches/s=" << static_cast<uint64_t>(num_fetches / elapsed.count()) << std::endl;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_test.cpp
+//
+// Identification: test/storage/free_space_map_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class FreeSpaceMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("free_space_map_test.db");
+    remove("free_space_map_test.fsm");
+    remove("free_space_map_test.log");
+  }
+
+  void TearDown() override { SetUp(); }
+
+  static std::string ReadFile(const std::string &file_name) {
+    std::ifstream in(file_name, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  }
+
+  static void WriteFile(const std::string &file_name, const std::string &content) {
+    std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+    out << content;
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(FreeSpaceMapTest, ReuseTest) {
+  FreeSpaceMap fsm("free_space_map_test.fsm", 0);
+  for (page_id_t i = 0; i < 200; i++) {
+    EXPECT_EQ(i, fsm.Allocate());
+  }
+  EXPECT_EQ(200, fsm.GetNumPages());
+
+  // Scenario: freed ids are handed out again, lowest first, before the high-water mark moves.
+  fsm.Deallocate(150);
+  fsm.Deallocate(7);
+  fsm.Deallocate(7);
+  fsm.Deallocate(300);
+  EXPECT_FALSE(fsm.IsAllocated(7));
+  EXPECT_EQ(2, fsm.GetNumFreePages());
+  EXPECT_EQ(7, fsm.Allocate());
+  EXPECT_EQ(150, fsm.Allocate());
+  EXPECT_EQ(200, fsm.Allocate());
+  EXPECT_EQ(0, fsm.GetNumFreePages());
+
+  // Scenario: an extent is contiguous, taken from a free run if there is one, and from the end otherwise.
+  for (page_id_t i = 64; i < 128; i++) {
+    fsm.Deallocate(i);
+  }
+  fsm.Deallocate(3);
+  EXPECT_EQ(64, fsm.AllocateExtent(64));
+  EXPECT_EQ(201, fsm.AllocateExtent(2));
+  EXPECT_EQ(3, fsm.Allocate());
+  page_id_t extent = fsm.AllocateExtent(FreeSpaceMap::MAX_EXTENT_SIZE);
+  EXPECT_EQ(203, extent);
+  for (size_t i = 0; i < FreeSpaceMap::MAX_EXTENT_SIZE; i++) {
+    EXPECT_TRUE(fsm.IsAllocated(extent + static_cast<page_id_t>(i)));
+  }
+  EXPECT_EQ(267, fsm.GetNumPages());
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreeSpaceMapTest, RestartTest) {
+  char data[PAGE_SIZE] = {0};
+  {
+    DiskManager dm("free_space_map_test.db");
+    for (page_id_t i = 0; i < 100; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, data);
+    }
+    dm.DeallocatePage(10);
+    dm.DeallocateExtent(50, 5);
+    dm.ShutDown();
+  }
+  std::string synced_map = ReadFile("free_space_map_test.fsm");
+
+  // Scenario: the map survives the restart. A reused id is synced before its page is written; a page beyond the
+  // high-water mark is not.
+  std::string crashed_map;
+  {
+    DiskManager dm("free_space_map_test.db");
+    EXPECT_EQ(100, dm.GetNumPages());
+    EXPECT_FALSE(dm.IsPageAllocated(10));
+    EXPECT_TRUE(dm.IsPageAllocated(11));
+    EXPECT_EQ(10, dm.AllocatePage());
+    EXPECT_EQ(synced_map, ReadFile("free_space_map_test.fsm"));
+    dm.WritePage(10, data);
+    EXPECT_NE(synced_map, ReadFile("free_space_map_test.fsm"));
+    EXPECT_EQ(100, dm.AllocateExtent(6));
+    dm.WritePage(100, data);
+    crashed_map = ReadFile("free_space_map_test.fsm");
+  }
+
+  // Scenario: a crash loses the changes since the map was last synced. Pages written beyond the high-water mark
+  // stay in use, and so does the reused id, whose page may have overwritten the old one.
+  WriteFile("free_space_map_test.fsm", crashed_map);
+  {
+    DiskManager dm("free_space_map_test.db");
+    EXPECT_EQ(101, dm.GetNumPages());
+    EXPECT_TRUE(dm.IsPageAllocated(100));
+    EXPECT_TRUE(dm.IsPageAllocated(10));
+    EXPECT_FALSE(dm.IsPageAllocated(50));
+    dm.ShutDown();
+  }
+
+  // Scenario: a database file without a map has every page in use; a new database starts empty.
+  remove("free_space_map_test.fsm");
+  {
+    DiskManager dm("free_space_map_test.db");
+    EXPECT_TRUE(dm.IsPageAllocated(50));
+    EXPECT_EQ(101, dm.AllocatePage());
+    dm.ShutDown();
+  }
+  remove("free_space_map_test.db");
+  {
+    DiskManager dm("free_space_map_test.db");
+    EXPECT_EQ(0, dm.GetNumPages());
+    EXPECT_EQ(0, dm.AllocatePage());
+    dm.ShutDown();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(FreeSpaceMapTest, ConcurrentTest) {
+  const int num_threads = 8;
+  const int num_rounds = 2000;
+  FreeSpaceMap fsm("free_space_map_test.fsm", 0);
+  for (int i = 0; i < num_threads * 16; i++) {
+    fsm.Allocate();
+  }
+
+  // Every thread frees and allocates pages and extents; no id may be held by two threads at a time.
+  std::vector<std::vector<page_id_t>> held(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      auto &mine = held[tid];
+      for (int i = 0; i < 16; i++) {
+        mine.push_back(tid * 16 + i);
+      }
+      for (int round = 0; round < num_rounds; round++) {
+        fsm.Deallocate(mine[round % mine.size()]);
+        mine.erase(mine.begin() + round % mine.size());
+        if (round % 10 == 0) {
+          page_id_t first = fsm.AllocateExtent(3);
+          for (page_id_t page_id = first; page_id < first + 3; page_id++) {
+            mine.push_back(page_id);
+          }
+          for (int i = 0; i < 3; i++) {
+            fsm.Deallocate(mine.front());
+            mine.erase(mine.begin());
+          }
+        }
+        mine.push_back(fsm.Allocate());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::vector<page_id_t> all;
+  for (const auto &mine : held) {
+    all.insert(all.end(), mine.begin(), mine.end());
+  }
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(all.end(), std::adjacent_find(all.begin(), all.end()));
+  for (auto page_id : all) {
+    EXPECT_TRUE(fsm.IsAllocated(page_id));
+  }
+  EXPECT_EQ(all.size() + fsm.GetNumFreePages(), static_cast<size_t>(fsm.GetNumPages()));
+}
+
+}  // namespace bustub
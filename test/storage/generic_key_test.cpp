@@ -0,0 +1,187 @@
+/**
+ * generic_key_test.cpp
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "b_plus_tree_test_util.h"  // NOLINT
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/generic_key.h"
+#include "storage/table/table_heap.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+template <size_t KeySize>
+GenericKey<KeySize> Normalize(const std::vector<Value> &values, Schema *key_schema) {
+  GenericKey<KeySize> key;
+  key.SetFromKey(Tuple(values, key_schema), key_schema);
+  return key;
+}
+
+/** Checks that the values, which are in increasing order, are normalized into keys in increasing order. */
+void CheckOrder(const std::vector<Value> &values, Schema *key_schema) {
+  MemcmpComparator<16> comparator(key_schema);
+  for (size_t i = 0; i < values.size(); i++) {
+    for (size_t j = 0; j < values.size(); j++) {
+      int expected = i < j ? -1 : (i > j ? 1 : 0);
+      EXPECT_EQ(expected, comparator(Normalize<16>({values[i]}, key_schema), Normalize<16>({values[j]}, key_schema)))
+          << i << " " << j;
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedOrderTest) {
+  Schema tinyint({Column("a", TypeId::TINYINT)});
+  CheckOrder({Value(TypeId::TINYINT, BUSTUB_INT8_NULL), Value(TypeId::TINYINT, static_cast<int8_t>(-100)),
+              Value(TypeId::TINYINT, static_cast<int8_t>(-1)), Value(TypeId::TINYINT, static_cast<int8_t>(0)),
+              Value(TypeId::TINYINT, static_cast<int8_t>(1)), Value(TypeId::TINYINT, BUSTUB_INT8_MAX)},
+             &tinyint);
+
+  Schema smallint({Column("a", TypeId::SMALLINT)});
+  CheckOrder({Value(TypeId::SMALLINT, BUSTUB_INT16_NULL), Value(TypeId::SMALLINT, static_cast<int16_t>(-256)),
+              Value(TypeId::SMALLINT, static_cast<int16_t>(-1)), Value(TypeId::SMALLINT, static_cast<int16_t>(255)),
+              Value(TypeId::SMALLINT, static_cast<int16_t>(256))},
+             &smallint);
+
+  Schema integer({Column("a", TypeId::INTEGER)});
+  CheckOrder({Value(TypeId::INTEGER, BUSTUB_INT32_NULL), Value(TypeId::INTEGER, BUSTUB_INT32_MIN),
+              Value(TypeId::INTEGER, -65536), Value(TypeId::INTEGER, -1), Value(TypeId::INTEGER, 0),
+              Value(TypeId::INTEGER, 255), Value(TypeId::INTEGER, 65536), Value(TypeId::INTEGER, BUSTUB_INT32_MAX)},
+             &integer);
+
+  Schema bigint({Column("a", TypeId::BIGINT)});
+  CheckOrder({Value(TypeId::BIGINT, BUSTUB_INT64_NULL), Value(TypeId::BIGINT, BUSTUB_INT64_MIN),
+              Value(TypeId::BIGINT, static_cast<int64_t>(-4294967296)), Value(TypeId::BIGINT, static_cast<int64_t>(-1)),
+              Value(TypeId::BIGINT, static_cast<int64_t>(0)), Value(TypeId::BIGINT, static_cast<int64_t>(4294967296)),
+              Value(TypeId::BIGINT, BUSTUB_INT64_MAX)},
+             &bigint);
+
+  Schema decimal({Column("a", TypeId::DECIMAL)});
+  CheckOrder({Value(TypeId::DECIMAL, BUSTUB_DECIMAL_NULL), Value(TypeId::DECIMAL, -1e300),
+              Value(TypeId::DECIMAL, -1.5), Value(TypeId::DECIMAL, -std::numeric_limits<double>::denorm_min()),
+              Value(TypeId::DECIMAL, 0.0), Value(TypeId::DECIMAL, std::numeric_limits<double>::denorm_min()),
+              Value(TypeId::DECIMAL, 1.5), Value(TypeId::DECIMAL, 2.0), Value(TypeId::DECIMAL, BUSTUB_DECIMAL_MAX)},
+             &decimal);
+  MemcmpComparator<16> comparator(&decimal);
+  EXPECT_EQ(0, comparator(Normalize<16>({Value(TypeId::DECIMAL, -0.0)}, &decimal),
+                          Normalize<16>({Value(TypeId::DECIMAL, 0.0)}, &decimal)));
+
+  // A string sorts before the strings that it is a prefix of, even if they go on with a 0.
+  Schema varchar({Column("a", TypeId::VARCHAR, 8)});
+  CheckOrder({Value(TypeId::VARCHAR, std::string("")), Value(TypeId::VARCHAR, std::string("a")),
+              Value(TypeId::VARCHAR, std::string("a\0", 2)), Value(TypeId::VARCHAR, std::string("a\0\0", 3)),
+              Value(TypeId::VARCHAR, std::string("a\x01", 2)), Value(TypeId::VARCHAR, std::string("ab")),
+              Value(TypeId::VARCHAR, std::string("b")), Value(TypeId::VARCHAR, std::string("\xff"))},
+             &varchar);
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedColumnsTest) {
+  // The keys of several columns sort by the first column, then by the next, whatever the lengths of the strings are.
+  Schema schema({Column("a", TypeId::VARCHAR, 8), Column("b", TypeId::INTEGER)});
+  std::vector<std::pair<std::string, int32_t>> keys;
+  for (const auto &a : {"", "a", "ab", "b"}) {
+    for (int32_t b : {-2, -1, 0, 1, 1000}) {
+      keys.emplace_back(a, b);
+    }
+  }
+  MemcmpComparator<16> comparator(&schema);
+  for (size_t i = 0; i < keys.size(); i++) {
+    for (size_t j = 0; j < keys.size(); j++) {
+      int expected = i < j ? -1 : (i > j ? 1 : 0);
+      auto lhs =
+          Normalize<16>({Value(TypeId::VARCHAR, keys[i].first), Value(TypeId::INTEGER, keys[i].second)}, &schema);
+      auto rhs =
+          Normalize<16>({Value(TypeId::VARCHAR, keys[j].first), Value(TypeId::INTEGER, keys[j].second)}, &schema);
+      EXPECT_EQ(expected, comparator(lhs, rhs)) << i << " " << j;
+      if (i < j) {
+        GenericKey<16> separator = comparator.Separator(lhs, rhs);
+        EXPECT_LT(comparator(lhs, separator), 0) << i << " " << j;
+        EXPECT_LE(comparator(separator, rhs), 0) << i << " " << j;
+      }
+    }
+  }
+
+  // An encoding that is longer than the key does not go in.
+  EXPECT_THROW(Normalize<8>({Value(TypeId::VARCHAR, std::string("abcdef")), Value(TypeId::INTEGER, 0)}, &schema),
+               Exception);
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedIndexTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  Schema schema({Column("a", TypeId::BIGINT), Column("b", TypeId::VARCHAR, 8)});
+  auto *metadata = new IndexMetadata("foo_pk", "foo", &schema, {0, 1});
+  BPlusTreeIndex<GenericKey<32>, RID, MemcmpComparator<32>> index(metadata, bpm);
+  Transaction transaction(0);
+
+  // Keys that only differ in their strings, in random order.
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = -num_keys; key < num_keys; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  auto make_tuple = [&schema](int64_t key) {
+    return Tuple({Value(TypeId::BIGINT, key / 4), Value(TypeId::VARCHAR, std::string(key % 4 + 4, 'x'))}, &schema);
+  };
+  for (auto key : keys) {
+    index.InsertEntry(make_tuple(key), RID(key), &transaction);
+  }
+
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index.ScanKey(make_tuple(key), &rids, &transaction);
+    ASSERT_EQ(1, rids.size()) << key;
+    EXPECT_EQ(RID(key), rids[0]);
+  }
+  // The keys sort by a, then by the length of b.
+  std::sort(keys.begin(), keys.end(), [](int64_t a, int64_t b) {
+    return a / 4 != b / 4 ? a / 4 < b / 4 : a % 4 < b % 4;
+  });
+  auto expected = keys.begin();
+  for (auto iterator = index.GetBeginIterator(); iterator != index.GetEndIterator(); ++iterator) {
+    ASSERT_NE(keys.end(), expected);
+    EXPECT_EQ(RID(*expected), (*iterator).second);
+    expected++;
+  }
+  EXPECT_EQ(keys.end(), expected);
+
+  for (auto key : keys) {
+    if (key % 2 != 0) {
+      index.DeleteEntry(make_tuple(key), RID(key), &transaction);
+    }
+  }
+  for (auto key : keys) {
+    rids.clear();
+    index.ScanKey(make_tuple(key), &rids, &transaction);
+    EXPECT_EQ(key % 2 == 0 ? 1 : 0, rids.size()) << key;
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,141 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, SampleTest) {
+  const std::string db_name = "page_guard_test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  auto guard = bpm->NewPageGuarded(&page_id);
+  ASSERT_FALSE(guard.IsEmpty());
+  Page *page = guard.GetPage();
+  EXPECT_EQ(page_id, guard.PageId());
+  EXPECT_EQ(1, page->GetPinCount());
+
+  // Scenario: moving a guard moves the pin; the moved-from guard is empty and releases nothing.
+  BasicPageGuard moved = std::move(guard);
+  EXPECT_TRUE(guard.IsEmpty());  // NOLINT
+  EXPECT_EQ(1, page->GetPinCount());
+  snprintf(moved.GetDataMut(), PAGE_SIZE, "Hello");
+  moved.Drop();
+  EXPECT_TRUE(moved.IsEmpty());
+  EXPECT_EQ(0, page->GetPinCount());
+  moved.Drop();  // dropping twice is harmless
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: a write through the guard marks the page dirty, so it survives eviction.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t other_id;
+    auto other = bpm->NewPageGuarded(&other_id);
+    ASSERT_FALSE(other.IsEmpty());
+  }
+  {
+    auto read_guard = bpm->FetchPageRead(page_id);
+    ASSERT_FALSE(read_guard.IsEmpty());
+    EXPECT_EQ(0, strcmp(read_guard.GetData(), "Hello"));
+    EXPECT_EQ(1, read_guard.GetPage()->GetPinCount());
+
+    // Scenario: several readers may hold the same page.
+    auto second_guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, second_guard.GetPage()->GetPinCount());
+  }
+
+  // Scenario: guards release the latch as well as the pin, so a writer can come after the readers and vice versa.
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    ASSERT_FALSE(write_guard.IsEmpty());
+    snprintf(write_guard.GetDataMut(), PAGE_SIZE, "World");
+    page = write_guard.GetPage();
+    EXPECT_EQ(1, page->GetPinCount());
+    write_guard.Drop();
+    write_guard = bpm->FetchPageWrite(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  {
+    auto basic_guard = bpm->FetchPageBasic(page_id);
+    auto read_guard = basic_guard.UpgradeRead();
+    EXPECT_TRUE(basic_guard.IsEmpty());  // NOLINT
+    EXPECT_EQ(0, strcmp(read_guard.GetData(), "World"));
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_EQ(true, bpm->DeletePage(page_id));
+
+  // Scenario: when every frame is pinned the guard comes back empty.
+  BasicPageGuard pinned[buffer_pool_size];
+  for (auto &pinned_guard : pinned) {
+    page_id_t other_id;
+    pinned_guard = bpm->NewPageGuarded(&other_id);
+    ASSERT_FALSE(pinned_guard.IsEmpty());
+  }
+  EXPECT_TRUE(bpm->NewPageGuarded(&page_id).IsEmpty());
+  EXPECT_TRUE(bpm->FetchPageRead(1).IsEmpty());
+  for (auto &pinned_guard : pinned) {
+    pinned_guard.Drop();
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, ParallelTest) {
+  const std::string db_name = "page_guard_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+
+  // Scenario: the guards of a parallel buffer pool go back to the instance that holds the page.
+  for (int round = 0; round < 4; round++) {
+    for (size_t i = 0; i < num_instances * pool_size; i++) {
+      page_id_t page_id;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      ASSERT_FALSE(guard.IsEmpty());
+      snprintf(guard.GetDataMut(), PAGE_SIZE, "page %d", page_id);
+    }
+  }
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(4 * num_instances * pool_size); page_id++) {
+    auto guard = bpm->FetchPageRead(page_id);
+    ASSERT_FALSE(guard.IsEmpty());
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk_manager_test_util.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+namespace {
+
+/** Fills a new table with num_tuples tuples of about 1KB, numbered from 0, and returns its first page id. */
+page_id_t BuildTable(BufferPoolManager *bpm, const Schema &schema, int num_tuples) {
+  Transaction txn(0);
+  TableHeap table(bpm, nullptr, nullptr, &txn);
+  const std::string padding(1000, 'x');
+  for (int i = 0; i < num_tuples; i++) {
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, padding)}, &schema);
+    RID rid;
+    EXPECT_TRUE(table.InsertTuple(tuple, &rid, &txn));
+  }
+  bpm->FlushAllPages();
+  return table.GetFirstPageId();
+}
+
+/** Scans the table from the start and returns how many tuples it has, checking that they come back in order. */
+int ScanTable(TableHeap *table, const Schema &schema, size_t prefetch_window) {
+  Transaction txn(0);
+  int count = 0;
+  for (auto it = table->Begin(&txn, prefetch_window); it != table->End(); ++it) {
+    EXPECT_EQ(count, it->GetValue(&schema, 0).GetAs<int32_t>());
+    count++;
+  }
+  return count;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ReadAheadTest) {
+  const std::string db_name = "table_heap_test.db";
+  const std::string log_name = "table_heap_test.log";
+  const int num_tuples = 400;
+  Schema schema({Column("id", TypeId::INTEGER), Column("padding", TypeId::VARCHAR, 1000)});
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(200, disk_manager);
+  page_id_t first_page_id = BuildTable(bpm, schema, num_tuples);
+  delete bpm;
+
+  // Scenario: a cold scan through a pool much smaller than the table sees every tuple once, whether or not it reads
+  // ahead, and even when the window is larger than the pool.
+  for (size_t pool_size : {4, 16}) {
+    for (size_t prefetch_window : {0, 4, 16, 64}) {
+      bpm = new BufferPoolManager(pool_size, disk_manager);
+      TableHeap table(bpm, nullptr, nullptr, first_page_id);
+      EXPECT_EQ(num_tuples, ScanTable(&table, schema, prefetch_window));
+      delete bpm;
+    }
+  }
+
+  // Scenario: a prefetch for a page id that was never allocated is ignored.
+  bpm = new BufferPoolManager(16, disk_manager);
+  bpm->PrefetchPages({disk_manager->GetNumPages(), disk_manager->GetNumPages() + 1});
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, ExtentTest) {
+  const std::string db_name = "table_heap_test.db";
+  const std::string log_name = "table_heap_test.log";
+  Schema schema({Column("id", TypeId::INTEGER), Column("padding", TypeId::VARCHAR, 1000)});
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(32, disk_manager);
+
+  // Scenario: two tables that grow at the same time still get contiguous pages each, an extent at a time.
+  Transaction txn(0);
+  TableHeap first(bpm, nullptr, nullptr, &txn);
+  TableHeap second(bpm, nullptr, nullptr, &txn);
+  const std::string padding(1000, 'x');
+  for (int i = 0; i < 400; i++) {
+    Tuple tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, padding)}, &schema);
+    RID rid;
+    EXPECT_TRUE(first.InsertTuple(tuple, &rid, &txn));
+    EXPECT_TRUE(second.InsertTuple(tuple, &rid, &txn));
+  }
+  for (auto *table : {&first, &second}) {
+    std::vector<page_id_t> page_ids;
+    for (page_id_t page_id = table->GetFirstPageId(); page_id != INVALID_PAGE_ID;) {
+      page_ids.push_back(page_id);
+      auto guard = bpm->FetchPageRead(page_id);
+      page_id = static_cast<TablePage *>(guard.GetPage())->GetNextPageId();
+    }
+    ASSERT_LT(static_cast<size_t>(EXTENT_SIZE), page_ids.size());
+    for (size_t i = 1; i < page_ids.size(); i++) {
+      if (i % EXTENT_SIZE != 0) {
+        EXPECT_EQ(page_ids[i - 1] + 1, page_ids[i]);
+      }
+    }
+    EXPECT_EQ(0, page_ids[0] % EXTENT_SIZE);
+  }
+
+  // Scenario: the pages of its extent that a table has not used are freed when the table goes away, or when the disk
+  // manager shuts down while the table is still around.
+  page_id_t dropped_page_id;
+  {
+    TableHeap dropped(bpm, nullptr, nullptr, &txn);
+    dropped_page_id = dropped.GetFirstPageId();
+    EXPECT_TRUE(disk_manager->IsPageAllocated(dropped_page_id + 1));
+  }
+  EXPECT_TRUE(disk_manager->IsPageAllocated(dropped_page_id));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(dropped_page_id + 1));
+  TableHeap open(bpm, nullptr, nullptr, &txn);
+  EXPECT_TRUE(disk_manager->IsPageAllocated(open.GetFirstPageId() + 1));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  EXPECT_TRUE(disk_manager->IsPageAllocated(open.GetFirstPageId()));
+  EXPECT_FALSE(disk_manager->IsPageAllocated(open.GetFirstPageId() + 1));
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, DISABLED_ColdScanBenchmark) {
+  // Scans a table of about 700 pages through a fresh 64-frame pool, once without read-ahead and once with the default
+  // window. The file is small enough to sit in the OS page cache, so this measures how much of the per-page miss
+  // latency the read-ahead hides, not the device; run it against a large file on a real disk for the full effect.
+  const std::string db_name = "table_heap_bench.db";
+  const std::string log_name = "table_heap_bench.log";
+  const int num_tuples = 2048;
+  Schema schema({Column("id", TypeId::INTEGER), Column("padding", TypeId::VARCHAR, 1000)});
+
+  auto *disk_manager = NewTestDiskManager(db_name);
+  auto *bpm = new BufferPoolManager(1024, disk_manager);
+  page_id_t first_page_id = BuildTable(bpm, schema, num_tuples);
+  delete bpm;
+
+  for (size_t prefetch_window : {static_cast<size_t>(0), static_cast<size_t>(TABLE_SCAN_PREFETCH_WINDOW)}) {
+    bpm = new BufferPoolManager(64, disk_manager);
+    TableHeap table(bpm, nullptr, nullptr, first_page_id);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(num_tuples, ScanTable(&table, schema, prefetch_window));
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "pages=" << disk_manager->GetNumPages() << " prefetch_window=" << prefetch_window
+              << " scan_us=" << elapsed.count() << std::endl;
+    delete bpm;
+  }
+
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove(log_name.c_str());
+  delete disk_manager;
+}
+
+}  // namespace bustub